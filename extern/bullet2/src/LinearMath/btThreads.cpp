@@ -286,11 +286,12 @@ static ThreadId_t getDebugThreadId()
 
 #endif  // #if BT_DETECT_BAD_THREAD_INDEX
 
+static const unsigned int kNullIndex = ~0U;
+THREAD_LOCAL_STATIC unsigned int sThreadIndex = kNullIndex;
+
 // return a unique index per thread, main thread is 0, worker threads are in [1, BT_MAX_THREAD_COUNT)
 unsigned int btGetCurrentThreadIndex()
 {
-	const unsigned int kNullIndex = ~0U;
-	THREAD_LOCAL_STATIC unsigned int sThreadIndex = kNullIndex;
 	if (sThreadIndex == kNullIndex)
 	{
 		sThreadIndex = gThreadCounter.getNext();
@@ -321,6 +322,12 @@ unsigned int btGetCurrentThreadIndex()
 	return sThreadIndex;
 }
 
+void btSetCurrentThreadIndex(unsigned int threadIndex)
+{
+	btAssert(threadIndex < BT_MAX_THREAD_COUNT);
+	sThreadIndex = threadIndex;
+}
+
 bool btIsMainThread()
 {
 	return btGetCurrentThreadIndex() == 0;
@@ -35,6 +35,11 @@ bool btIsMainThread();
 bool btThreadsAreRunning();
 unsigned int btGetCurrentThreadIndex();
 void btResetThreadIndexCounter();  // notify that all worker threads have been destroyed
+// for task schedulers that don't own their threads, index of the calling thread until changed again
+void btSetCurrentThreadIndex(unsigned int threadIndex);
+// for task schedulers implemented outside of Bullet, around parallel loops
+void btPushThreadsAreRunning();
+void btPopThreadsAreRunning();
 
 ///
 /// btSpinMutex -- lightweight spin-mutex implemented with atomic ops, never puts
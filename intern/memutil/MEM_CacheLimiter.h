@@ -185,7 +185,13 @@ template<class T> class MEM_CacheLimiter {
     return size;
   }
 
-  void enforce_limits()
+  /**
+   * Free elements until the managed memory fits into the global maximum.
+   *
+   * \param reserved: Memory which is used by data outside of this limiter but which shares
+   * the same budget. It is subtracted from the global maximum.
+   */
+  void enforce_limits(size_t reserved = 0)
   {
     size_t max = MEM_CacheLimiter_get_maximum();
     bool is_disabled = MEM_CacheLimiter_is_disabled();
@@ -199,6 +205,8 @@ template<class T> class MEM_CacheLimiter {
       return;
     }
 
+    max = (reserved < max) ? max - reserved : 0;
+
     mem_in_use = get_memory_in_use();
 
     if (mem_in_use <= max) {
@@ -90,6 +90,16 @@ MEM_CacheLimiterHandleC *MEM_CacheLimiter_insert(MEM_CacheLimiterC *This, void *
 
 void MEM_CacheLimiter_enforce_limits(MEM_CacheLimiterC *This);
 
+/**
+ * Free objects until memory constraints are satisfied, taking into account
+ * memory which is used outside of the limiter but shares the same budget.
+ *
+ * \param This: "This" pointer.
+ * \param reserved: Amount of memory used by data which is not managed by this limiter.
+ */
+
+void MEM_CacheLimiter_enforce_limits_ex(MEM_CacheLimiterC *This, size_t reserved);
+
 /**
  * Unmanage object previously inserted object.
  * Does _not_ delete managed object!
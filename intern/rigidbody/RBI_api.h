@@ -63,9 +63,10 @@ typedef struct rbConstraint rbConstraint;
 
 /* Setup ---------------------------- */
 
-/* Create a new dynamics world instance */
+/* Create a new dynamics world instance, optionally solving collisions and islands on multiple
+ * threads (when Bullet is built thread-safe) */
 // TODO: add args to set the type of constraint solvers, etc.
-rbDynamicsWorld *RB_dworld_new(const float gravity[3]);
+rbDynamicsWorld *RB_dworld_new(const float gravity[3], int use_multithreading);
 
 /* Delete the given dynamics world, and free any extra data it may require */
 void RB_dworld_delete(rbDynamicsWorld *world);
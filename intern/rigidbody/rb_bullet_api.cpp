@@ -67,12 +67,33 @@
 #include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
 #include "BulletCollision/Gimpact/btGImpactShape.h"
 
+/* Multi-threaded worlds need the bundled Bullet built thread-safe, see WITH_BULLET_THREADS. */
+#if BT_THREADSAFE && defined(WITH_TBB)
+#  define RB_USE_THREADS
+#endif
+
+#ifdef RB_USE_THREADS
+#  include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#  include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#  include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#  include "LinearMath/btThreads.h"
+
+#  include <mutex>
+
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
+#  include <tbb/task_arena.h>
+#endif
+
 struct rbDynamicsWorld {
   btDiscreteDynamicsWorld *dynamicsWorld;
   btDefaultCollisionConfiguration *collisionConfiguration;
   btDispatcher *dispatcher;
   btBroadphaseInterface *pairCache;
   btConstraintSolver *constraintSolver;
+  /* Solver for islands too large for a single thread, NULL for single-threaded worlds. */
+  btConstraintSolver *constraintSolverMt;
   btOverlapFilterCallback *filterCallback;
 };
 struct rbRigidBody {
@@ -131,14 +152,145 @@ static inline void copy_quat_btquat(float quat[4], const btQuaternion &btquat)
   quat[3] = btquat.getZ();
 }
 
+#ifdef RB_USE_THREADS
+
+/* Runs the parallel loops of Bullet with TBB, like the rest of Blender.
+ *
+ * Bullet stores per-thread data by thread index, and expects the thread stepping the world to have
+ * index 0. TBB doesn't own a fixed set of threads for us, so worlds are stepped in an arena limited
+ * to the number of threads Bullet supports, and each task uses its slot in the arena as index. */
+class rbTaskScheduler : public btITaskScheduler {
+ public:
+  rbTaskScheduler() : btITaskScheduler("TBB")
+  {
+    num_threads_ = btMin(tbb::this_task_arena::max_concurrency(), (int)BT_MAX_THREAD_COUNT);
+    arena_.initialize(num_threads_);
+  }
+
+  int getMaxNumThreads() const override
+  {
+    return BT_MAX_THREAD_COUNT;
+  }
+
+  int getNumThreads() const override
+  {
+    return num_threads_;
+  }
+
+  void setNumThreads(int numThreads) override
+  {
+    /* The size of the per-thread data of existing worlds depends on it. */
+    btAssert(numThreads == num_threads_);
+    (void)numThreads;
+  }
+
+  void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) override
+  {
+    btPushThreadsAreRunning();
+    tbb::parallel_for(tbb::blocked_range<int>(iBegin, iEnd, grainSize),
+                      [&body](const tbb::blocked_range<int> &range) {
+                        set_thread_index();
+                        body.forLoop(range.begin(), range.end());
+                      });
+    btPopThreadsAreRunning();
+  }
+
+  btScalar parallelSum(int iBegin,
+                       int iEnd,
+                       int grainSize,
+                       const btIParallelSumBody &body) override
+  {
+    btPushThreadsAreRunning();
+    const btScalar sum = tbb::parallel_reduce(
+        tbb::blocked_range<int>(iBegin, iEnd, grainSize),
+        btScalar(0),
+        [&body](const tbb::blocked_range<int> &range, btScalar value) {
+          set_thread_index();
+          return value + body.sumLoop(range.begin(), range.end());
+        },
+        [](btScalar a, btScalar b) { return a + b; });
+    btPopThreadsAreRunning();
+    return sum;
+  }
+
+  /* Run a function of a multi-threaded world, one world at a time. */
+  template<typename Func> void execute(const Func &func)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    arena_.execute([&func]() {
+      set_thread_index();
+      func();
+    });
+  }
+
+ private:
+  static void set_thread_index()
+  {
+    btSetCurrentThreadIndex((unsigned int)tbb::this_task_arena::current_thread_index());
+  }
+
+  int num_threads_;
+  tbb::task_arena arena_;
+  std::mutex mutex_;
+};
+
+static rbTaskScheduler *rb_task_scheduler_ensure()
+{
+  static rbTaskScheduler *scheduler = []() {
+    rbTaskScheduler *scheduler = new rbTaskScheduler();
+    /* Must be set from the thread with index 0, before creating any multi-threaded world. */
+    btSetCurrentThreadIndex(0);
+    btSetTaskScheduler(scheduler);
+    return scheduler;
+  }();
+  return scheduler;
+}
+
+#endif
+
 /* ********************************** */
 /* Dynamics World Methods */
 
 /* Setup ---------------------------- */
 
-rbDynamicsWorld *RB_dworld_new(const float gravity[3])
+rbDynamicsWorld *RB_dworld_new(const float gravity[3], int use_multithreading)
 {
   rbDynamicsWorld *world = new rbDynamicsWorld;
+  world->constraintSolverMt = NULL;
+
+#ifdef RB_USE_THREADS
+  if (use_multithreading) {
+    rb_task_scheduler_ensure();
+
+    world->collisionConfiguration = new btDefaultCollisionConfiguration();
+
+    world->dispatcher = new btCollisionDispatcherMt(world->collisionConfiguration);
+    btGImpactCollisionAlgorithm::registerAlgorithm((btCollisionDispatcher *)world->dispatcher);
+
+    world->pairCache = new btDbvtBroadphase();
+
+    world->filterCallback = new rbFilterCallback();
+    world->pairCache->getOverlappingPairCache()->setOverlapFilterCallback(world->filterCallback);
+
+    /* One solver per thread for small islands, and one solving large islands multi-threaded. */
+    btConstraintSolverPoolMt *solver_pool = new btConstraintSolverPoolMt(
+        btGetTaskScheduler()->getNumThreads());
+    world->constraintSolver = solver_pool;
+    world->constraintSolverMt = new btSequentialImpulseConstraintSolverMt();
+
+    world->dynamicsWorld = new btDiscreteDynamicsWorldMt(world->dispatcher,
+                                                         world->pairCache,
+                                                         solver_pool,
+                                                         world->constraintSolverMt,
+                                                         world->collisionConfiguration);
+
+    RB_dworld_set_gravity(world, gravity);
+
+    return world;
+  }
+#else
+  (void)use_multithreading;
+#endif
 
   /* collision detection/handling */
   world->collisionConfiguration = new btDefaultCollisionConfiguration();
@@ -167,6 +319,7 @@ void RB_dworld_delete(rbDynamicsWorld *world)
 {
   /* bullet doesn't like if we free these in a different order */
   delete world->dynamicsWorld;
+  delete world->constraintSolverMt;
   delete world->constraintSolver;
   delete world->pairCache;
   delete world->dispatcher;
@@ -211,6 +364,16 @@ void RB_dworld_step_simulation(rbDynamicsWorld *world,
                                int maxSubSteps,
                                float timeSubStep)
 {
+#ifdef RB_USE_THREADS
+  /* Only multi-threaded worlds have a multi-threaded solver. */
+  if (world->constraintSolverMt) {
+    rb_task_scheduler_ensure()->execute([&]() {
+      world->dynamicsWorld->stepSimulation(timeStep, maxSubSteps, timeSubStep);
+    });
+    return;
+  }
+#endif
+
   world->dynamicsWorld->stepSimulation(timeStep, maxSubSteps, timeSubStep);
 }
 
@@ -0,0 +1,93 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "RBI_api.h"
+
+/* Destruction setup: a block fractured into small pieces, dropped on the ground so the pieces
+ * collide with each other and with the ground. */
+#define PIECES_PER_AXIS 22 /* 10648 pieces. */
+#define PIECE_SIZE 0.1f
+#define FRAMES 48
+#define FPS 24.0f
+#define SUBSTEPS_PER_FRAME 10
+
+static double rigidbody_fracture_simulate(const bool use_multithreading)
+{
+  const float gravity[3] = {0.0f, 0.0f, -9.81f};
+  const float rot[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+  rbDynamicsWorld *world = RB_dworld_new(gravity, use_multithreading);
+  RB_dworld_set_solver_iterations(world, 10);
+
+  rbCollisionShape *ground_shape = RB_shape_new_box(50.0f, 50.0f, 1.0f);
+  const float ground_loc[3] = {0.0f, 0.0f, -1.0f};
+  rbRigidBody *ground = RB_body_new(ground_shape, ground_loc, rot);
+  RB_body_set_mass(ground, 0.0f);
+  RB_dworld_add_body(world, ground, 1);
+
+  /* Pieces share one shape, the way linked duplicates do. */
+  const float half_size = PIECE_SIZE * 0.5f;
+  rbCollisionShape *piece_shape = RB_shape_new_box(half_size, half_size, half_size);
+  RB_shape_set_margin(piece_shape, 0.01f);
+  std::vector<rbRigidBody *> pieces;
+  for (int x = 0; x < PIECES_PER_AXIS; x++) {
+    for (int y = 0; y < PIECES_PER_AXIS; y++) {
+      for (int z = 0; z < PIECES_PER_AXIS; z++) {
+        const float loc[3] = {(x - PIECES_PER_AXIS / 2) * PIECE_SIZE * 1.01f,
+                              (y - PIECES_PER_AXIS / 2) * PIECE_SIZE * 1.01f,
+                              1.0f + z * PIECE_SIZE * 1.01f};
+        rbRigidBody *piece = RB_body_new(piece_shape, loc, rot);
+        RB_body_set_mass(piece, 1.0f);
+        RB_body_set_friction(piece, 0.5f);
+        RB_dworld_add_body(world, piece, 1);
+        pieces.push_back(piece);
+      }
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < FRAMES; frame++) {
+    RB_dworld_step_simulation(
+        world, 1.0f / FPS, SUBSTEPS_PER_FRAME + 1, 1.0f / (FPS * SUBSTEPS_PER_FRAME));
+  }
+  const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+  /* The block has landed and no piece went through the ground. */
+  float z_min = INFINITY;
+  for (rbRigidBody *piece : pieces) {
+    float loc[3];
+    RB_body_get_position(piece, loc);
+    EXPECT_TRUE(std::isfinite(loc[0]) && std::isfinite(loc[1]) && std::isfinite(loc[2]));
+    z_min = std::min(z_min, loc[2]);
+  }
+  EXPECT_GT(z_min, 0.0f);
+  EXPECT_LT(z_min, PIECE_SIZE);
+
+  for (rbRigidBody *piece : pieces) {
+    RB_dworld_remove_body(world, piece);
+    RB_body_delete(piece);
+  }
+  RB_dworld_remove_body(world, ground);
+  RB_body_delete(ground);
+  RB_shape_delete(piece_shape);
+  RB_shape_delete(ground_shape);
+  RB_dworld_delete(world);
+
+  return duration.count();
+}
+
+TEST(rigidbody, FracturePerformance)
+{
+  const double time_single = rigidbody_fracture_simulate(false);
+  const double time_multi = rigidbody_fracture_simulate(true);
+  printf("%d pieces, %d frames: %fs single-threaded, %fs multi-threaded\n",
+         PIECES_PER_AXIS * PIECES_PER_AXIS * PIECES_PER_AXIS,
+         FRAMES,
+         time_single,
+         time_multi);
+}
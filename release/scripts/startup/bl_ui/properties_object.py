@@ -374,6 +374,29 @@ class OBJECT_PT_visibility(ObjectButtonsPanel, Panel):
             col.prop(ob, "use_grease_pencil_lights", toggle=False)
 
 
+class OBJECT_PT_playback_cache(ObjectButtonsPanel, Panel):
+    bl_label = "Playback Cache"
+    bl_options = {'DEFAULT_CLOSED'}
+
+    @classmethod
+    def poll(cls, context):
+        return (context.object) and (context.object.type == 'MESH')
+
+    def draw_header(self, context):
+        ob = context.object
+        self.layout.prop(ob, "use_playback_cache", text="")
+
+    def draw(self, context):
+        layout = self.layout
+        layout.use_property_split = True
+
+        ob = context.object
+
+        layout.active = ob.use_playback_cache
+        layout.prop(ob, "use_playback_cache_quantize")
+        layout.prop(ob, "playback_cache_memory")
+
+
 class OBJECT_PT_custom_props(ObjectButtonsPanel, PropertyPanel, Panel):
     COMPAT_ENGINES = {'BLENDER_RENDER', 'BLENDER_EEVEE', 'BLENDER_WORKBENCH'}
     _context_path = "object"
@@ -393,6 +416,7 @@ classes = (
     OBJECT_PT_motion_paths_display,
     OBJECT_PT_display,
     OBJECT_PT_visibility,
+    OBJECT_PT_playback_cache,
     OBJECT_PT_custom_props,
 )
 
@@ -72,6 +72,8 @@ class PHYSICS_PT_cloth(PhysicButtonsPanel, Panel):
         col = flow.column()
         col.prop(cloth, "quality", text="Quality Steps")
         col = flow.column()
+        col.prop(cloth, "preconditioner")
+        col = flow.column()
         col.prop(cloth, "time_scale", text="Speed Multiplier")
 
 
@@ -1226,6 +1226,9 @@ class PHYSICS_PT_cache(PhysicButtonsPanel, Panel):
         row = col.row()
         row.enabled = domain.cache_type in {'MODULAR', 'ALL'}
         row.prop(domain, "cache_frame_offset", text="Offset")
+        row = col.row()
+        row.enabled = not is_baking_any
+        row.prop(domain, "cache_prefetch_frames", text="Prefetch")
 
         col.separator()
 
@@ -249,6 +249,9 @@ void BKE_animsys_evaluate_animdata(struct ID *id,
                                    eAnimData_Recalc recalc,
                                    const bool flush_to_original);
 
+/* Free the F-Curve bindings cached by evaluation, they are resolved again when needed. */
+void BKE_animsys_fcurve_bindings_free(struct AnimData *adt);
+
 /* Evaluation of all ID-blocks with Animation Data blocks - Animation Data Only */
 void BKE_animsys_evaluate_all_animation(struct Main *main,
                                         struct Depsgraph *depsgraph,
@@ -67,6 +67,8 @@ typedef struct ClothSolverResult {
   int max_iterations, min_iterations;
   float avg_iterations;
   float max_error, min_error, avg_error;
+  /* Time in seconds of a simulation step. */
+  float max_time, avg_time;
 } ClothSolverResult;
 
 /**
@@ -254,6 +254,13 @@ void CustomData_copy_data_named(const struct CustomData *source,
                                 int source_index,
                                 int dest_index,
                                 int count);
+/* copies data of the source elements at src_indices to consecutive dest elements,
+ * handling a layer at a time (and in parallel for large counts) */
+void CustomData_copy_data_indices(const struct CustomData *source,
+                                  struct CustomData *dest,
+                                  const int *src_indices,
+                                  int dest_index,
+                                  int count);
 void CustomData_copy_elements(int type, void *src_data_ofs, void *dst_data_ofs, int count);
 void CustomData_bmesh_copy_data(const struct CustomData *source,
                                 struct CustomData *dest,
@@ -297,6 +304,15 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+/* interpolates count consecutive dest elements, each from src_count source elements,
+ * see CustomData_interp() for the arguments */
+void CustomData_interp_indices(const struct CustomData *source,
+                               struct CustomData *dest,
+                               const int *src_indices,
+                               const float *weights,
+                               int src_count,
+                               int dest_index,
+                               int count);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
@@ -395,6 +411,7 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 void CustomData_clear_layer_flag(struct CustomData *data, int type, int flag);
 
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void *block);
@@ -305,6 +305,10 @@ bool BKE_fcurve_is_empty(struct FCurve *fcu);
 float calculate_fcurve(struct PathResolvedRNA *anim_rna,
                        struct FCurve *fcu,
                        const struct AnimationEvalContext *anim_eval_context);
+float calculate_fcurve_ex(struct PathResolvedRNA *anim_rna,
+                          struct FCurve *fcu,
+                          const struct AnimationEvalContext *anim_eval_context,
+                          int *bezt_index_hint);
 
 /* ************* F-Curve Samples API ******************** */
 
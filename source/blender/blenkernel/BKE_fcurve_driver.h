@@ -34,9 +34,11 @@ struct ChannelDriver;
 struct DriverTarget;
 struct DriverVar;
 struct FCurve;
+struct Main;
 struct PathResolvedRNA;
 struct PointerRNA;
 struct PropertyRNA;
+struct ReportList;
 
 /* ************** F-Curve Drivers ***************** */
 
@@ -89,6 +91,7 @@ bool driver_get_variable_property(struct ChannelDriver *driver,
                                   int *r_index);
 
 bool BKE_driver_has_simple_expression(struct ChannelDriver *driver);
+int BKE_drivers_python_report(struct Main *bmain, struct ReportList *reports);
 bool BKE_driver_expression_depends_on_time(struct ChannelDriver *driver);
 void BKE_driver_invalidate_expression(struct ChannelDriver *driver,
                                       bool expr_changed,
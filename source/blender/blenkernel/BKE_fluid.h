@@ -63,6 +63,7 @@ void BKE_fluid_reallocate_copy_fluid(struct FluidDomainSettings *fds,
 void BKE_fluid_cache_free_all(struct FluidDomainSettings *fds, struct Object *ob);
 void BKE_fluid_cache_free(struct FluidDomainSettings *fds, struct Object *ob, int cache_map);
 void BKE_fluid_cache_new_name_for_current_session(int maxlen, char *r_name);
+void BKE_fluid_exit(void);
 
 float BKE_fluid_get_velocity_at(struct Object *ob, float position[3], float velocity[3]);
 int BKE_fluid_get_data_flags(struct FluidDomainSettings *fds);
@@ -457,6 +457,7 @@ void BKE_mesh_normals_loop_to_vertex(const int numVerts,
 bool BKE_mesh_has_custom_loop_normals(struct Mesh *me);
 
 void BKE_mesh_calc_normals_split(struct Mesh *mesh);
+void BKE_mesh_ensure_normals_split(struct Mesh *mesh);
 void BKE_mesh_calc_normals_split_ex(struct Mesh *mesh,
                                     struct MLoopNorSpaceArray *r_lnors_spacearr);
 
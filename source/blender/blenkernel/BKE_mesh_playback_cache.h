@@ -0,0 +1,60 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Cache of evaluated meshes of an object per frame, used to replay animation without evaluating
+ * the modifier stack again. The topology is stored once, every frame only stores the vertex
+ * positions and normals, so only results with the same topology and data layers on all frames
+ * can be cached.
+ */
+
+#include "BLI_sys_types.h"
+
+struct CustomData_MeshMasks;
+struct Mesh;
+struct MeshPlaybackCache;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct MeshPlaybackCache *BKE_mesh_playback_cache_new(void);
+void BKE_mesh_playback_cache_free(struct MeshPlaybackCache *cache);
+void BKE_mesh_playback_cache_clear(struct MeshPlaybackCache *cache);
+
+bool BKE_mesh_playback_cache_read(struct MeshPlaybackCache *cache,
+                                  int frame,
+                                  const struct CustomData_MeshMasks *data_mask,
+                                  bool need_mapping,
+                                  struct Mesh **r_mesh_deform,
+                                  struct Mesh **r_mesh_final);
+void BKE_mesh_playback_cache_write(struct MeshPlaybackCache *cache,
+                                   int frame,
+                                   const struct CustomData_MeshMasks *data_mask,
+                                   bool need_mapping,
+                                   bool use_quantize,
+                                   size_t memory_limit,
+                                   const struct Mesh *mesh_deform,
+                                   const struct Mesh *mesh_final);
+
+int BKE_mesh_playback_cache_frames_len(const struct MeshPlaybackCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
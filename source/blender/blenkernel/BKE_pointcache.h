@@ -47,6 +47,7 @@ extern "C" {
 
 /* Add the blendfile name after blendcache_ */
 #define PTCACHE_EXT ".bphys"
+#define PTCACHE_ARCHIVE_EXT ".bphar"
 #define PTCACHE_PATH "blendcache_"
 
 /* File open options, for BKE_ptcache_file_open */
@@ -108,6 +109,13 @@ typedef struct PTCacheData {
 typedef struct PTCacheFile {
   FILE *fp;
 
+  /* Frames of single file archives are read and written in memory, see #PTCACHE_DISK_ARCHIVE.
+   * When reading, `mem` points into the mapped archive unless `mem_alloc` is set. */
+  struct PTCacheArchive *archive;
+  int mode;
+  unsigned char *mem;
+  size_t mem_len, mem_pos, mem_alloc;
+
   int frame, old_format;
   unsigned int totpoint, type;
   unsigned int data_types, flag;
@@ -300,6 +308,9 @@ bool BKE_ptcache_object_has(struct Scene *scene, struct Object *ob, int duplis);
 /***************** Global funcs ****************************/
 void BKE_ptcache_remove(void);
 
+/* Finish pending writes and close all single file disk cache archives. */
+void BKE_ptcache_exit(void);
+
 /************ ID specific functions ************************/
 void BKE_ptcache_id_clear(PTCacheID *id, int mode, unsigned int cfra);
 int BKE_ptcache_id_exist(PTCacheID *id, int cfra);
@@ -363,6 +374,10 @@ void BKE_ptcache_mem_to_disk(struct PTCacheID *pid);
 /* Convert disk cache to memory cache and vice versa. Clears the cache that was converted. */
 void BKE_ptcache_toggle_disk_cache(struct PTCacheID *pid);
 
+/* Move disk cache frames between single file archive and per frame files, after the
+ * #PTCACHE_DISK_ARCHIVE flag was toggled. */
+void BKE_ptcache_toggle_disk_archive(struct PTCacheID *pid);
+
 /* Rename all disk cache files with a new name. Doesn't touch the actual content of the files. */
 void BKE_ptcache_disk_cache_rename(struct PTCacheID *pid,
                                    const char *name_src,
@@ -58,6 +58,7 @@
 #include "BKE_mesh.h"
 #include "BKE_mesh_iterators.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_playback_cache.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_mesh_tangent.h"
 #include "BKE_mesh_wrapper.h"
@@ -792,14 +793,29 @@ static void add_orco_mesh(Object *ob, BMEditMesh *em, Mesh *mesh, Mesh *mesh_orc
   }
 }
 
+/* Tag loop normals needed for auto-smooth only to be calculated on access,
+ * see #BKE_mesh_ensure_normals_split. The layer is added here, so that calculating them later
+ * doesn't change the layers of a mesh which may be read from other threads. */
+static void mesh_calc_modifier_final_normals_lazy(Mesh *mesh_final)
+{
+  if (!CustomData_has_layer(&mesh_final->ldata, CD_NORMAL)) {
+    CustomData_add_layer(&mesh_final->ldata, CD_NORMAL, CD_CALLOC, nullptr, mesh_final->totloop);
+    CustomData_set_layer_flag(&mesh_final->ldata, CD_NORMAL, CD_FLAG_TEMPORARY);
+  }
+  mesh_final->runtime.cd_dirty_loop |= CD_MASK_NORMAL;
+}
+
 static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
                                              const CustomData_MeshMasks *final_datamask,
                                              const bool sculpt_dyntopo,
                                              Mesh *mesh_final)
 {
   /* Compute normals. */
-  const bool do_loop_normals = ((mesh_input->flag & ME_AUTOSMOOTH) != 0 ||
-                                (final_datamask->lmask & CD_MASK_NORMAL) != 0);
+  /* Loop normals needed for auto-smooth only are calculated on access,
+   * see #BKE_mesh_ensure_normals_split. */
+  const bool do_loop_normals = ((final_datamask->lmask & CD_MASK_NORMAL) != 0);
+  const bool do_loop_normals_lazy = (!do_loop_normals &&
+                                     (mesh_input->flag & ME_AUTOSMOOTH) != 0);
   /* Some modifiers may need this info from their target (other) object,
    * simpler to generate it here as well.
    * Note that they will always be generated when no loop normals are computed,
@@ -853,7 +869,10 @@ static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
   /* Some modifiers, like data-transfer, may generate those data as temp layer,
    * we do not want to keep them, as they are used by display code when available
    * (i.e. even if autosmooth is disabled). */
-  if (!do_loop_normals && CustomData_has_layer(&mesh_final->ldata, CD_NORMAL)) {
+  if (do_loop_normals_lazy) {
+    mesh_calc_modifier_final_normals_lazy(mesh_final);
+  }
+  else if (!do_loop_normals && CustomData_has_layer(&mesh_final->ldata, CD_NORMAL)) {
     CustomData_free_layers(&mesh_final->ldata, CD_NORMAL, mesh_final->totloop);
   }
 }
@@ -1489,8 +1508,10 @@ static void editbmesh_calc_modifier_final_normals(Mesh *mesh_final,
     return;
   }
 
-  const bool do_loop_normals = ((mesh_final->flag & ME_AUTOSMOOTH) != 0 ||
-                                (final_datamask->lmask & CD_MASK_NORMAL) != 0);
+  /* Same as #mesh_calc_modifier_final_normals. */
+  const bool do_loop_normals = ((final_datamask->lmask & CD_MASK_NORMAL) != 0);
+  const bool do_loop_normals_lazy = (!do_loop_normals &&
+                                     (mesh_final->flag & ME_AUTOSMOOTH) != 0);
   /* Some modifiers may need this info from their target (other) object,
    * simpler to generate it here as well. */
   const bool do_poly_normals = ((final_datamask->pmask & CD_MASK_NORMAL) != 0);
@@ -1535,7 +1556,10 @@ static void editbmesh_calc_modifier_final_normals(Mesh *mesh_final,
 
     /* Some modifiers, like data-transfer, may generate those data, we do not want to keep them,
      * as they are used by display code when available (i.e. even if autosmooth is disabled). */
-    if (CustomData_has_layer(&mesh_final->ldata, CD_NORMAL)) {
+    if (do_loop_normals_lazy) {
+      mesh_calc_modifier_final_normals_lazy(mesh_final);
+    }
+    else if (CustomData_has_layer(&mesh_final->ldata, CD_NORMAL)) {
       CustomData_free_layers(&mesh_final->ldata, CD_NORMAL, mesh_final->totloop);
     }
   }
@@ -1843,11 +1867,58 @@ static void mesh_build_extra_data(struct Depsgraph *depsgraph, Object *ob, Mesh
 static void mesh_runtime_check_normals_valid(const Mesh *mesh)
 {
   UNUSED_VARS_NDEBUG(mesh);
+  /* Loop normals may be left dirty, see #BKE_mesh_ensure_normals_split. */
   BLI_assert(!(mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL));
-  BLI_assert(!(mesh->runtime.cd_dirty_loop & CD_MASK_NORMAL));
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Get the playback cache of the original object when the result of the evaluation on the current
+ * frame can be read from or written to it, null otherwise.
+ */
+static MeshPlaybackCache *mesh_playback_cache_get(struct Depsgraph *depsgraph, Object *ob)
+{
+  /* Only the active depsgraph can write to the original object. */
+  if (!DEG_is_active(depsgraph)) {
+    return nullptr;
+  }
+  Object *ob_orig = DEG_get_original_object(ob);
+  if (!(ob->playback_cache_flag & OB_PLAYBACK_CACHE) || ob->mode != OB_MODE_OBJECT) {
+    if (ob_orig->runtime.playback_cache) {
+      BKE_mesh_playback_cache_free(ob_orig->runtime.playback_cache);
+      ob_orig->runtime.playback_cache = nullptr;
+    }
+    return nullptr;
+  }
+  if (ob_orig->runtime.playback_cache == nullptr) {
+    ob_orig->runtime.playback_cache = BKE_mesh_playback_cache_new();
+  }
+
+  /* Any change other than the frame invalidates all cached frames. */
+  if (DEG_id_is_user_modified(depsgraph, &ob->id)) {
+    BKE_mesh_playback_cache_clear(ob_orig->runtime.playback_cache);
+    return nullptr;
+  }
+  /* Sub-frames are not cached. */
+  const float ctime = DEG_get_ctime(depsgraph);
+  if (ctime != floorf(ctime)) {
+    return nullptr;
+  }
+  return ob_orig->runtime.playback_cache;
+}
+
+static bool mesh_playback_cache_supports(const Mesh *mesh_input,
+                                         const Mesh *mesh_deform,
+                                         const Mesh *mesh_final,
+                                         const GeometrySet *geometry_set)
+{
+  /* Meshes shared with other objects, non-mesh geometry and wrappers are not cached. */
+  return mesh_deform != nullptr && mesh_final != mesh_input->runtime.mesh_eval &&
+         mesh_final->runtime.wrapper_type == ME_WRAPPER_TYPE_MDATA &&
+         mesh_final->runtime.subdiv_ccg == nullptr && !geometry_set->has_instances() &&
+         !geometry_set->has_pointcloud() && !geometry_set->has_volume();
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1874,20 +1945,48 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   }
 #endif
 
+  Mesh *mesh = (Mesh *)ob->data;
   Mesh *mesh_eval = nullptr, *mesh_deform_eval = nullptr;
   GeometrySet *geometry_set_eval = nullptr;
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &mesh_deform_eval,
-                      &mesh_eval,
-                      &geometry_set_eval);
+  MeshPlaybackCache *playback_cache = mesh_playback_cache_get(depsgraph, ob);
+  const int frame = (int)DEG_get_ctime(depsgraph);
+
+  if (playback_cache && BKE_mesh_playback_cache_read(playback_cache,
+                                                     frame,
+                                                     dataMask,
+                                                     need_mapping,
+                                                     &mesh_deform_eval,
+                                                     &mesh_eval)) {
+    mesh_calc_modifier_final_normals(mesh, dataMask, false, mesh_eval);
+    mesh_calc_finalize(mesh, mesh_eval);
+    geometry_set_eval = new GeometrySet();
+  }
+  else {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &mesh_deform_eval,
+                        &mesh_eval,
+                        &geometry_set_eval);
+
+    if (playback_cache &&
+        mesh_playback_cache_supports(mesh, mesh_deform_eval, mesh_eval, geometry_set_eval)) {
+      BKE_mesh_playback_cache_write(playback_cache,
+                                    frame,
+                                    dataMask,
+                                    need_mapping,
+                                    ob->playback_cache_flag & OB_PLAYBACK_CACHE_QUANTIZE,
+                                    (size_t)ob->playback_cache_memory * 1024 * 1024,
+                                    mesh_deform_eval,
+                                    mesh_eval);
+    }
+  }
 
   /* The modifier stack evaluation is storing result in mesh->runtime.mesh_eval, but this result
    * is not guaranteed to be owned by object.
@@ -1895,7 +1994,6 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * Check ownership now, since later on we can not go to a mesh owned by someone else via
    * object's runtime: this could cause access freed data on depsgraph destruction (mesh who owns
    * the final result might be freed prior to object). */
-  Mesh *mesh = (Mesh *)ob->data;
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
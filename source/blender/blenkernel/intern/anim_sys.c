@@ -624,6 +624,134 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name F-Curve Bindings
+ *
+ * Resolving the RNA path of every F-Curve on each evaluation is a large part of playing back
+ * actions with many channels. Evaluated (copy-on-write) data-blocks keep the resolved paths of
+ * their active action in #AnimData.fcurve_bindings instead, so they are written to directly.
+ *
+ * The bindings are freed with the evaluated #AnimData, which is copied again from the original
+ * when the data-block is relinked or its data is rebuilt. Editing the action (e.g. renaming a
+ * channel) only copies the action again, so each binding also keeps the path it was resolved
+ * from and is resolved again when the path of the F-Curve at its index differs.
+ * \{ */
+
+typedef struct AnimFCurveBinding {
+  /** Path and index the binding was resolved from. */
+  char *rna_path;
+  int array_index;
+  /** Keyframe index of the previous evaluation, see #calculate_fcurve_ex. */
+  int bezt_index_hint;
+  /** False when the path can't be resolved or points outside of the owner ID. */
+  bool is_bound;
+  PathResolvedRNA anim_rna;
+} AnimFCurveBinding;
+
+typedef struct AnimFCurveBindings {
+  /** Action the bindings were made for, one binding for each of its F-Curves. */
+  bAction *action;
+  int len;
+  AnimFCurveBinding *bindings;
+} AnimFCurveBindings;
+
+void BKE_animsys_fcurve_bindings_free(AnimData *adt)
+{
+  AnimFCurveBindings *fcurve_bindings = adt->fcurve_bindings;
+  if (fcurve_bindings == NULL) {
+    return;
+  }
+  for (int i = 0; i < fcurve_bindings->len; i++) {
+    MEM_SAFE_FREE(fcurve_bindings->bindings[i].rna_path);
+  }
+  MEM_freeN(fcurve_bindings->bindings);
+  MEM_freeN(fcurve_bindings);
+  adt->fcurve_bindings = NULL;
+}
+
+static AnimFCurveBindings *animsys_fcurve_bindings_ensure(AnimData *adt, bAction *act)
+{
+  const int len = BLI_listbase_count(&act->curves);
+  AnimFCurveBindings *fcurve_bindings = adt->fcurve_bindings;
+  if (fcurve_bindings != NULL && fcurve_bindings->action == act && fcurve_bindings->len == len) {
+    return fcurve_bindings;
+  }
+
+  BKE_animsys_fcurve_bindings_free(adt);
+  fcurve_bindings = MEM_mallocN(sizeof(*fcurve_bindings), __func__);
+  fcurve_bindings->action = act;
+  fcurve_bindings->len = len;
+  fcurve_bindings->bindings = MEM_calloc_arrayN(len, sizeof(AnimFCurveBinding), __func__);
+  adt->fcurve_bindings = fcurve_bindings;
+  return fcurve_bindings;
+}
+
+/* Resolve the binding again if it was made for another path, returns true when it's bound. */
+static bool animsys_fcurve_binding_ensure(PointerRNA *ptr,
+                                          AnimFCurveBinding *binding,
+                                          const FCurve *fcu)
+{
+  if (binding->rna_path != NULL && binding->array_index == fcu->array_index &&
+      STREQ(binding->rna_path, fcu->rna_path)) {
+    return binding->is_bound;
+  }
+
+  MEM_SAFE_FREE(binding->rna_path);
+  binding->is_bound = false;
+  binding->bezt_index_hint = 0;
+  if (fcu->rna_path == NULL) {
+    return false;
+  }
+  binding->rna_path = BLI_strdup(fcu->rna_path);
+  binding->array_index = fcu->array_index;
+
+  /* Only data owned by this ID is freed along with the bindings, paths leading to other IDs
+   * (which may be copied again separately) are resolved on every evaluation. */
+  binding->is_bound = BKE_animsys_store_rna_setting(
+                          ptr, fcu->rna_path, fcu->array_index, &binding->anim_rna) &&
+                      binding->anim_rna.ptr.owner_id == ptr->owner_id;
+  return binding->is_bound;
+}
+
+/**
+ * Same as #animsys_evaluate_fcurves for the active action of an evaluated data-block,
+ * using its cached F-Curve bindings.
+ */
+static void animsys_evaluate_fcurves_bound(PointerRNA *ptr,
+                                           AnimData *adt,
+                                           bAction *act,
+                                           const AnimationEvalContext *anim_eval_context,
+                                           bool flush_to_original)
+{
+  BLI_assert(ptr->owner_id->tag & LIB_TAG_COPIED_ON_WRITE);
+  AnimFCurveBindings *fcurve_bindings = animsys_fcurve_bindings_ensure(adt, act);
+  AnimFCurveBinding *binding = fcurve_bindings->bindings;
+
+  for (FCurve *fcu = act->curves.first; fcu; fcu = fcu->next, binding++) {
+    if (!is_fcurve_evaluatable(fcu)) {
+      continue;
+    }
+
+    PathResolvedRNA anim_rna;
+    if (animsys_fcurve_binding_ensure(ptr, binding, fcu)) {
+      anim_rna = binding->anim_rna;
+    }
+    else if (!BKE_animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+      continue;
+    }
+
+    const float curval = calculate_fcurve_ex(
+        &anim_rna, fcu, anim_eval_context, &binding->bezt_index_hint);
+    BKE_animsys_write_rna_setting(&anim_rna, curval);
+    if (flush_to_original) {
+      /* Original data can change without evaluated copies being updated, not bound. */
+      animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
+    }
+  }
+}
+
+/** \} */
+
 /* ***************************************** */
 /* Driver Evaluation */
 
@@ -2838,7 +2966,14 @@ void BKE_animsys_evaluate_animdata(ID *id,
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action_ex(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      if (id->tag & LIB_TAG_COPIED_ON_WRITE) {
+        action_idcode_patch_check(id, adt->action);
+        animsys_evaluate_fcurves_bound(
+            &id_ptr, adt, adt->action, anim_eval_context, flush_to_original);
+      }
+      else {
+        animsys_evaluate_action_ex(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      }
     }
   }
 
@@ -55,52 +55,92 @@
 
 #include "CLG_log.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static CLG_LogRef LOG = {"bke.armature_deform"};
 
 /* -------------------------------------------------------------------- */
 /** \name Armature Deform Internal Utilities
  * \{ */
 
-/* Add the effect of one bone or B-Bone segment to the accumulated result. */
+/* `mat_accum += mat * weight`, the columns are added four components at once. */
+BLI_INLINE void armature_mat4_accumulate(float mat_accum[4][4],
+                                         const float mat[4][4],
+                                         const float weight)
+{
+#ifdef __SSE2__
+  const __m128 weight_vec = _mm_set1_ps(weight);
+  for (int i = 0; i < 4; i++) {
+    const __m128 col_vec = _mm_mul_ps(_mm_loadu_ps(mat[i]), weight_vec);
+    _mm_storeu_ps(mat_accum[i], _mm_add_ps(_mm_loadu_ps(mat_accum[i]), col_vec));
+  }
+#else
+  madd_m4_m4m4fl(mat_accum, mat_accum, mat, weight);
+#endif
+}
+
+/* Same as #add_weighted_dq_dq, with the rotation, translation and scale vectorized. */
+BLI_INLINE void armature_dq_accumulate(DualQuat *dq_accum, const DualQuat *dq, float weight)
+{
+#ifdef __SSE2__
+  const float scale_weight = weight;
+
+  /* Make sure we interpolate quaternions in the right direction. */
+  if (dot_qtqt(dq->quat, dq_accum->quat) < 0.0f) {
+    weight = -weight;
+  }
+
+  const __m128 weight_vec = _mm_set1_ps(weight);
+  _mm_storeu_ps(dq_accum->quat,
+                _mm_add_ps(_mm_loadu_ps(dq_accum->quat),
+                           _mm_mul_ps(_mm_loadu_ps(dq->quat), weight_vec)));
+  _mm_storeu_ps(dq_accum->trans,
+                _mm_add_ps(_mm_loadu_ps(dq_accum->trans),
+                           _mm_mul_ps(_mm_loadu_ps(dq->trans), weight_vec)));
+
+  /* Scale is never interpolated with a negative weight, and only when present. */
+  if (dq->scale_weight) {
+    armature_mat4_accumulate(dq_accum->scale, dq->scale, scale_weight);
+    dq_accum->scale_weight += scale_weight;
+  }
+#else
+  add_weighted_dq_dq(dq_accum, dq, weight);
+#endif
+}
+
+/**
+ * Add the effect of one bone or B-Bone segment to the accumulated result.
+ *
+ * For linear blending the weighted deform matrices are summed, the coordinate and the deform
+ * matrix are then transformed only once per vertex (see #armature_vert_task_with_dvert).
+ */
 static void pchan_deform_accumulate(const DualQuat *deform_dq,
                                     const float deform_mat[4][4],
-                                    const float co_in[3],
                                     float weight,
-                                    float co_accum[3],
                                     DualQuat *dq_accum,
-                                    float mat_accum[3][3])
+                                    float mat_accum[4][4])
 {
   if (weight == 0.0f) {
     return;
   }
 
   if (dq_accum) {
-    BLI_assert(!co_accum);
+    BLI_assert(!mat_accum);
 
-    add_weighted_dq_dq(dq_accum, deform_dq, weight);
+    armature_dq_accumulate(dq_accum, deform_dq, weight);
   }
   else {
-    float tmp[3];
-    mul_v3_m4v3(tmp, deform_mat, co_in);
-
-    sub_v3_v3(tmp, co_in);
-    madd_v3_v3fl(co_accum, tmp, weight);
-
-    if (mat_accum) {
-      float tmpmat[3][3];
-      copy_m3_m4(tmpmat, deform_mat);
-
-      madd_m3_m3m3fl(mat_accum, mat_accum, tmpmat, weight);
-    }
+    armature_mat4_accumulate(mat_accum, deform_mat, weight);
   }
 }
 
 static void b_bone_deform(const bPoseChannel *pchan,
                           const float co[3],
                           float weight,
-                          float vec[3],
                           DualQuat *dq,
-                          float defmat[3][3])
+                          float defmat[4][4])
 {
   const DualQuat *quats = pchan->runtime.bbone_dual_quats;
   const Mat4 *mats = pchan->runtime.bbone_deform_mats;
@@ -114,10 +154,8 @@ static void b_bone_deform(const bPoseChannel *pchan,
   /* Calculate the indices of the 2 affecting b_bone segments. */
   BKE_pchan_bbone_deform_segment_index(pchan, y / pchan->bone->length, &index, &blend);
 
-  pchan_deform_accumulate(
-      &quats[index], mats[index + 1].mat, co, weight * (1.0f - blend), vec, dq, defmat);
-  pchan_deform_accumulate(
-      &quats[index + 1], mats[index + 2].mat, co, weight * blend, vec, dq, defmat);
+  pchan_deform_accumulate(&quats[index], mats[index + 1].mat, weight * (1.0f - blend), dq, defmat);
+  pchan_deform_accumulate(&quats[index + 1], mats[index + 2].mat, weight * blend, dq, defmat);
 }
 
 /* using vec with dist to bone b1 - b2 */
@@ -174,8 +212,10 @@ float distfactor_to_bone(
   return 1.0f - (a * a) / (rdist * rdist);
 }
 
-static float dist_bone_deform(
-    bPoseChannel *pchan, float vec[3], DualQuat *dq, float mat[3][3], const float co[3])
+static float dist_bone_deform(bPoseChannel *pchan,
+                              DualQuat *dq,
+                              float mat[4][4],
+                              const float co[3])
 {
   Bone *bone = pchan->bone;
   float fac, contrib = 0.0;
@@ -192,11 +232,10 @@ static float dist_bone_deform(
     contrib = fac;
     if (contrib > 0.0f) {
       if (bone->segments > 1 && pchan->runtime.bbone_segments == bone->segments) {
-        b_bone_deform(pchan, co, fac, vec, dq, mat);
+        b_bone_deform(pchan, co, fac, dq, mat);
       }
       else {
-        pchan_deform_accumulate(
-            &pchan->runtime.deform_dual_quat, pchan->chan_mat, co, fac, vec, dq, mat);
+        pchan_deform_accumulate(&pchan->runtime.deform_dual_quat, pchan->chan_mat, fac, dq, mat);
       }
     }
   }
@@ -206,9 +245,8 @@ static float dist_bone_deform(
 
 static void pchan_bone_deform(bPoseChannel *pchan,
                               float weight,
-                              float vec[3],
                               DualQuat *dq,
-                              float mat[3][3],
+                              float mat[4][4],
                               const float co[3],
                               float *contrib)
 {
@@ -219,11 +257,10 @@ static void pchan_bone_deform(bPoseChannel *pchan,
   }
 
   if (bone->segments > 1 && pchan->runtime.bbone_segments == bone->segments) {
-    b_bone_deform(pchan, co, weight, vec, dq, mat);
+    b_bone_deform(pchan, co, weight, dq, mat);
   }
   else {
-    pchan_deform_accumulate(
-        &pchan->runtime.deform_dual_quat, pchan->chan_mat, co, weight, vec, dq, mat);
+    pchan_deform_accumulate(&pchan->runtime.deform_dual_quat, pchan->chan_mat, weight, dq, mat);
   }
 
   (*contrib) += weight;
@@ -282,8 +319,8 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   DualQuat sumdq, *dq = NULL;
   bPoseChannel *pchan;
   float *co, dco[3];
-  float sumvec[3], summat[3][3];
-  float *vec = NULL, (*smat)[3] = NULL;
+  float summat[4][4], (*smat)[4] = NULL;
+  float defmat[3][3];
   float contrib = 0.0f;
   float armature_weight = 1.0f; /* default to 1 if no overall def group */
   float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
@@ -293,13 +330,9 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
     dq = &sumdq;
   }
   else {
-    zero_v3(sumvec);
-    vec = sumvec;
-
-    if (vert_deform_mats) {
-      zero_m3(summat);
-      smat = summat;
-    }
+    /* Weighted sum of the deform matrices, for both the coordinate and the deform matrix. */
+    zero_m4(summat);
+    smat = summat;
   }
 
   if (armature_def_nr != -1 && dvert) {
@@ -344,14 +377,14 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
               co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
         }
 
-        pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
+        pchan_bone_deform(pchan, weight, dq, smat, co, &contrib);
       }
     }
     /* If there are vertex-groups but not groups with bones (like for soft-body groups). */
     if (deformed == 0 && use_envelope) {
       for (pchan = data->ob_arm->pose->chanbase.first; pchan; pchan = pchan->next) {
         if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-          contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+          contrib += dist_bone_deform(pchan, dq, smat, co);
         }
       }
     }
@@ -359,7 +392,7 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   else if (use_envelope) {
     for (pchan = data->ob_arm->pose->chanbase.first; pchan; pchan = pchan->next) {
       if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-        contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+        contrib += dist_bone_deform(pchan, dq, smat, co);
       }
     }
   }
@@ -371,20 +404,24 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
 
       if (armature_weight != 1.0f) {
         copy_v3_v3(dco, co);
-        mul_v3m3_dq(dco, (vert_deform_mats) ? summat : NULL, dq);
+        mul_v3m3_dq(dco, (vert_deform_mats) ? defmat : NULL, dq);
         sub_v3_v3(dco, co);
         mul_v3_fl(dco, armature_weight);
         add_v3_v3(co, dco);
       }
       else {
-        mul_v3m3_dq(co, (vert_deform_mats) ? summat : NULL, dq);
+        mul_v3m3_dq(co, (vert_deform_mats) ? defmat : NULL, dq);
       }
-
-      smat = summat;
     }
     else {
-      mul_v3_fl(vec, armature_weight / contrib);
-      add_v3_v3v3(co, vec, co);
+      /* Same as summing `(mat * co - co) * weight` for every bone. */
+      mul_v3_m4v3(dco, summat, co);
+      madd_v3_v3fl(dco, co, -contrib);
+      madd_v3_v3fl(co, dco, armature_weight / contrib);
+
+      if (vert_deform_mats) {
+        copy_m3_m4(defmat, summat);
+      }
     }
 
     if (vert_deform_mats) {
@@ -395,10 +432,10 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
       copy_m3_m3(tmpmat, vert_deform_mats[i]);
 
       if (!use_quaternion) { /* quaternion already is scale corrected */
-        mul_m3_fl(smat, armature_weight / contrib);
+        mul_m3_fl(defmat, armature_weight / contrib);
       }
 
-      mul_m3_series(vert_deform_mats[i], post, smat, pre, tmpmat);
+      mul_m3_series(vert_deform_mats[i], post, defmat, pre, tmpmat);
     }
   }
 
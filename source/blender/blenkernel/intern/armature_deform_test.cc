@@ -0,0 +1,225 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_action.h"
+#include "BKE_armature.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+
+namespace blender::bke::tests {
+
+#define BONES_NUM 2
+
+static const float bone_weights[BONES_NUM] = {0.75f, 0.5f};
+
+/* Armature with randomly posed bones. */
+static void armature_init(Object *ob_arm, bArmature *arm, Bone *bones, RandomNumberGenerator &rng)
+{
+  IDType_ID_OB.init_data(&ob_arm->id);
+  ob_arm->type = OB_ARMATURE;
+  ob_arm->data = arm;
+  ob_arm->pose = (bPose *)MEM_callocN(sizeof(bPose), __func__);
+  unit_m4(ob_arm->obmat);
+
+  for (int i = 0; i < BONES_NUM; i++) {
+    Bone *bone = &bones[i];
+    BLI_snprintf(bone->name, sizeof(bone->name), "Bone%d", i);
+    bone->segments = 1;
+    bone->length = 1.0f;
+    unit_m4(bone->arm_mat);
+
+    bPoseChannel *pchan = BKE_pose_channel_verify(ob_arm->pose, bone->name);
+    pchan->bone = bone;
+    const float eul[3] = {rng.get_float(), rng.get_float(), rng.get_float()};
+    const float loc[3] = {rng.get_float(), rng.get_float(), rng.get_float()};
+    const float size[3] = {1.0f, 1.0f, 1.0f};
+    loc_eul_size_to_mat4(pchan->chan_mat, loc, eul, size);
+    mat4_to_dquat(&pchan->runtime.deform_dual_quat, bone->arm_mat, pchan->chan_mat);
+  }
+}
+
+/* Mesh with random vertices, each weighted to all bones with #bone_weights. The extra vertex
+ * group "Armature" can be used to limit the effect of the whole armature. */
+static void mesh_init(Object *ob_mesh,
+                      Mesh *mesh,
+                      bDeformGroup *groups,
+                      const Bone *bones,
+                      MutableSpan<float3> coords,
+                      RandomNumberGenerator &rng)
+{
+  IDType_ID_OB.init_data(&ob_mesh->id);
+  IDType_ID_ME.init_data(&mesh->id);
+  ob_mesh->type = OB_MESH;
+  ob_mesh->data = mesh;
+  unit_m4(ob_mesh->obmat);
+
+  for (int i = 0; i < BONES_NUM; i++) {
+    STRNCPY(groups[i].name, bones[i].name);
+    BLI_addtail(&ob_mesh->defbase, &groups[i]);
+  }
+  STRNCPY(groups[BONES_NUM].name, "Armature");
+  BLI_addtail(&ob_mesh->defbase, &groups[BONES_NUM]);
+
+  const int verts_len = coords.size();
+  mesh->totvert = verts_len;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_len);
+  CustomData_add_layer(&mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, verts_len);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  for (const int i : coords.index_range()) {
+    for (int axis = 0; axis < 3; axis++) {
+      coords[i][axis] = (rng.get_float() - 0.5f) * 10.0f;
+    }
+    for (int j = 0; j < BONES_NUM; j++) {
+      BKE_defvert_add_index_notest(&mesh->dvert[i], j, bone_weights[j]);
+    }
+    BKE_defvert_add_index_notest(&mesh->dvert[i], BONES_NUM, 0.5f);
+  }
+}
+
+static void armature_mesh_free(Object *ob_arm, Object *ob_mesh, Mesh *mesh)
+{
+  BKE_pose_free(ob_arm->pose);
+  ob_arm->pose = nullptr;
+  BLI_listbase_clear(&ob_mesh->defbase);
+  IDType_ID_OB.free_data(&ob_arm->id);
+  IDType_ID_OB.free_data(&ob_mesh->id);
+  IDType_ID_ME.free_data(&mesh->id);
+}
+
+static bPoseChannel *pchan_get(Object *ob_arm, const int index)
+{
+  return (bPoseChannel *)BLI_findlink(&ob_arm->pose->chanbase, index);
+}
+
+TEST(armature_deform, Linear)
+{
+  const int verts_len = 20000;
+  Bone bones[BONES_NUM] = {{nullptr}};
+  bDeformGroup groups[BONES_NUM + 1] = {{nullptr}};
+  Object ob_arm = {{nullptr}};
+  Object ob_mesh = {{nullptr}};
+  bArmature arm = {{nullptr}};
+  Mesh mesh = {{nullptr}};
+  Array<float3> coords_orig(verts_len);
+  RandomNumberGenerator rng(verts_len);
+  armature_init(&ob_arm, &arm, bones, rng);
+  mesh_init(&ob_mesh, &mesh, groups, bones, coords_orig, rng);
+
+  /* Compare against the weighted average of the bone transformations, optionally limited by the
+   * armature vertex group. */
+  const float contrib = bone_weights[0] + bone_weights[1];
+  for (const char *defgrp_name : {"", "Armature"}) {
+    const float armature_weight = (defgrp_name[0] != '\0') ? 0.5f : 1.0f;
+
+    Array<float3> coords = coords_orig;
+    float(*deform_mats)[3][3] = (float(*)[3][3])MEM_malloc_arrayN(
+        verts_len, sizeof(*deform_mats), __func__);
+    for (int i = 0; i < verts_len; i++) {
+      unit_m3(deform_mats[i]);
+    }
+    BKE_armature_deform_coords_with_mesh(&ob_arm,
+                                         &ob_mesh,
+                                         (float(*)[3])coords.data(),
+                                         deform_mats,
+                                         verts_len,
+                                         ARM_DEF_VGROUP,
+                                         nullptr,
+                                         defgrp_name,
+                                         &mesh);
+
+    float deform_mat_expect[3][3];
+    zero_m3(deform_mat_expect);
+    for (int j = 0; j < BONES_NUM; j++) {
+      float bone_mat[3][3];
+      copy_m3_m4(bone_mat, pchan_get(&ob_arm, j)->chan_mat);
+      madd_m3_m3m3fl(deform_mat_expect, deform_mat_expect, bone_mat, bone_weights[j]);
+    }
+    mul_m3_fl(deform_mat_expect, armature_weight / contrib);
+
+    for (int i = 0; i < verts_len; i++) {
+      float3 offset(0.0f);
+      for (int j = 0; j < BONES_NUM; j++) {
+        float3 co_bone;
+        mul_v3_m4v3(co_bone, pchan_get(&ob_arm, j)->chan_mat, coords_orig[i]);
+        offset += (co_bone - coords_orig[i]) * bone_weights[j];
+      }
+      const float3 co_expect = coords_orig[i] + offset * (armature_weight / contrib);
+      EXPECT_V3_NEAR(coords[i], co_expect, 1e-4f);
+      EXPECT_M3_NEAR(deform_mats[i], deform_mat_expect, 1e-5f);
+    }
+
+    MEM_freeN(deform_mats);
+  }
+
+  armature_mesh_free(&ob_arm, &ob_mesh, &mesh);
+}
+
+TEST(armature_deform, Quaternion)
+{
+  /* A single bone with a rigid transformation deforms the same with dual quaternions. */
+  const int verts_len = 100;
+  Bone bones[BONES_NUM] = {{nullptr}};
+  bDeformGroup groups[BONES_NUM + 1] = {{nullptr}};
+  Object ob_arm = {{nullptr}};
+  Object ob_mesh = {{nullptr}};
+  bArmature arm = {{nullptr}};
+  Mesh mesh = {{nullptr}};
+  Array<float3> coords_orig(verts_len);
+  RandomNumberGenerator rng(verts_len);
+  armature_init(&ob_arm, &arm, bones, rng);
+  mesh_init(&ob_mesh, &mesh, groups, bones, coords_orig, rng);
+  bones[1].flag |= BONE_NO_DEFORM;
+
+  Array<float3> coords = coords_orig;
+  BKE_armature_deform_coords_with_mesh(&ob_arm,
+                                       &ob_mesh,
+                                       (float(*)[3])coords.data(),
+                                       nullptr,
+                                       verts_len,
+                                       ARM_DEF_VGROUP | ARM_DEF_QUATERNION,
+                                       nullptr,
+                                       "",
+                                       &mesh);
+
+  for (int i = 0; i < verts_len; i++) {
+    float3 co_expect;
+    mul_v3_m4v3(co_expect, pchan_get(&ob_arm, 0)->chan_mat, coords_orig[i]);
+    EXPECT_V3_NEAR(coords[i], co_expect, 1e-4f);
+  }
+
+  armature_mesh_free(&ob_arm, &ob_mesh, &mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -44,12 +44,14 @@
 #include "BKE_brush.h"
 #include "BKE_cachefile.h"
 #include "BKE_callbacks.h"
+#include "BKE_fluid.h"
 #include "BKE_global.h"
 #include "BKE_idprop.h"
 #include "BKE_image.h"
 #include "BKE_layer.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
+#include "BKE_pointcache.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -90,6 +92,8 @@ void BKE_blender_free(void)
 
   IMB_exit();
   BKE_cachefiles_exit();
+  BKE_ptcache_exit();
+  BKE_fluid_exit();
   BKE_images_exit();
   DEG_free_node_types();
 
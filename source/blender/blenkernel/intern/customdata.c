@@ -34,6 +34,7 @@
 #include "DNA_hair_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_alloca.h"
 #include "BLI_bitmap.h"
 #include "BLI_endian_switch.h"
 #include "BLI_math.h"
@@ -42,6 +43,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -2866,6 +2868,198 @@ void CustomData_copy_elements(int type, void *src_data_ofs, void *dst_data_ofs,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Bulk Copy & Interpolation
+ *
+ * Process many items a layer at a time, instead of dispatching through
+ * the layer type callbacks for every item and layer.
+ * Layers and ranges of items are processed in parallel.
+ * \{ */
+
+/** Number of items handled by a single task. */
+#define CUSTOMDATA_RANGE_CHUNK_SIZE 4096
+
+typedef struct CustomDataLayerPair {
+  int src_i;
+  int dst_i;
+} CustomDataLayerPair;
+
+/**
+ * Match source layers with destination layers like #CustomData_copy_data does.
+ *
+ * \param r_pairs: Array of `source->totlayer` size.
+ * \return The number of matching layers, skipping layers without data
+ * (with a warning when copying and only one of the layers has data).
+ */
+static int customdata_layer_pairs_find(const CustomData *source,
+                                       const CustomData *dest,
+                                       const bool use_interp,
+                                       CustomDataLayerPair *r_pairs)
+{
+  int pairs_len = 0;
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const int type = source->layers[src_i].type;
+    if (use_interp && !layerType_getInfo(type)->interp) {
+      continue;
+    }
+
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < type) {
+      dest_i++;
+    }
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+
+    if (dest->layers[dest_i].type == type) {
+      const void *src_data = source->layers[src_i].data;
+      const void *dst_data = dest->layers[dest_i].data;
+      if (src_data && dst_data) {
+        r_pairs[pairs_len].src_i = src_i;
+        r_pairs[pairs_len].dst_i = dest_i;
+        pairs_len++;
+      }
+      else if (!use_interp && !(src_data == NULL && dst_data == NULL)) {
+        CLOG_WARN(&LOG,
+                  "null data for %s type (%p --> %p), skipping",
+                  layerType_getName(type),
+                  src_data,
+                  dst_data);
+      }
+      dest_i++;
+    }
+  }
+  return pairs_len;
+}
+
+typedef struct CustomDataRangeData {
+  const CustomData *source;
+  CustomData *dest;
+  const CustomDataLayerPair *pairs;
+  /** Number of tasks for every layer. */
+  int chunks_len;
+
+  /** When NULL, items are read from the contiguous range starting at `source_index`. */
+  const int *src_indices;
+  int source_index;
+  int dest_index;
+  int count;
+
+  /* Interpolation only. */
+  const float *weights;
+  const float *weights_default;
+  int src_count;
+} CustomDataRangeData;
+
+/** Get the layer and range of items of a task. */
+static const CustomDataLayerPair *customdata_range_task_get(const CustomDataRangeData *data,
+                                                            const int task_index,
+                                                            int *r_start,
+                                                            int *r_end)
+{
+  *r_start = (task_index % data->chunks_len) * CUSTOMDATA_RANGE_CHUNK_SIZE;
+  *r_end = min_ii(*r_start + CUSTOMDATA_RANGE_CHUNK_SIZE, data->count);
+  return &data->pairs[task_index / data->chunks_len];
+}
+
+static void customdata_range_parallel(CustomDataRangeData *data,
+                                      const int pairs_len,
+                                      TaskParallelRangeFunc func)
+{
+  data->chunks_len = (data->count + CUSTOMDATA_RANGE_CHUNK_SIZE - 1) /
+                     CUSTOMDATA_RANGE_CHUNK_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  settings.use_threading = ((int64_t)data->count * pairs_len > CUSTOMDATA_RANGE_CHUNK_SIZE);
+  BLI_task_parallel_range(0, pairs_len * data->chunks_len, data, func, &settings);
+}
+
+static void customdata_copy_range_cb(void *__restrict userdata,
+                                     const int task_index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const CustomDataRangeData *data = userdata;
+  int start, end;
+  const CustomDataLayerPair *pair = customdata_range_task_get(data, task_index, &start, &end);
+
+  const LayerTypeInfo *typeInfo = layerType_getInfo(data->source->layers[pair->src_i].type);
+  const size_t size = (size_t)typeInfo->size;
+  const char *src_data = data->source->layers[pair->src_i].data;
+  char *dst_data = POINTER_OFFSET(data->dest->layers[pair->dst_i].data,
+                                  (size_t)data->dest_index * size);
+
+  for (int i = start; i < end;) {
+    /* Copy runs of consecutive source items as a single span. */
+    int src_index, run_len;
+    if (data->src_indices) {
+      src_index = data->src_indices[i];
+      run_len = 1;
+      while ((i + run_len < end) && (data->src_indices[i + run_len] == src_index + run_len)) {
+        run_len++;
+      }
+    }
+    else {
+      src_index = data->source_index + i;
+      run_len = end - i;
+    }
+
+    const void *src = src_data + (size_t)src_index * size;
+    void *dst = dst_data + (size_t)i * size;
+    if (typeInfo->copy) {
+      typeInfo->copy(src, dst, run_len);
+    }
+    else {
+      memcpy(dst, src, (size_t)run_len * size);
+    }
+    i += run_len;
+  }
+}
+
+static void customdata_copy_range(const CustomData *source,
+                                  CustomData *dest,
+                                  const int *src_indices,
+                                  int source_index,
+                                  int dest_index,
+                                  int count)
+{
+  CustomDataLayerPair *pairs = BLI_array_alloca(pairs, (size_t)source->totlayer);
+  const int pairs_len = customdata_layer_pairs_find(source, dest, false, pairs);
+  if (pairs_len == 0) {
+    return;
+  }
+
+  CustomDataRangeData data = {
+      .source = source,
+      .dest = dest,
+      .pairs = pairs,
+      .src_indices = src_indices,
+      .source_index = source_index,
+      .dest_index = dest_index,
+      .count = count,
+  };
+  customdata_range_parallel(&data, pairs_len, customdata_copy_range_cb);
+}
+
+/**
+ * Copy `count` items, the item at `src_indices[i]` in \a source is copied to `dest_index + i`
+ * in \a dest. Runs of consecutive source indices are copied as a single span.
+ *
+ * \note \a source and \a dest must not be the same.
+ */
+void CustomData_copy_data_indices(
+    const CustomData *source, CustomData *dest, const int *src_indices, int dest_index, int count)
+{
+  BLI_assert(source != dest);
+  if (count <= 0) {
+    return;
+  }
+  customdata_copy_range(source, dest, src_indices, 0, dest_index, count);
+}
+
+/** \} */
+
 static void CustomData_copy_data_layer(const CustomData *source,
                                        CustomData *dest,
                                        int src_i,
@@ -2925,6 +3119,11 @@ void CustomData_copy_data_named(
 void CustomData_copy_data(
     const CustomData *source, CustomData *dest, int source_index, int dest_index, int count)
 {
+  if (count > CUSTOMDATA_RANGE_CHUNK_SIZE && source != dest) {
+    customdata_copy_range(source, dest, NULL, source_index, dest_index, count);
+    return;
+  }
+
   /* copies a layer at a time */
   int dest_i = 0;
   for (int src_i = 0; src_i < source->totlayer; src_i++) {
@@ -3089,6 +3288,136 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+/**
+ * Number of float components of layer types interpolated as a plain weighted sum,
+ * zero for other types.
+ */
+static int customdata_interp_float_len(const int type)
+{
+  switch (type) {
+    case CD_PROP_FLOAT2:
+      return 2;
+    case CD_PROP_FLOAT3:
+      return 3;
+    case CD_PROP_COLOR:
+      return 4;
+  }
+  return 0;
+}
+
+static void customdata_interp_range_cb(void *__restrict userdata,
+                                       const int task_index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const CustomDataRangeData *data = userdata;
+  int start, end;
+  const CustomDataLayerPair *pair = customdata_range_task_get(data, task_index, &start, &end);
+
+  const int type = data->source->layers[pair->src_i].type;
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+  const size_t size = (size_t)typeInfo->size;
+  const char *src_data = data->source->layers[pair->src_i].data;
+  char *dst_data = POINTER_OFFSET(data->dest->layers[pair->dst_i].data,
+                                  (size_t)data->dest_index * size);
+  const int src_count = data->src_count;
+
+  const int float_len = customdata_interp_float_len(type);
+  if (float_len != 0) {
+    for (int i = start; i < end; i++) {
+      const int *indices = &data->src_indices[(size_t)i * (size_t)src_count];
+      const float *weights = data->weights ? &data->weights[(size_t)i * (size_t)src_count] :
+                                             data->weights_default;
+      float *dst = (float *)(dst_data + (size_t)i * size);
+      const float *src = (const float *)(src_data + (size_t)indices[0] * size);
+      for (int k = 0; k < float_len; k++) {
+        dst[k] = src[k] * weights[0];
+      }
+      for (int j = 1; j < src_count; j++) {
+        src = (const float *)(src_data + (size_t)indices[j] * size);
+        for (int k = 0; k < float_len; k++) {
+          dst[k] += src[k] * weights[j];
+        }
+      }
+    }
+    return;
+  }
+
+  const void *source_buf[SOURCE_BUF_SIZE];
+  const void **sources = source_buf;
+  if (src_count > SOURCE_BUF_SIZE) {
+    sources = MEM_malloc_arrayN((size_t)src_count, sizeof(*sources), __func__);
+  }
+
+  for (int i = start; i < end; i++) {
+    const int *indices = &data->src_indices[(size_t)i * (size_t)src_count];
+    const float *weights = data->weights ? &data->weights[(size_t)i * (size_t)src_count] :
+                                           data->weights_default;
+    for (int j = 0; j < src_count; j++) {
+      sources[j] = src_data + (size_t)indices[j] * size;
+    }
+    typeInfo->interp(sources, weights, NULL, src_count, dst_data + (size_t)i * size);
+  }
+
+  if (sources != source_buf) {
+    MEM_freeN((void *)sources);
+  }
+}
+
+/**
+ * Interpolate `count` items from `src_count` source items each. Item `dest_index + i` in \a dest
+ * is interpolated from the items at `src_indices[i * src_count + j]` in \a source.
+ *
+ * \param weights: The weight of each source item (`count * src_count` in size).
+ * If NULL, source items are averaged.
+ *
+ * \note \a source and \a dest must not be the same.
+ */
+void CustomData_interp_indices(const CustomData *source,
+                               CustomData *dest,
+                               const int *src_indices,
+                               const float *weights,
+                               int src_count,
+                               int dest_index,
+                               int count)
+{
+  BLI_assert(source != dest);
+  if (count <= 0 || src_count <= 0) {
+    return;
+  }
+
+  CustomDataLayerPair *pairs = BLI_array_alloca(pairs, (size_t)source->totlayer);
+  const int pairs_len = customdata_layer_pairs_find(source, dest, true, pairs);
+  if (pairs_len == 0) {
+    return;
+  }
+
+  float default_weights_buf[SOURCE_BUF_SIZE];
+  float *default_weights = NULL;
+  if (weights == NULL) {
+    default_weights = (src_count > SOURCE_BUF_SIZE) ?
+                          MEM_malloc_arrayN((size_t)src_count, sizeof(*weights), __func__) :
+                          default_weights_buf;
+    copy_vn_fl(default_weights, src_count, 1.0f / src_count);
+  }
+
+  CustomDataRangeData data = {
+      .source = source,
+      .dest = dest,
+      .pairs = pairs,
+      .src_indices = src_indices,
+      .dest_index = dest_index,
+      .count = count,
+      .weights = weights,
+      .weights_default = default_weights,
+      .src_count = src_count,
+  };
+  customdata_range_parallel(&data, pairs_len, customdata_interp_range_cb);
+
+  if (!ELEM(default_weights, NULL, default_weights_buf)) {
+    MEM_freeN(default_weights);
+  }
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -3626,7 +3955,11 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/**
+ * Allocate a block without initializing its layers,
+ * the caller is expected to fill them in (see #CustomData_to_bmesh_block).
+ */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
   if (*block) {
     CustomData_bmesh_free_block(data, block);
@@ -0,0 +1,161 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+
+namespace blender::bke::tests {
+
+/* More items than fit in a single range of the bulk kernels. */
+static const int items_len = 10000;
+
+static void customdata_layers_add(CustomData *data, const int len)
+{
+  CustomData_add_layer(data, CD_PROP_FLOAT3, CD_CALLOC, nullptr, len);
+  CustomData_add_layer(data, CD_PROP_INT32, CD_CALLOC, nullptr, len);
+  CustomData_add_layer(data, CD_MDEFORMVERT, CD_CALLOC, nullptr, len);
+}
+
+static void customdata_source_init(CustomData *data, const int len)
+{
+  customdata_layers_add(data, len);
+  float(*co)[3] = (float(*)[3])CustomData_get_layer(data, CD_PROP_FLOAT3);
+  int *ints = (int *)CustomData_get_layer(data, CD_PROP_INT32);
+  MDeformVert *dverts = (MDeformVert *)CustomData_get_layer(data, CD_MDEFORMVERT);
+  for (int i = 0; i < len; i++) {
+    co[i][0] = (float)i;
+    co[i][1] = (float)(i % 7);
+    co[i][2] = -(float)i;
+    ints[i] = i;
+    dverts[i].totweight = 1;
+    dverts[i].dw = (MDeformWeight *)MEM_callocN(sizeof(MDeformWeight), __func__);
+    dverts[i].dw->def_nr = i % 4;
+    dverts[i].dw->weight = 0.5f;
+  }
+}
+
+TEST(customdata, CopyDataIndices)
+{
+  CustomData src = {nullptr};
+  CustomData dst = {nullptr};
+  customdata_source_init(&src, items_len);
+  customdata_layers_add(&dst, items_len);
+
+  /* Runs of consecutive indices mixed with scattered ones. */
+  Array<int> src_indices(items_len);
+  for (int i = 0; i < items_len; i++) {
+    src_indices[i] = (i % 7 == 0) ? (i * 31) % items_len : i;
+  }
+  CustomData_copy_data_indices(&src, &dst, src_indices.data(), 0, items_len);
+
+  const float(*co)[3] = (float(*)[3])CustomData_get_layer(&dst, CD_PROP_FLOAT3);
+  const int *ints = (int *)CustomData_get_layer(&dst, CD_PROP_INT32);
+  const MDeformVert *dverts = (MDeformVert *)CustomData_get_layer(&dst, CD_MDEFORMVERT);
+  for (int i = 0; i < items_len; i++) {
+    const int src_i = src_indices[i];
+    EXPECT_EQ(co[i][0], (float)src_i);
+    EXPECT_EQ(ints[i], src_i);
+    ASSERT_EQ(dverts[i].totweight, 1);
+    EXPECT_EQ(dverts[i].dw->def_nr, src_i % 4);
+  }
+
+  CustomData_free(&src, items_len);
+  CustomData_free(&dst, items_len);
+}
+
+TEST(customdata, CopyData)
+{
+  CustomData src = {nullptr};
+  CustomData dst = {nullptr};
+  customdata_source_init(&src, items_len);
+  customdata_layers_add(&dst, items_len * 2);
+
+  CustomData_copy_data(&src, &dst, 0, items_len, items_len);
+
+  const int *ints = (int *)CustomData_get_layer(&dst, CD_PROP_INT32);
+  const MDeformVert *dverts = (MDeformVert *)CustomData_get_layer(&dst, CD_MDEFORMVERT);
+  for (int i = 0; i < items_len; i++) {
+    EXPECT_EQ(ints[i], 0);
+    EXPECT_EQ(ints[items_len + i], i);
+    EXPECT_EQ(dverts[i].totweight, 0);
+    EXPECT_EQ(dverts[items_len + i].totweight, 1);
+  }
+
+  CustomData_free(&src, items_len);
+  CustomData_free(&dst, items_len * 2);
+}
+
+TEST(customdata, InterpIndices)
+{
+  CustomData src = {nullptr};
+  CustomData dst = {nullptr};
+  CustomData dst_expect = {nullptr};
+  customdata_source_init(&src, items_len);
+  customdata_layers_add(&dst, items_len);
+  customdata_layers_add(&dst_expect, items_len);
+
+  /* Every item is interpolated from itself and the items at the other end. */
+  const int src_count = 2;
+  Array<int> src_indices(items_len * src_count);
+  Array<float> weights(items_len * src_count);
+  for (int i = 0; i < items_len; i++) {
+    src_indices[i * src_count] = i;
+    src_indices[i * src_count + 1] = items_len - 1 - i;
+    weights[i * src_count] = 0.25f;
+    weights[i * src_count + 1] = 0.75f;
+  }
+  CustomData_interp_indices(
+      &src, &dst, src_indices.data(), weights.data(), src_count, 0, items_len);
+  for (int i = 0; i < items_len; i++) {
+    CustomData_interp(&src,
+                      &dst_expect,
+                      &src_indices[i * src_count],
+                      &weights[i * src_count],
+                      nullptr,
+                      src_count,
+                      i);
+  }
+
+  const float(*co)[3] = (float(*)[3])CustomData_get_layer(&dst, CD_PROP_FLOAT3);
+  const float(*co_expect)[3] = (float(*)[3])CustomData_get_layer(&dst_expect, CD_PROP_FLOAT3);
+  const int *ints = (int *)CustomData_get_layer(&dst, CD_PROP_INT32);
+  const int *ints_expect = (int *)CustomData_get_layer(&dst_expect, CD_PROP_INT32);
+  const MDeformVert *dverts = (MDeformVert *)CustomData_get_layer(&dst, CD_MDEFORMVERT);
+  const MDeformVert *dverts_expect = (MDeformVert *)CustomData_get_layer(&dst_expect,
+                                                                         CD_MDEFORMVERT);
+  for (int i = 0; i < items_len; i++) {
+    EXPECT_V3_NEAR(co[i], co_expect[i], 1e-3f);
+    EXPECT_EQ(ints[i], ints_expect[i]);
+    ASSERT_EQ(dverts[i].totweight, dverts_expect[i].totweight);
+    for (int j = 0; j < dverts[i].totweight; j++) {
+      EXPECT_EQ(dverts[i].dw[j].def_nr, dverts_expect[i].dw[j].def_nr);
+      EXPECT_FLOAT_EQ(dverts[i].dw[j].weight, dverts_expect[i].dw[j].weight);
+    }
+  }
+
+  CustomData_free(&src, items_len);
+  CustomData_free(&dst, items_len);
+  CustomData_free(&dst_expect, items_len);
+}
+
+}  // namespace blender::bke::tests
@@ -1760,7 +1760,45 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
+/**
+ * Find the keyframe that \a evaltime occurs before, like #BKE_fcurve_bezt_binarysearch_index_ex.
+ *
+ * \param bezt_index_hint: Optional index found by the previous lookup on this curve.
+ * Evaluation time mostly advances by a frame or less, so the same and the next segment
+ * are checked before falling back to a binary search.
+ */
+static int fcurve_bezt_index_find(FCurve *fcu,
+                                  BezTriple *bezts,
+                                  float evaltime,
+                                  float threshold,
+                                  int *bezt_index_hint,
+                                  bool *r_exact)
+{
+  if (bezt_index_hint != NULL) {
+    const int a_end = min_ii(*bezt_index_hint + 2, (int)fcu->totvert);
+    for (int a = max_ii(*bezt_index_hint, 1); a < a_end; a++) {
+      /* Strictly inside the segment, where the binary search can't find an exact match. */
+      if ((evaltime - bezts[a - 1].vec[1][0]) > threshold &&
+          (bezts[a].vec[1][0] - evaltime) > threshold) {
+        *r_exact = false;
+        *bezt_index_hint = a;
+        return a;
+      }
+    }
+  }
+
+  const int a = BKE_fcurve_bezt_binarysearch_index_ex(
+      bezts, evaltime, fcu->totvert, threshold, r_exact);
+  if (bezt_index_hint != NULL) {
+    *bezt_index_hint = a;
+  }
+  return a;
+}
+
+static float fcurve_eval_keyframes_interpolate(FCurve *fcu,
+                                               BezTriple *bezts,
+                                               float evaltime,
+                                               int *bezt_index_hint)
 {
   const float eps = 1.e-8f;
   BezTriple *bezt, *prevbezt;
@@ -1779,7 +1817,7 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
    *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
    *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
    */
-  a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+  a = fcurve_bezt_index_find(fcu, bezts, evaltime, 0.0001f, bezt_index_hint, &exact);
   bezt = bezts + a;
 
   if (exact) {
@@ -2022,7 +2060,10 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
 }
 
 /* Calculate F-Curve value for 'evaltime' using #BezTriple keyframes. */
-static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
+static float fcurve_eval_keyframes(FCurve *fcu,
+                                   BezTriple *bezts,
+                                   float evaltime,
+                                   int *bezt_index_hint)
 {
   if (evaltime <= bezts->vec[1][0]) {
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, 0, +1);
@@ -2033,7 +2074,7 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, fcu->totvert - 1, -1);
   }
 
-  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime);
+  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime, bezt_index_hint);
 }
 
 /* Calculate F-Curve value for 'evaltime' using #FPoint samples. */
@@ -2082,7 +2123,7 @@ static float fcurve_eval_samples(FCurve *fcu, FPoint *fpts, float evaltime)
 /* Evaluate and return the value of the given F-Curve at the specified frame ("evaltime")
  * Note: this is also used for drivers.
  */
-static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue)
+static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue, int *bezt_index_hint)
 {
   float devaltime;
 
@@ -2099,7 +2140,7 @@ static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue)
    *   F-Curve modifier on the stack requested the curve to be evaluated at.
    */
   if (fcu->bezt) {
-    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime);
+    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime, bezt_index_hint);
   }
   else if (fcu->fpt) {
     cvalue = fcurve_eval_samples(fcu, fcu->fpt, devaltime);
@@ -2122,7 +2163,7 @@ float evaluate_fcurve(FCurve *fcu, float evaltime)
 {
   BLI_assert(fcu->driver == NULL);
 
-  return evaluate_fcurve_ex(fcu, evaltime, 0.0);
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, NULL);
 }
 
 float evaluate_fcurve_only_curve(FCurve *fcu, float evaltime)
@@ -2130,7 +2171,7 @@ float evaluate_fcurve_only_curve(FCurve *fcu, float evaltime)
   /* Can be used to evaluate the (keyframed) fcurve only.
    * Also works for driver-fcurves when the driver itself is not relevant.
    * E.g. when inserting a keyframe in a driver fcurve. */
-  return evaluate_fcurve_ex(fcu, evaltime, 0.0);
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, NULL);
 }
 
 float evaluate_fcurve_driver(PathResolvedRNA *anim_rna,
@@ -2178,7 +2219,7 @@ float evaluate_fcurve_driver(PathResolvedRNA *anim_rna,
     }
   }
 
-  return evaluate_fcurve_ex(fcu, evaltime, cvalue);
+  return evaluate_fcurve_ex(fcu, evaltime, cvalue, NULL);
 }
 
 /* Checks if the curve has valid keys, drivers or modifiers that produce an actual curve. */
@@ -2188,10 +2229,16 @@ bool BKE_fcurve_is_empty(FCurve *fcu)
          !list_has_suitable_fmodifier(&fcu->modifiers, 0, FMI_TYPE_GENERATE_CURVE);
 }
 
-/* Calculate the value of the given F-Curve at the given frame, and set its curval. */
-float calculate_fcurve(PathResolvedRNA *anim_rna,
-                       FCurve *fcu,
-                       const AnimationEvalContext *anim_eval_context)
+/**
+ * Calculate the value of the given F-Curve at the given frame, and set its curval.
+ *
+ * \param bezt_index_hint: Optional keyframe index kept between evaluations of the same curve
+ * (initialized to zero), to avoid searching all keyframes every time.
+ */
+float calculate_fcurve_ex(PathResolvedRNA *anim_rna,
+                          FCurve *fcu,
+                          const AnimationEvalContext *anim_eval_context,
+                          int *bezt_index_hint)
 {
   /* Only calculate + set curval (overriding the existing value) if curve has
    * any data which warrants this...
@@ -2206,12 +2253,19 @@ float calculate_fcurve(PathResolvedRNA *anim_rna,
     curval = evaluate_fcurve_driver(anim_rna, fcu, fcu->driver, anim_eval_context);
   }
   else {
-    curval = evaluate_fcurve(fcu, anim_eval_context->eval_time);
+    curval = evaluate_fcurve_ex(fcu, anim_eval_context->eval_time, 0.0f, bezt_index_hint);
   }
   fcu->curval = curval; /* Debug display only, not thread safe! */
   return curval;
 }
 
+float calculate_fcurve(PathResolvedRNA *anim_rna,
+                       FCurve *fcu,
+                       const AnimationEvalContext *anim_eval_context)
+{
+  return calculate_fcurve_ex(anim_rna, fcu, anim_eval_context, NULL);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -21,6 +21,9 @@
  * \ingroup bke
  */
 
+#include <ctype.h>
+#include <string.h>
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_anim_types.h"
@@ -42,7 +45,9 @@
 #include "BKE_constraint.h"
 #include "BKE_fcurve_driver.h"
 #include "BKE_global.h"
+#include "BKE_main.h"
 #include "BKE_object.h"
+#include "BKE_report.h"
 
 #include "RNA_access.h"
 
@@ -974,10 +979,32 @@ ChannelDriver *fcurve_copy_driver(const ChannelDriver *driver)
 enum {
   /* Index of the 'frame' variable. */
   VAR_INDEX_FRAME = 0,
+  /* Index of the 'self' variable, only usable through attributes (i.e. `self.location[0]`). */
+  VAR_INDEX_SELF,
   /* Index of the first user-defined driver variable. */
   VAR_INDEX_CUSTOM
 };
 
+/* Check that parameters which aren't numbers are only used through attributes and the other
+ * way around. Variables are checked on evaluation, as their targets can change. */
+static bool driver_check_simple_expr_params(ExprPyLike_Parsed *expr)
+{
+  if (BLI_expr_pylike_is_using_param(expr, VAR_INDEX_SELF)) {
+    return false;
+  }
+
+  const int paths_len = BLI_expr_pylike_param_paths_len(expr);
+  for (int i = 0; i < paths_len; i++) {
+    int param_index;
+    BLI_expr_pylike_param_path_get(expr, i, &param_index);
+    if (param_index == VAR_INDEX_FRAME) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 static ExprPyLike_Parsed *driver_compile_simple_expr_impl(ChannelDriver *driver)
 {
   /* Prepare parameter names. */
@@ -986,12 +1013,185 @@ static ExprPyLike_Parsed *driver_compile_simple_expr_impl(ChannelDriver *driver)
   int i = VAR_INDEX_CUSTOM;
 
   names[VAR_INDEX_FRAME] = "frame";
+  names[VAR_INDEX_SELF] = "self";
 
   LISTBASE_FOREACH (DriverVar *, dvar, &driver->variables) {
     names[i++] = dvar->name;
   }
 
-  return BLI_expr_pylike_parse(driver->expression, names, names_len + VAR_INDEX_CUSTOM);
+  ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(
+      driver->expression, names, names_len + VAR_INDEX_CUSTOM);
+
+  if (BLI_expr_pylike_is_valid(expr) && !driver_check_simple_expr_params(expr)) {
+    /* Cache the failure, the same way as expressions that can't be parsed. */
+    BLI_expr_pylike_free(expr);
+    expr = BLI_expr_pylike_parse("", NULL, 0);
+  }
+
+  return expr;
+}
+
+/* Index of a vector component accessed as an attribute (i.e. `location.x`), as in mathutils. */
+static int driver_path_component_index(PropertySubType subtype, char component)
+{
+  const char *components;
+
+  switch (subtype) {
+    case PROP_QUATERNION:
+      components = "wxyz";
+      break;
+    case PROP_COLOR:
+    case PROP_COLOR_GAMMA:
+      components = "rgb";
+      break;
+    case PROP_TRANSLATION:
+    case PROP_DIRECTION:
+    case PROP_VELOCITY:
+    case PROP_ACCELERATION:
+    case PROP_XYZ:
+    case PROP_XYZ_LENGTH:
+    case PROP_COORDS:
+    case PROP_EULER:
+    case PROP_MATRIX:
+      components = "xyzw";
+      break;
+    default:
+      return -1;
+  }
+
+  const char *found = strchr(components, component);
+  return (found != NULL && component != '\0') ? (int)(found - components) : -1;
+}
+
+/**
+ * Read the number a parameter path of an expression refers to, i.e. `location[0]`,
+ * `location.x` or `matrix_world[0][3]`, like Python would with mathutils types.
+ */
+static bool driver_path_value_get(PointerRNA *ptr, const char *path, double *r_value)
+{
+  /* RNA paths only support a single array index, so split up to two trailing subscripts or
+   * vector components (stored from last to first). */
+  char *base = BLI_array_alloca(base, strlen(path) + 1);
+  strcpy(base, path);
+  int accessors[2];
+  bool accessor_is_component[2];
+  int accessors_len = 0;
+
+  while (accessors_len < 2) {
+    const int len = strlen(base);
+    char *sep = (len > 0 && base[len - 1] == ']') ? strrchr(base, '[') : NULL;
+    if (sep != NULL && sep != base && sep + 2 < base + len &&
+        sep + 1 + strspn(sep + 1, "0123456789") == base + len - 1) {
+      accessors[accessors_len] = atoi(sep + 1);
+      accessor_is_component[accessors_len++] = false;
+      *sep = '\0';
+    }
+    else if (len > 2 && base[len - 2] == '.' && isalpha(base[len - 1])) {
+      accessors[accessors_len] = base[len - 1];
+      accessor_is_component[accessors_len++] = true;
+      base[len - 2] = '\0';
+    }
+    else {
+      break;
+    }
+  }
+
+  PointerRNA prop_ptr;
+  PropertyRNA *prop;
+  int index;
+  if (!RNA_path_resolve_property_full(ptr, base, &prop_ptr, &prop, &index) || index != -1 ||
+      !ELEM(RNA_property_type(prop), PROP_BOOLEAN, PROP_INT, PROP_FLOAT)) {
+    return false;
+  }
+
+  if (accessors_len == 0) {
+    if (RNA_property_array_check(prop)) {
+      return false;
+    }
+  }
+  else {
+    int dimsize[3];
+    const int dim = RNA_property_array_check(prop) ?
+                        RNA_property_array_dimension(&prop_ptr, prop, dimsize) :
+                        0;
+    if (dim != accessors_len) {
+      return false;
+    }
+
+    const PropertySubType subtype = RNA_property_subtype(prop);
+    int item[2];
+
+    /* Swap back to the order of the path. */
+    for (int i = 0; i < accessors_len; i++) {
+      const int j = accessors_len - 1 - i;
+      item[i] = accessor_is_component[j] ? driver_path_component_index(subtype, accessors[j]) :
+                                           accessors[j];
+      if (item[i] < 0 || item[i] >= dimsize[i]) {
+        return false;
+      }
+    }
+
+    if (dim == 1) {
+      index = item[0];
+    }
+    else if (subtype == PROP_MATRIX) {
+      /* Matrices are stored in columns, indexed by row in Python. */
+      index = item[1] * dimsize[0] + item[0];
+    }
+    else {
+      index = item[0] * dimsize[1] + item[1];
+    }
+  }
+
+  switch (RNA_property_type(prop)) {
+    case PROP_BOOLEAN:
+      *r_value = (index == -1) ? RNA_property_boolean_get(&prop_ptr, prop) :
+                                 RNA_property_boolean_get_index(&prop_ptr, prop, index);
+      break;
+    case PROP_INT:
+      *r_value = (index == -1) ? RNA_property_int_get(&prop_ptr, prop) :
+                                 RNA_property_int_get_index(&prop_ptr, prop, index);
+      break;
+    default:
+      *r_value = (index == -1) ? RNA_property_float_get(&prop_ptr, prop) :
+                                 RNA_property_float_get_index(&prop_ptr, prop, index);
+      break;
+  }
+  return true;
+}
+
+/* Get the data a parameter path starts from, `self` or a variable pointing to data. */
+static bool driver_path_param_pointer_get(PathResolvedRNA *anim_rna,
+                                          ChannelDriver *driver,
+                                          int param_index,
+                                          PointerRNA *r_ptr)
+{
+  if (param_index == VAR_INDEX_SELF) {
+    if (!(driver->flag & DRIVER_FLAG_USE_SELF) || anim_rna == NULL) {
+      return false;
+    }
+    *r_ptr = anim_rna->ptr;
+    return true;
+  }
+
+  DriverVar *dvar = BLI_findlink(&driver->variables, param_index - VAR_INDEX_CUSTOM);
+  PropertyRNA *prop;
+  int index;
+  return dvar != NULL && dvar->type == DVAR_TYPE_SINGLE_PROP &&
+         driver_get_variable_property(driver, &dvar->targets[0], r_ptr, &prop, &index) &&
+         prop == NULL && r_ptr->data != NULL;
+}
+
+/* Check if a variable points to data instead of a property, this also updates the invalid flags
+ * of its target. */
+static bool driver_variable_is_data_pointer(ChannelDriver *driver, DriverVar *dvar)
+{
+  PointerRNA ptr;
+  PropertyRNA *prop;
+  int index;
+  return dvar->type == DVAR_TYPE_SINGLE_PROP &&
+         driver_get_variable_property(driver, &dvar->targets[0], &ptr, &prop, &index) &&
+         prop == NULL;
 }
 
 static bool driver_check_simple_expr_depends_on_time(ExprPyLike_Parsed *expr)
@@ -1000,26 +1200,47 @@ static bool driver_check_simple_expr_depends_on_time(ExprPyLike_Parsed *expr)
   return BLI_expr_pylike_is_using_param(expr, VAR_INDEX_FRAME);
 }
 
-static bool driver_evaluate_simple_expr(ChannelDriver *driver,
+static bool driver_evaluate_simple_expr(PathResolvedRNA *anim_rna,
+                                        ChannelDriver *driver,
                                         ExprPyLike_Parsed *expr,
                                         float *result,
                                         float time)
 {
   /* Prepare parameter values. */
   int vars_len = BLI_listbase_count(&driver->variables);
-  double *vars = BLI_array_alloca(vars, vars_len + VAR_INDEX_CUSTOM);
+  int paths_len = BLI_expr_pylike_param_paths_len(expr);
+  int params_len = vars_len + VAR_INDEX_CUSTOM + paths_len;
+  double *vars = BLI_array_alloca(vars, params_len);
   int i = VAR_INDEX_CUSTOM;
 
   vars[VAR_INDEX_FRAME] = time;
+  vars[VAR_INDEX_SELF] = 0.0;
 
   LISTBASE_FOREACH (DriverVar *, dvar, &driver->variables) {
+    /* Variables pointing to data don't have a value, show them as zero like Python does. */
+    if (paths_len > 0 && !BLI_expr_pylike_is_using_param(expr, i) &&
+        driver_variable_is_data_pointer(driver, dvar)) {
+      dvar->curval = 0.0f;
+      vars[i++] = 0.0;
+      continue;
+    }
     vars[i++] = driver_get_variable_value(driver, dvar);
   }
 
+  /* Values of attributes, when these can't be read Python handles the expression instead. */
+  for (int path_index = 0; path_index < paths_len; path_index++) {
+    int param_index;
+    const char *path = BLI_expr_pylike_param_path_get(expr, path_index, &param_index);
+    PointerRNA ptr;
+    if (!driver_path_param_pointer_get(anim_rna, driver, param_index, &ptr) ||
+        !driver_path_value_get(&ptr, path, &vars[i++])) {
+      return false;
+    }
+  }
+
   /* Evaluate expression. */
   double result_val;
-  eExprPyLike_EvalStatus status = BLI_expr_pylike_eval(
-      expr, vars, vars_len + VAR_INDEX_CUSTOM, &result_val);
+  eExprPyLike_EvalStatus status = BLI_expr_pylike_eval(expr, vars, params_len, &result_val);
   const char *message;
 
   switch (status) {
@@ -1070,7 +1291,8 @@ static bool driver_compile_simple_expr(ChannelDriver *driver)
 
 /* Try using the simple expression evaluator to compute the result of the driver.
  * On success, stores the result and returns true; on failure result is set to 0. */
-static bool driver_try_evaluate_simple_expr(ChannelDriver *driver,
+static bool driver_try_evaluate_simple_expr(PathResolvedRNA *anim_rna,
+                                            ChannelDriver *driver,
                                             ChannelDriver *driver_orig,
                                             float *result,
                                             float time)
@@ -1079,7 +1301,7 @@ static bool driver_try_evaluate_simple_expr(ChannelDriver *driver,
 
   return driver_compile_simple_expr(driver_orig) &&
          BLI_expr_pylike_is_valid(driver_orig->expr_simple) &&
-         driver_evaluate_simple_expr(driver, driver_orig->expr_simple, result, time);
+         driver_evaluate_simple_expr(anim_rna, driver, driver_orig->expr_simple, result, time);
 }
 
 /* Check if the expression in the driver conforms to the simple subset. */
@@ -1088,6 +1310,43 @@ bool BKE_driver_has_simple_expression(ChannelDriver *driver)
   return driver_compile_simple_expr(driver) && BLI_expr_pylike_is_valid(driver->expr_simple);
 }
 
+typedef struct DriverPythonReportData {
+  ReportList *reports;
+  int count;
+} DriverPythonReportData;
+
+static void driver_python_report_cb(ID *id, FCurve *fcu, void *user_data)
+{
+  DriverPythonReportData *data = user_data;
+  ChannelDriver *driver = fcu->driver;
+
+  if (driver == NULL || driver->type != DRIVER_TYPE_PYTHON || driver->expression[0] == '\0' ||
+      BKE_driver_has_simple_expression(driver)) {
+    return;
+  }
+
+  BKE_reportf(data->reports,
+              RPT_INFO,
+              "Driver %s[%d] of '%s' needs Python: %s",
+              fcu->rna_path,
+              fcu->array_index,
+              id->name + 2,
+              driver->expression);
+  data->count++;
+}
+
+/**
+ * Report all drivers with expressions outside of the simple subset. These are evaluated by
+ * Python, one at a time, which limits multi-threaded evaluation of the dependency graph.
+ * \return The number of drivers reported.
+ */
+int BKE_drivers_python_report(Main *bmain, ReportList *reports)
+{
+  DriverPythonReportData data = {.reports = reports, .count = 0};
+  BKE_fcurves_main_cb(bmain, driver_python_report_cb, &data);
+  return data.count;
+}
+
 /* TODO(sergey): This is somewhat weak, but we don't want neither false-positive
  * time dependencies nor special exceptions in the depsgraph evaluation. */
 static bool python_driver_exression_depends_on_time(const char *expression)
@@ -1254,7 +1513,7 @@ static void evaluate_driver_python(PathResolvedRNA *anim_rna,
     driver->curval = 0.0f;
   }
   else if (!driver_try_evaluate_simple_expr(
-               driver, driver_orig, &driver->curval, anim_eval_context->eval_time)) {
+               anim_rna, driver, driver_orig, &driver->curval, anim_eval_context->eval_time)) {
 #ifdef WITH_PYTHON
     /* This evaluates the expression using Python, and returns its result:
      * - on errors it reports, then returns 0.0f. */
@@ -19,6 +19,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BKE_animsys.h"
 #include "BKE_fcurve.h"
 
 #include "ED_keyframing.h"
@@ -212,6 +213,34 @@ TEST(evaluate_fcurve, ExtrapolationBezierKeys)
   BKE_fcurve_free(fcu);
 }
 
+TEST(evaluate_fcurve, BeztIndexHint)
+{
+  FCurve *fcu = BKE_fcurve_create();
+  for (int i = 0; i < 20; i++) {
+    insert_vert_fcurve(
+        fcu, (float)(i * 2), (float)((i * 7) % 5), BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  }
+
+  /* Playing forward, backward, jumping around and landing on or very close to keys
+   * should all give the same result as searching the keys every time. */
+  int bezt_index_hint = 0;
+  const float time_epsilon = 0.00008f;
+  const float times[] = {-1.0f, 0.0f, 0.5f, 1.0f, 1.5f, 2.0f - time_epsilon, 2.0f, 2.5f,
+                         3.0f,  4.0f, 3.5f, 3.0f, 1.0f, 30.0f, 31.0f, 32.0f, 10.0f, 39.0f,
+                         38.0f, 40.0f, 20.0f + time_epsilon, 20.5f, 21.0f};
+  for (const float time : times) {
+    const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(nullptr,
+                                                                                      time);
+    EXPECT_NEAR(calculate_fcurve_ex(nullptr, fcu, &anim_eval_context, &bezt_index_hint),
+                evaluate_fcurve(fcu, time),
+                EPSILON);
+    EXPECT_GE(bezt_index_hint, 0);
+    EXPECT_LE(bezt_index_hint, fcu->totvert);
+  }
+
+  BKE_fcurve_free(fcu);
+}
+
 TEST(fcurve_subdivide, BKE_fcurve_bezt_subdivide_handles)
 {
   FCurve *fcu = BKE_fcurve_create();
@@ -3732,6 +3732,232 @@ static void BKE_fluid_modifier_processEffector(FluidModifierData *fmd,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Cache Prefetching
+ *
+ * Cache files are loaded by the Mantaflow interpreter straight into the grids of the domain, so
+ * frames can't be decoded ahead of time. Instead the files of the frames following the one that
+ * was read are read ahead by a background task into the file system cache, so that playback only
+ * waits for decoding and not for the disk.
+ * \{ */
+
+/* Files of a frame, as named by the Mantaflow cache (`directory/name_####.ext`). Caches written by
+ * older versions store every grid in a separate file, these are not read ahead. */
+enum {
+  FLUID_PREFETCH_FILE_DATA = 0,
+  FLUID_PREFETCH_FILE_NOISE,
+  FLUID_PREFETCH_FILE_MESH,
+  FLUID_PREFETCH_FILE_MESH_VELOCITY,
+  FLUID_PREFETCH_FILE_PARTICLES,
+  FLUID_PREFETCH_FILE_NUM,
+};
+
+/* Prefetch state of a cache directory. */
+typedef struct FluidPrefetchDir {
+  struct FluidPrefetchDir *next, *prev;
+  char directory[FILE_MAX];
+  /* Incremented when playback jumps, tasks of older generations stop. */
+  int generation;
+  /* Last frame that was loaded and last frame that is prefetched. */
+  int frame_current, frame_requested;
+} FluidPrefetchDir;
+
+typedef struct FluidPrefetchTask {
+  FluidPrefetchDir *prefetch_dir;
+  int generation;
+  int frame_start, frame_end;
+  /* File paths with `####` in place of the frame number, empty when not used. */
+  char filepaths[FLUID_PREFETCH_FILE_NUM][FILE_MAX];
+} FluidPrefetchTask;
+
+static ListBase fluid_prefetch_dirs_list = {NULL, NULL};
+static TaskPool *fluid_prefetch_pool = NULL;
+static ThreadMutex fluid_prefetch_mutex = BLI_MUTEX_INITIALIZER;
+
+static const char *fluid_cache_file_extension(const char cache_format)
+{
+  switch (cache_format) {
+    case FLUID_DOMAIN_FILE_OPENVDB:
+      return FLUID_DOMAIN_EXTENSION_OPENVDB;
+    case FLUID_DOMAIN_FILE_RAW:
+      return FLUID_DOMAIN_EXTENSION_RAW;
+    case FLUID_DOMAIN_FILE_BIN_OBJECT:
+      return FLUID_DOMAIN_EXTENSION_BINOBJ;
+    case FLUID_DOMAIN_FILE_OBJECT:
+      return FLUID_DOMAIN_EXTENSION_OBJ;
+    default:
+      return FLUID_DOMAIN_EXTENSION_UNI;
+  }
+}
+
+static void fluid_prefetch_filepath_set(char *filepath,
+                                        const char *directory,
+                                        const char *subdirectory,
+                                        const char *name,
+                                        const char cache_format)
+{
+  char filename[FILE_MAXFILE];
+  BLI_snprintf(
+      filename, sizeof(filename), "%s_####%s", name, fluid_cache_file_extension(cache_format));
+  BLI_path_join(filepath, FILE_MAX, directory, subdirectory, filename, NULL);
+}
+
+/* Skip frames the playback already moved past. */
+static bool fluid_prefetch_is_needed(const FluidPrefetchTask *task, const int frame)
+{
+  BLI_mutex_lock(&fluid_prefetch_mutex);
+  const bool is_needed = (task->generation == task->prefetch_dir->generation) &&
+                         (frame > task->prefetch_dir->frame_current);
+  BLI_mutex_unlock(&fluid_prefetch_mutex);
+  return is_needed;
+}
+
+static void fluid_prefetch_file_read(const char *filepath, char *buffer, const size_t buffer_len)
+{
+  FILE *fp = BLI_fopen(filepath, "rb");
+  if (fp == NULL) {
+    return;
+  }
+  while (fread(buffer, 1, buffer_len, fp) == buffer_len) {
+    /* Pass. */
+  }
+  fclose(fp);
+}
+
+static void fluid_prefetch_task_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  FluidPrefetchTask *task = taskdata;
+  const size_t buffer_len = 1024 * 1024;
+  char *buffer = NULL;
+
+  for (int frame = task->frame_start; frame <= task->frame_end; frame++) {
+    if (!fluid_prefetch_is_needed(task, frame)) {
+      continue;
+    }
+    if (buffer == NULL) {
+      buffer = MEM_mallocN(buffer_len, __func__);
+    }
+    /* Open the files directly, missing files fail to open without listing directories. */
+    for (int i = 0; i < FLUID_PREFETCH_FILE_NUM; i++) {
+      if (task->filepaths[i][0] != '\0') {
+        char filepath[FILE_MAX];
+        BLI_strncpy(filepath, task->filepaths[i], sizeof(filepath));
+        BLI_path_frame(filepath, frame, 0);
+        fluid_prefetch_file_read(filepath, buffer, buffer_len);
+      }
+    }
+  }
+
+  MEM_SAFE_FREE(buffer);
+}
+
+/* File paths of the cache files the domain reads on every frame. */
+static void fluid_prefetch_filepaths_set(const FluidDomainSettings *fds,
+                                         const char *directory,
+                                         char r_filepaths[FLUID_PREFETCH_FILE_NUM][FILE_MAX])
+{
+  const bool is_liquid = (fds->type == FLUID_DOMAIN_TYPE_LIQUID);
+  const char data_format = fds->cache_data_format;
+
+  fluid_prefetch_filepath_set(r_filepaths[FLUID_PREFETCH_FILE_DATA],
+                              directory,
+                              FLUID_DOMAIN_DIR_DATA,
+                              FLUID_NAME_DATA,
+                              data_format);
+  if (!is_liquid && (fds->flags & FLUID_DOMAIN_USE_NOISE)) {
+    fluid_prefetch_filepath_set(r_filepaths[FLUID_PREFETCH_FILE_NOISE],
+                                directory,
+                                FLUID_DOMAIN_DIR_NOISE,
+                                FLUID_NAME_NOISE,
+                                data_format);
+  }
+  if (is_liquid && (fds->flags & FLUID_DOMAIN_USE_MESH)) {
+    fluid_prefetch_filepath_set(r_filepaths[FLUID_PREFETCH_FILE_MESH],
+                                directory,
+                                FLUID_DOMAIN_DIR_MESH,
+                                FLUID_NAME_MESH,
+                                fds->cache_mesh_format);
+    if (fds->flags & FLUID_DOMAIN_USE_SPEED_VECTORS) {
+      fluid_prefetch_filepath_set(r_filepaths[FLUID_PREFETCH_FILE_MESH_VELOCITY],
+                                  directory,
+                                  FLUID_DOMAIN_DIR_MESH,
+                                  FLUID_NAME_MESH,
+                                  data_format);
+    }
+  }
+  if (is_liquid && fds->particle_type != 0) {
+    fluid_prefetch_filepath_set(r_filepaths[FLUID_PREFETCH_FILE_PARTICLES],
+                                directory,
+                                FLUID_DOMAIN_DIR_PARTICLES,
+                                FLUID_NAME_PARTICLES,
+                                data_format);
+  }
+}
+
+/* Read the cache files of the frames following `framenr` ahead of playback. */
+static void fluid_cache_prefetch(FluidDomainSettings *fds, Object *ob, int framenr)
+{
+  char directory[FILE_MAX];
+  const int frame_end = min_ii(framenr + fds->cache_prefetch_frames, fds->cache_frame_end);
+
+  BLI_strncpy(directory, fds->cache_directory, sizeof(directory));
+  BLI_path_abs(directory, BKE_modifier_path_relbase_from_global(ob));
+
+  BLI_mutex_lock(&fluid_prefetch_mutex);
+
+  FluidPrefetchDir *prefetch_dir = BLI_findstring(
+      &fluid_prefetch_dirs_list, directory, offsetof(FluidPrefetchDir, directory));
+  if (prefetch_dir == NULL) {
+    prefetch_dir = MEM_callocN(sizeof(FluidPrefetchDir), __func__);
+    BLI_strncpy(prefetch_dir->directory, directory, sizeof(prefetch_dir->directory));
+    prefetch_dir->frame_current = prefetch_dir->frame_requested = framenr;
+    BLI_addtail(&fluid_prefetch_dirs_list, prefetch_dir);
+  }
+
+  /* Start over when playback jumps out of the prefetched frames. */
+  if (framenr < prefetch_dir->frame_current || framenr > prefetch_dir->frame_requested + 1) {
+    prefetch_dir->generation++;
+    prefetch_dir->frame_requested = framenr;
+  }
+  prefetch_dir->frame_current = framenr;
+
+  if (frame_end > prefetch_dir->frame_requested) {
+    FluidPrefetchTask *task = MEM_callocN(sizeof(FluidPrefetchTask), __func__);
+    fluid_prefetch_filepaths_set(fds, directory, task->filepaths);
+    task->prefetch_dir = prefetch_dir;
+    task->generation = prefetch_dir->generation;
+    task->frame_start = prefetch_dir->frame_requested + 1;
+    task->frame_end = frame_end;
+    prefetch_dir->frame_requested = frame_end;
+
+    if (fluid_prefetch_pool == NULL) {
+      fluid_prefetch_pool = BLI_task_pool_create_background_serial(NULL, TASK_PRIORITY_LOW);
+    }
+    BLI_task_pool_push(fluid_prefetch_pool, fluid_prefetch_task_run, task, true, NULL);
+  }
+
+  BLI_mutex_unlock(&fluid_prefetch_mutex);
+}
+
+static void fluid_cache_prefetch_exit(void)
+{
+  /* Stop the tasks that did not run yet. */
+  BLI_mutex_lock(&fluid_prefetch_mutex);
+  LISTBASE_FOREACH (FluidPrefetchDir *, prefetch_dir, &fluid_prefetch_dirs_list) {
+    prefetch_dir->generation++;
+  }
+  BLI_mutex_unlock(&fluid_prefetch_mutex);
+
+  if (fluid_prefetch_pool) {
+    BLI_task_pool_work_and_wait(fluid_prefetch_pool);
+    BLI_task_pool_free(fluid_prefetch_pool);
+    fluid_prefetch_pool = NULL;
+  }
+  BLI_freelistN(&fluid_prefetch_dirs_list);
+}
+
+/** \} */
+
 static void BKE_fluid_modifier_processDomain(FluidModifierData *fmd,
                                              Depsgraph *depsgraph,
                                              Scene *scene,
@@ -4096,6 +4322,11 @@ static void BKE_fluid_modifier_processDomain(FluidModifierData *fmd,
       break;
   }
 
+  /* Read the following frames while this one is drawn. */
+  if (read_cache && has_data && !bake_cache && fds->cache_prefetch_frames > 0) {
+    fluid_cache_prefetch(fds, ob, data_frame);
+  }
+
   /* Trigger bake calls individually */
   if (bake_cache) {
     /* Ensure fresh variables at every animation step */
@@ -5197,4 +5428,12 @@ void BKE_fluid_cache_new_name_for_current_session(int maxlen, char *r_name)
   counter++;
 }
 
+/* Only to be called on exit blender. */
+void BKE_fluid_exit(void)
+{
+#ifdef WITH_FLUID
+  fluid_cache_prefetch_exit();
+#endif
+}
+
 /** \} */
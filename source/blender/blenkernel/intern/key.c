@@ -27,10 +27,13 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_math_vector.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -65,6 +68,8 @@
 
 #include "BLO_read_write.h"
 
+static void keyblock_deltas_free(KeyBlock *kb);
+
 static void shapekey_copy_data(Main *UNUSED(bmain),
                                ID *id_dst,
                                const ID *id_src,
@@ -80,6 +85,7 @@ static void shapekey_copy_data(Main *UNUSED(bmain),
     if (kb_dst->data) {
       kb_dst->data = MEM_dupallocN(kb_dst->data);
     }
+    kb_dst->deltas = NULL;
     if (kb_src == key_src->refkey) {
       key_dst->refkey = kb_dst;
     }
@@ -95,6 +101,7 @@ static void shapekey_free_data(ID *id)
     if (kb->data) {
       MEM_freeN(kb->data);
     }
+    keyblock_deltas_free(kb);
     MEM_freeN(kb);
   }
 }
@@ -178,6 +185,7 @@ static void shapekey_blend_read_data(BlendDataReader *reader, ID *id)
 
   LISTBASE_FOREACH (KeyBlock *, kb, &key->block) {
     BLO_read_data_address(reader, &kb->data);
+    kb->deltas = NULL;
 
     if (BLO_read_requires_endian_switch(reader)) {
       switch_endian_keyblock(key, kb);
@@ -870,6 +878,266 @@ static void cp_cu_key(Curve *cu,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Sparse Relative Key Evaluation
+ *
+ * Relative keys often only move a small part of the geometry (corrective shapes of a face rig
+ * for example). The offsets of the changed elements from the reference key are cached on the
+ * key-blocks of evaluated keys, so only those elements are blended.
+ *
+ * Elements are blended in parallel chunks, each chunk adds the key-blocks in order,
+ * giving exactly the same result as blending them one after the other.
+ * \{ */
+
+/* Number of elements blended by a single task. */
+#define KEY_RELATIVE_CHUNK_SIZE 4096
+
+typedef struct KeyBlockDeltas {
+  /** Data of the key-block and its reference key the offsets were calculated from. */
+  const void *data;
+  const void *ref_data;
+  int totelem;
+  /** Number of changed elements. */
+  int len;
+  /**
+   * Sorted indices of the changed elements and their offsets from the reference key.
+   * NULL when too many elements changed for a sparse representation to be worthwhile.
+   */
+  int *indices;
+  float (*offsets)[3];
+} KeyBlockDeltas;
+
+static void keyblock_deltas_free_data(KeyBlockDeltas *deltas)
+{
+  MEM_SAFE_FREE(deltas->indices);
+  MEM_SAFE_FREE(deltas->offsets);
+  MEM_freeN(deltas);
+}
+
+static void keyblock_deltas_free(KeyBlock *kb)
+{
+  if (kb->deltas) {
+    keyblock_deltas_free_data(kb->deltas);
+    kb->deltas = NULL;
+  }
+}
+
+static bool keyblock_deltas_is_valid(const KeyBlockDeltas *deltas,
+                                     const KeyBlock *kb,
+                                     const KeyBlock *refb)
+{
+  return deltas->data == kb->data && deltas->ref_data == refb->data &&
+         deltas->totelem == kb->totelem;
+}
+
+static KeyBlockDeltas *keyblock_deltas_calc(const KeyBlock *kb, const KeyBlock *refb)
+{
+  const float(*co)[3] = kb->data;
+  const float(*ref_co)[3] = refb->data;
+  const int totelem = kb->totelem;
+
+  KeyBlockDeltas *deltas = MEM_callocN(sizeof(*deltas), __func__);
+  deltas->data = kb->data;
+  deltas->ref_data = refb->data;
+  deltas->totelem = totelem;
+
+  uint len = 0;
+  for (int i = 0; i < totelem; i++) {
+    if (!equals_v3v3(co[i], ref_co[i])) {
+      len++;
+    }
+  }
+  deltas->len = (int)len;
+
+  /* Blending all elements is as fast when most of them changed, and uses no extra memory. */
+  if (len <= totelem / 2) {
+    deltas->indices = MEM_malloc_arrayN(len, sizeof(*deltas->indices), __func__);
+    deltas->offsets = MEM_malloc_arrayN(len, sizeof(*deltas->offsets), __func__);
+    for (int i = 0, j = 0; i < totelem; i++) {
+      if (!equals_v3v3(co[i], ref_co[i])) {
+        deltas->indices[j] = i;
+        sub_v3_v3v3(deltas->offsets[j], co[i], ref_co[i]);
+        j++;
+      }
+    }
+  }
+
+  return deltas;
+}
+
+/**
+ * Offsets are calculated lazily by the first evaluation thread that needs them. Objects sharing
+ * a mesh may evaluate the same key concurrently, so the result is published with a compare and
+ * swap, and a thread that loses the race uses the offsets of the winner.
+ *
+ * Published offsets are only freed with the key. Evaluated keys are copied again when their data
+ * changes, so offsets that don't match the data anymore aren't expected; they are ignored and the
+ * key-block is blended densely.
+ */
+static const KeyBlockDeltas *keyblock_deltas_ensure(KeyBlock *kb, const KeyBlock *refb)
+{
+  KeyBlockDeltas *deltas = atomic_cas_ptr((void **)&kb->deltas, NULL, NULL);
+  if (deltas == NULL) {
+    KeyBlockDeltas *deltas_new = keyblock_deltas_calc(kb, refb);
+    deltas = atomic_cas_ptr((void **)&kb->deltas, NULL, deltas_new);
+    if (deltas == NULL) {
+      return deltas_new;
+    }
+    keyblock_deltas_free_data(deltas_new);
+  }
+  return keyblock_deltas_is_valid(deltas, kb, refb) ? deltas : NULL;
+}
+
+typedef struct KeyRelativeBlock {
+  /** Offsets of the changed elements, when NULL all elements are blended. */
+  const KeyBlockDeltas *deltas;
+  const float (*co)[3];
+  const float (*ref_co)[3];
+  const float *weights;
+  float curval;
+} KeyRelativeBlock;
+
+typedef struct KeyRelativeData {
+  float (*out)[3];
+  const KeyRelativeBlock *blocks;
+  int blocks_len;
+  int start, end;
+} KeyRelativeData;
+
+/* Index of the first changed element which isn't below `index`. */
+static int keyblock_deltas_lower_bound(const KeyBlockDeltas *deltas, const int index)
+{
+  int first = 0, len = deltas->len;
+  while (len > 0) {
+    const int half = len / 2;
+    if (deltas->indices[first + half] < index) {
+      first += half + 1;
+      len -= half + 1;
+    }
+    else {
+      len = half;
+    }
+  }
+  return first;
+}
+
+static void key_evaluate_relative_chunk_fn(void *__restrict userdata,
+                                           const int chunk,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KeyRelativeData *data = userdata;
+  float(*out)[3] = data->out;
+  const int start = data->start + chunk * KEY_RELATIVE_CHUNK_SIZE;
+  const int end = min_ii(start + KEY_RELATIVE_CHUNK_SIZE, data->end);
+
+  for (int b = 0; b < data->blocks_len; b++) {
+    const KeyRelativeBlock *block = &data->blocks[b];
+    const KeyBlockDeltas *deltas = block->deltas;
+    const float *weights = block->weights;
+
+    if (deltas && deltas->indices) {
+      for (int i = keyblock_deltas_lower_bound(deltas, start);
+           i < deltas->len && deltas->indices[i] < end;
+           i++) {
+        const int index = deltas->indices[i];
+        const float weight = weights ? (weights[index] * block->curval) : block->curval;
+        madd_v3_v3fl(out[index], deltas->offsets[i], weight);
+      }
+    }
+    else if (weights) {
+      for (int index = start; index < end; index++) {
+        rel_flerp(KEYELEM_FLOAT_LEN_COORD,
+                  out[index],
+                  block->ref_co[index],
+                  block->co[index],
+                  weights[index] * block->curval);
+      }
+    }
+    else {
+      /* A single loop over all components of the chunk, simple enough to be vectorized. */
+      rel_flerp(KEYELEM_FLOAT_LEN_COORD * (end - start),
+                out[start],
+                block->ref_co[start],
+                block->co[start],
+                block->curval);
+    }
+  }
+}
+
+/**
+ * Blend relative keys of coordinates (meshes and lattices) into `out`,
+ * which was initialized with the reference key.
+ */
+static void key_evaluate_relative_coords(const int start,
+                                         const int end,
+                                         const int tot,
+                                         float (*out)[3],
+                                         Key *key,
+                                         KeyBlock *actkb,
+                                         float **per_keyblock_weights)
+{
+  BLI_assert(key->elemsize == sizeof(float[KEYELEM_FLOAT_LEN_COORD]));
+
+  /* Only evaluated keys are re-allocated when their data changes, original data may be edited
+   * in-place. */
+  const bool use_deltas = (key->id.tag & LIB_TAG_COPIED_ON_WRITE) != 0;
+
+  KeyRelativeBlock *blocks = MEM_malloc_arrayN(key->totkey, sizeof(*blocks), __func__);
+  char **freedata = MEM_calloc_arrayN(key->totkey, sizeof(*freedata), __func__);
+  int blocks_len = 0;
+
+  int keyblock_index;
+  KeyBlock *kb;
+  for (kb = key->block.first, keyblock_index = 0; kb; kb = kb->next, keyblock_index++) {
+    /* Only with value, and no difference allowed. */
+    if (kb == key->refkey || (kb->flag & KEYBLOCK_MUTE) || kb->curval == 0.0f ||
+        kb->totelem != tot) {
+      continue;
+    }
+
+    /* Reference now can be any block. */
+    KeyBlock *refb = BLI_findlink(&key->block, kb->relative);
+    if (refb == NULL) {
+      continue;
+    }
+
+    KeyRelativeBlock *block = &blocks[blocks_len];
+    block->co = (const float(*)[3])key_block_get_data(key, actkb, kb, &freedata[blocks_len]);
+    /* For meshes, use the original values instead of the bmesh values to
+     * maintain a constant offset. */
+    block->ref_co = refb->data;
+    block->weights = per_keyblock_weights ? per_keyblock_weights[keyblock_index] : NULL;
+    block->curval = kb->curval;
+    block->deltas = (use_deltas && freedata[blocks_len] == NULL) ?
+                        keyblock_deltas_ensure(kb, refb) :
+                        NULL;
+    blocks_len++;
+  }
+
+  if (blocks_len != 0) {
+    KeyRelativeData data = {
+        .out = out,
+        .blocks = blocks,
+        .blocks_len = blocks_len,
+        .start = start,
+        .end = end,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    const int chunks_len = (end - start + KEY_RELATIVE_CHUNK_SIZE - 1) / KEY_RELATIVE_CHUNK_SIZE;
+    BLI_task_parallel_range(0, chunks_len, &data, key_evaluate_relative_chunk_fn, &settings);
+  }
+
+  for (int i = 0; i < blocks_len; i++) {
+    MEM_SAFE_FREE(freedata[i]);
+  }
+  MEM_freeN(freedata);
+  MEM_freeN(blocks);
+}
+
+/** \} */
+
 static void key_evaluate_relative(const int start,
                                   int end,
                                   const int tot,
@@ -908,6 +1176,12 @@ static void key_evaluate_relative(const int start,
 
   /* step 2: do it */
 
+  if (mode == KEY_MODE_DUMMY && ELEM(GS(key->from->name), ID_ME, ID_LT)) {
+    key_evaluate_relative_coords(
+        start, end, tot, (float(*)[3])basispoin, key, actkb, per_keyblock_weights);
+    return;
+  }
+
   for (kb = key->block.first, keyblock_index = 0; kb; kb = kb->next, keyblock_index++) {
     if (kb != key->refkey) {
       float icuval = kb->curval;
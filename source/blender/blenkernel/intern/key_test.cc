@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_key.h"
+#include "BKE_mesh.h"
+
+#include "DNA_ipo_types.h"
+#include "DNA_key_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+
+namespace blender::bke::tests {
+
+/* More vertices than are blended by a single task. */
+static const int verts_len = 10000;
+
+static KeyBlock *keyblock_add(Key *key, const float curval)
+{
+  KeyBlock *kb = BKE_keyblock_add(key, nullptr);
+  kb->totelem = verts_len;
+  kb->curval = curval;
+  float(*co)[3] = (float(*)[3])MEM_malloc_arrayN(verts_len, sizeof(float[3]), __func__);
+  for (int i = 0; i < verts_len; i++) {
+    co[i][0] = (float)i;
+    co[i][1] = (float)(i % 10);
+    co[i][2] = 0.0f;
+  }
+  kb->data = co;
+  return kb;
+}
+
+/* Blend the keys one after the other, the way relative keys are defined. */
+static void key_evaluate_expect(const Key *key, const Mesh *mesh, float (*r_co)[3])
+{
+  memcpy(r_co, key->refkey->data, sizeof(float[3]) * verts_len);
+  LISTBASE_FOREACH (const KeyBlock *, kb, &key->block) {
+    if (kb == key->refkey || kb->curval == 0.0f) {
+      continue;
+    }
+    const float(*co)[3] = (const float(*)[3])kb->data;
+    const KeyBlock *refb = (const KeyBlock *)BLI_findlink(&key->block, kb->relative);
+    const float(*ref_co)[3] = (const float(*)[3])refb->data;
+    for (int i = 0; i < verts_len; i++) {
+      float weight = kb->curval;
+      if (kb->vgroup[0]) {
+        weight *= BKE_defvert_find_weight(&mesh->dvert[i], 0);
+      }
+      for (int axis = 0; axis < 3; axis++) {
+        r_co[i][axis] += weight * (co[i][axis] - ref_co[i][axis]);
+      }
+    }
+  }
+}
+
+static void key_evaluate_object_test(Object *ob)
+{
+  const Mesh *mesh = (const Mesh *)ob->data;
+  Array<float3> co_expect(verts_len);
+  key_evaluate_expect(mesh->key, mesh, (float(*)[3])co_expect.data());
+
+  int totelem;
+  float(*co)[3] = (float(*)[3])BKE_key_evaluate_object(ob, &totelem);
+  ASSERT_EQ(totelem, verts_len);
+  for (int i = 0; i < verts_len; i++) {
+    EXPECT_V3_NEAR(co[i], co_expect[i], 1e-4f);
+  }
+  MEM_freeN(co);
+}
+
+TEST(key, EvaluateRelative)
+{
+  Key key = {{nullptr}};
+  Mesh mesh = {{nullptr}};
+  Object ob = {{nullptr}};
+  bDeformGroup group = {nullptr};
+  IDType_ID_ME.init_data(&mesh.id);
+  IDType_ID_OB.init_data(&ob.id);
+  STRNCPY(mesh.id.name, "MEMesh");
+  STRNCPY(key.id.name, "KEKey");
+  ob.type = OB_MESH;
+  ob.data = &mesh;
+  ob.shapenr = 1;
+  STRNCPY(group.name, "Group");
+  BLI_addtail(&ob.defbase, &group);
+
+  mesh.totvert = verts_len;
+  mesh.key = &key;
+  CustomData_add_layer(&mesh.vdata, CD_MVERT, CD_CALLOC, nullptr, verts_len);
+  CustomData_add_layer(&mesh.vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, verts_len);
+  BKE_mesh_update_customdata_pointers(&mesh, false);
+  for (int i = 0; i < verts_len; i++) {
+    BKE_defvert_add_index_notest(&mesh.dvert[i], 0, (float)(i % 4) / 4.0f);
+  }
+
+  key.type = KEY_RELATIVE;
+  key.elemstr[0] = KEYELEM_FLOAT_LEN_COORD;
+  key.elemstr[1] = IPO_FLOAT;
+  key.elemsize = sizeof(float[KEYELEM_FLOAT_LEN_COORD]);
+  key.from = &mesh.id;
+
+  keyblock_add(&key, 0.0f);
+  /* Moves all vertices. */
+  KeyBlock *kb_all = keyblock_add(&key, 0.5f);
+  for (int i = 0; i < verts_len; i++) {
+    ((float(*)[3])kb_all->data)[i][2] = 1.0f;
+  }
+  /* Move a few vertices, relative to the basis, relative to another key and limited by a vertex
+   * group. */
+  KeyBlock *kb_sparse = keyblock_add(&key, 0.25f);
+  KeyBlock *kb_relative = keyblock_add(&key, 0.75f);
+  kb_relative->relative = 1;
+  KeyBlock *kb_vgroup = keyblock_add(&key, 1.0f);
+  STRNCPY(kb_vgroup->vgroup, group.name);
+  for (const int i : {0, 1, 4095, 4096, 9999}) {
+    ((float(*)[3])kb_sparse->data)[i][0] += 2.0f;
+    ((float(*)[3])kb_relative->data)[i][1] -= 1.0f;
+    ((float(*)[3])kb_vgroup->data)[i][2] += 3.0f;
+  }
+
+  key_evaluate_object_test(&ob);
+  EXPECT_EQ(kb_sparse->deltas, nullptr);
+
+  /* Offsets are only cached on evaluated keys. */
+  key.id.tag |= LIB_TAG_COPIED_ON_WRITE;
+  key_evaluate_object_test(&ob);
+  EXPECT_NE(kb_sparse->deltas, nullptr);
+  key_evaluate_object_test(&ob);
+
+  /* Cached offsets of data that was re-allocated are ignored. */
+  float(*co)[3] = (float(*)[3])MEM_dupallocN(kb_sparse->data);
+  add_v3_fl(co[verts_len / 2], 1.0f);
+  MEM_freeN(kb_sparse->data);
+  kb_sparse->data = co;
+  key_evaluate_object_test(&ob);
+
+  BLI_listbase_clear(&ob.defbase);
+  mesh.key = nullptr;
+  IDType_ID_KE.free_data(&key.id);
+  IDType_ID_OB.free_data(&ob.id);
+  IDType_ID_ME.free_data(&mesh.id);
+}
+
+}  // namespace blender::bke::tests
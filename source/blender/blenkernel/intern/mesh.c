@@ -42,6 +42,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -1760,6 +1761,7 @@ void BKE_mesh_vert_coords_apply(Mesh *mesh, const float (*vert_coords)[3])
     copy_v3_v3(mv->co, vert_coords[i]);
   }
   mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  mesh->runtime.cd_dirty_loop |= CD_MASK_NORMAL;
 }
 
 void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
@@ -1773,6 +1775,7 @@ void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
     mul_v3_m4v3(mv->co, mat, vert_coords[i]);
   }
   mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  mesh->runtime.cd_dirty_loop |= CD_MASK_NORMAL;
 }
 
 void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
@@ -1859,6 +1862,7 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
   }
 
   mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+  mesh->runtime.cd_dirty_loop &= ~CD_MASK_NORMAL;
 }
 
 void BKE_mesh_calc_normals_split(Mesh *mesh)
@@ -1866,6 +1870,28 @@ void BKE_mesh_calc_normals_split(Mesh *mesh)
   BKE_mesh_calc_normals_split_ex(mesh, NULL);
 }
 
+/**
+ * Ensure the 'split' normals (#CD_NORMAL loop layer) are valid, only calculating them
+ * when vertex positions or topology changed since they were last calculated.
+ *
+ * The modifier stack leaves them dirty for meshes which only need them for auto-smooth,
+ * since drawing calculates its own. Code reading them from an evaluated mesh calls this first.
+ * The layer itself is already added by the modifier stack, so other threads may keep reading
+ * the other layers of the mesh meanwhile.
+ */
+void BKE_mesh_ensure_normals_split(Mesh *mesh)
+{
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
+  BLI_mutex_lock(mesh_eval_mutex);
+
+  if ((mesh->runtime.cd_dirty_loop & CD_MASK_NORMAL) ||
+      !CustomData_has_layer(&mesh->ldata, CD_NORMAL)) {
+    BKE_mesh_calc_normals_split(mesh);
+  }
+
+  BLI_mutex_unlock(mesh_eval_mutex);
+}
+
 /* Split faces helper functions. */
 
 typedef struct SplitFaceNewVert {
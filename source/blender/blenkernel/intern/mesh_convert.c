@@ -1183,6 +1183,9 @@ static Mesh *mesh_new_from_mesh(Object *object, Mesh *mesh)
   /* While we could copy this into the new mesh,
    * add the data to 'mesh' so future calls to this function don't need to re-convert the data. */
   BKE_mesh_wrapper_ensure_mdata(mesh);
+  if (mesh->runtime.cd_dirty_loop & CD_MASK_NORMAL) {
+    BKE_mesh_ensure_normals_split(mesh);
+  }
 
   Mesh *mesh_result = (Mesh *)BKE_id_copy_ex(
       NULL, &mesh->id, NULL, LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT);
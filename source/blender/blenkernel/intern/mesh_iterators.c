@@ -190,6 +190,9 @@ void BKE_mesh_foreach_mapped_loop(Mesh *mesh,
     }
   }
   else {
+    if ((flag & MESH_FOREACH_USE_NORMAL) && (mesh->flag & ME_AUTOSMOOTH)) {
+      BKE_mesh_ensure_normals_split(mesh);
+    }
     const float(*lnors)[3] = (flag & MESH_FOREACH_USE_NORMAL) ?
                                  CustomData_get_layer(&mesh->ldata, CD_NORMAL) :
                                  NULL;
@@ -0,0 +1,173 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_math.h"
+
+namespace blender::bke::tests {
+
+/* Fill a mesh with a grid of `res * res` smooth quads with a wavy surface. */
+static void mesh_grid_init(Mesh *mesh, const int res)
+{
+  IDType_ID_ME.init_data(&mesh->id);
+  const int res_verts = res + 1;
+  mesh->totvert = res_verts * res_verts;
+  mesh->totpoly = res * res;
+  mesh->totloop = mesh->totpoly * 4;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  for (int y = 0; y < res_verts; y++) {
+    for (int x = 0; x < res_verts; x++) {
+      float *co = mesh->mvert[y * res_verts + x].co;
+      co[0] = (float)x;
+      co[1] = (float)y;
+      co[2] = sinf((float)x * 0.3f) * cosf((float)y * 0.2f) * 2.0f;
+    }
+  }
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      const int poly = y * res + x;
+      MPoly *mp = &mesh->mpoly[poly];
+      mp->loopstart = poly * 4;
+      mp->totloop = 4;
+      mp->flag = ME_SMOOTH;
+      MLoop *ml = &mesh->mloop[mp->loopstart];
+      ml[0].v = y * res_verts + x;
+      ml[1].v = y * res_verts + x + 1;
+      ml[2].v = (y + 1) * res_verts + x + 1;
+      ml[3].v = (y + 1) * res_verts + x;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+}
+
+static void mesh_calc_vert_normals(Mesh *mesh, float (*r_vnors)[3], float (*r_pnors)[3])
+{
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             r_vnors,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             r_pnors,
+                             false);
+}
+
+TEST(mesh_calc_normals_poly, AngleWeighted)
+{
+  Mesh mesh = {{nullptr}};
+  mesh_grid_init(&mesh, 64);
+
+  Array<float3> vnors(mesh.totvert);
+  Array<float3> pnors(mesh.totpoly);
+  mesh_calc_vert_normals(&mesh, (float(*)[3])vnors.data(), (float(*)[3])pnors.data());
+
+  Array<float3> vnors_expect(mesh.totvert, float3(0.0f));
+  for (int i = 0; i < mesh.totpoly; i++) {
+    const MPoly *mp = &mesh.mpoly[i];
+    const MLoop *ml = &mesh.mloop[mp->loopstart];
+    float pnor[3];
+    BKE_mesh_calc_poly_normal(mp, ml, mesh.mvert, pnor);
+    /* Quads use the cross product of their diagonals instead of Newell's method. */
+    EXPECT_V3_NEAR(pnors[i], pnor, 1e-4f);
+
+    float *vnors_poly[4];
+    const float *cos_poly[4];
+    float vdiffs[4][3];
+    for (int j = 0; j < 4; j++) {
+      vnors_poly[j] = vnors_expect[ml[j].v];
+      cos_poly[j] = mesh.mvert[ml[j].v].co;
+    }
+    accumulate_vertex_normals_poly_v3(vnors_poly, pnor, cos_poly, vdiffs, 4);
+  }
+
+  for (int i = 0; i < mesh.totvert; i++) {
+    normalize_v3(vnors_expect[i]);
+    EXPECT_V3_NEAR(vnors[i], vnors_expect[i], 1e-4f);
+
+    float vno[3];
+    normal_short_to_float_v3(vno, mesh.mvert[i].no);
+    EXPECT_V3_NEAR(vno, vnors_expect[i], 1e-3f);
+  }
+
+  IDType_ID_ME.free_data(&mesh.id);
+}
+
+TEST(mesh_calc_normals_poly, Reproducible)
+{
+  Mesh mesh = {{nullptr}};
+  mesh_grid_init(&mesh, 256);
+
+  Array<float3> vnors_first(mesh.totvert);
+  mesh_calc_vert_normals(&mesh, (float(*)[3])vnors_first.data(), nullptr);
+
+  /* Vertex normals don't depend on the order in which the polygons were handled by threads. */
+  for (int run = 0; run < 10; run++) {
+    Array<float3> vnors(mesh.totvert);
+    mesh_calc_vert_normals(&mesh, (float(*)[3])vnors.data(), nullptr);
+    EXPECT_EQ(memcmp(vnors.data(), vnors_first.data(), sizeof(float3) * vnors.size()), 0);
+  }
+
+  IDType_ID_ME.free_data(&mesh.id);
+}
+
+TEST(mesh_normals_split, EnsureCached)
+{
+  Mesh mesh = {{nullptr}};
+  mesh_grid_init(&mesh, 8);
+  mesh.flag |= ME_AUTOSMOOTH;
+  mesh.runtime.cd_dirty_loop |= CD_MASK_NORMAL;
+
+  BKE_mesh_ensure_normals_split(&mesh);
+  float(*lnors)[3] = (float(*)[3])CustomData_get_layer(&mesh.ldata, CD_NORMAL);
+  ASSERT_NE(lnors, nullptr);
+  EXPECT_FALSE(mesh.runtime.cd_dirty_loop & CD_MASK_NORMAL);
+  const float3 lnor_first = lnors[0];
+
+  /* Valid normals are not calculated again. */
+  zero_v3(lnors[0]);
+  BKE_mesh_ensure_normals_split(&mesh);
+  EXPECT_EQ(float3(lnors[0]), float3(0.0f));
+
+  /* Moving vertices invalidates them, they are calculated again in the same layer. */
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(&mesh, nullptr);
+  BKE_mesh_vert_coords_apply(&mesh, vert_coords);
+  MEM_freeN(vert_coords);
+  EXPECT_TRUE(mesh.runtime.cd_dirty_loop & CD_MASK_NORMAL);
+
+  BKE_mesh_ensure_normals_split(&mesh);
+  EXPECT_EQ(CustomData_get_layer(&mesh.ldata, CD_NORMAL), lnors);
+  EXPECT_V3_NEAR(lnors[0], lnor_first, 1e-6f);
+
+  IDType_ID_ME.free_data(&mesh.id);
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,386 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <array>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_hash_mm2a.h"
+#include "BLI_map.hh"
+#include "BLI_string.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_playback_cache.h"
+
+using blender::Array;
+using blender::float3;
+using blender::IndexRange;
+using blender::Map;
+
+/* Vertices are copied in parallel in ranges of this size. */
+#define VERTS_GRAIN_SIZE 4096
+
+namespace blender::bke::playback_cache {
+
+/* Vertex positions and normals of one mesh on one frame. */
+struct FrameVerts {
+  Array<float3> positions;
+  /* Positions within the bounds, used instead of #positions when quantization is enabled. */
+  Array<std::array<uint16_t, 3>> positions_quantized;
+  float3 bounds_min, bounds_max;
+  Array<std::array<short, 3>> normals;
+};
+
+struct Frame {
+  FrameVerts deform, final;
+};
+
+/* Mesh shared by all frames, only its vertex positions and normals are replaced. */
+struct Topology {
+  Mesh *mesh = nullptr;
+  /* Hash of all the other data, see #mesh_data_hash. */
+  uint32_t data_hash = 0;
+
+  ~Topology()
+  {
+    this->clear();
+  }
+
+  void clear()
+  {
+    if (mesh) {
+      BKE_id_free(nullptr, mesh);
+      mesh = nullptr;
+    }
+  }
+};
+
+static bool customdata_hash_add(BLI_HashMurmur2A *mm2,
+                                const CustomData *data,
+                                const int totelem,
+                                const bool skip_normals)
+{
+  for (const int i : IndexRange(data->totlayer)) {
+    const CustomDataLayer *layer = &data->layers[i];
+    BLI_hash_mm2a_add_int(mm2, layer->type);
+    BLI_hash_mm2a_add(mm2, (const unsigned char *)layer->name, strlen(layer->name));
+
+    switch (layer->type) {
+      case CD_MVERT: {
+        /* Positions and normals are stored per frame. */
+        const MVert *mvert = (const MVert *)layer->data;
+        for (const int j : IndexRange(totelem)) {
+          BLI_hash_mm2a_add_int(mm2, mvert[j].flag);
+          BLI_hash_mm2a_add_int(mm2, mvert[j].bweight);
+        }
+        break;
+      }
+      case CD_NORMAL:
+        /* Face and split normals depend on the positions, they are computed again. */
+        if (!skip_normals) {
+          return false;
+        }
+        break;
+      case CD_MDEFORMVERT: {
+        const MDeformVert *dvert = (const MDeformVert *)layer->data;
+        for (const int j : IndexRange(totelem)) {
+          BLI_hash_mm2a_add(mm2,
+                            (const unsigned char *)dvert[j].dw,
+                            sizeof(*dvert[j].dw) * (size_t)dvert[j].totweight);
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+        /* Elements with allocated data are not compared. */
+        return false;
+      default:
+        BLI_hash_mm2a_add(mm2,
+                          (const unsigned char *)layer->data,
+                          CustomData_sizeof(layer->type) * (size_t)totelem);
+        break;
+    }
+  }
+  return true;
+}
+
+/**
+ * Hash the topology and all data layers, except for the vertex positions and normals.
+ * \return False when the mesh has data that can't be cached.
+ */
+static bool mesh_data_hash(const Mesh *mesh, uint32_t *r_hash)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+  if (!customdata_hash_add(&mm2, &mesh->vdata, mesh->totvert, false) ||
+      !customdata_hash_add(&mm2, &mesh->edata, mesh->totedge, false) ||
+      !customdata_hash_add(&mm2, &mesh->pdata, mesh->totpoly, true) ||
+      !customdata_hash_add(&mm2, &mesh->ldata, mesh->totloop, true)) {
+    return false;
+  }
+  *r_hash = BLI_hash_mm2a_end(&mm2);
+  return true;
+}
+
+static bool topology_matches(const Topology &topology, const Mesh *mesh)
+{
+  uint32_t data_hash;
+  return mesh_data_hash(mesh, &data_hash) && topology.data_hash == data_hash;
+}
+
+/* \return False when the mesh has data that can't be cached. */
+static bool topology_set(Topology &topology, const Mesh *mesh)
+{
+  topology.clear();
+  if (!mesh_data_hash(mesh, &topology.data_hash)) {
+    return false;
+  }
+  topology.mesh = BKE_mesh_copy_for_eval((Mesh *)mesh, false);
+
+  /* Face and split normals depend on the positions, they are computed again after reading. */
+  CustomData_free_layers(&topology.mesh->pdata, CD_NORMAL, topology.mesh->totpoly);
+  CustomData_free_layers(&topology.mesh->ldata, CD_NORMAL, topology.mesh->totloop);
+  return true;
+}
+
+static size_t frame_verts_size(const FrameVerts &verts)
+{
+  return (size_t)(verts.positions.as_span().size_in_bytes() +
+                  verts.positions_quantized.as_span().size_in_bytes() +
+                  verts.normals.as_span().size_in_bytes());
+}
+
+static void frame_verts_write(FrameVerts &verts, const Mesh *mesh, const bool use_quantize)
+{
+  const MVert *mvert = mesh->mvert;
+  const int totvert = mesh->totvert;
+
+  verts.normals.reinitialize(totvert);
+
+  if (use_quantize) {
+    INIT_MINMAX(verts.bounds_min, verts.bounds_max);
+    for (const int i : IndexRange(totvert)) {
+      minmax_v3v3_v3(verts.bounds_min, verts.bounds_max, mvert[i].co);
+    }
+    float3 scale = verts.bounds_max - verts.bounds_min;
+    for (int axis = 0; axis < 3; axis++) {
+      scale[axis] = (scale[axis] > 0.0f) ? (float)UINT16_MAX / scale[axis] : 0.0f;
+    }
+
+    verts.positions_quantized.reinitialize(totvert);
+    blender::parallel_for(IndexRange(totvert), VERTS_GRAIN_SIZE, [&](IndexRange range) {
+      for (const int i : range) {
+        for (int axis = 0; axis < 3; axis++) {
+          const float value = (mvert[i].co[axis] - verts.bounds_min[axis]) * scale[axis];
+          verts.positions_quantized[i][axis] = (uint16_t)(value + 0.5f);
+        }
+        copy_v3_v3_short(verts.normals[i].data(), mvert[i].no);
+      }
+    });
+  }
+  else {
+    verts.positions.reinitialize(totvert);
+    blender::parallel_for(IndexRange(totvert), VERTS_GRAIN_SIZE, [&](IndexRange range) {
+      for (const int i : range) {
+        verts.positions[i] = mvert[i].co;
+        copy_v3_v3_short(verts.normals[i].data(), mvert[i].no);
+      }
+    });
+  }
+}
+
+static Mesh *frame_verts_read(const Topology &topology, const FrameVerts &verts)
+{
+  Mesh *mesh = BKE_mesh_copy_for_eval(topology.mesh, false);
+  MVert *mvert = mesh->mvert;
+
+  if (!verts.positions_quantized.is_empty()) {
+    const float3 scale = (verts.bounds_max - verts.bounds_min) * (1.0f / (float)UINT16_MAX);
+    blender::parallel_for(IndexRange(mesh->totvert), VERTS_GRAIN_SIZE, [&](IndexRange range) {
+      for (const int i : range) {
+        for (int axis = 0; axis < 3; axis++) {
+          mvert[i].co[axis] = verts.bounds_min[axis] +
+                              (float)verts.positions_quantized[i][axis] * scale[axis];
+        }
+        copy_v3_v3_short(mvert[i].no, verts.normals[i].data());
+      }
+    });
+  }
+  else {
+    blender::parallel_for(IndexRange(mesh->totvert), VERTS_GRAIN_SIZE, [&](IndexRange range) {
+      for (const int i : range) {
+        copy_v3_v3(mvert[i].co, verts.positions[i]);
+        copy_v3_v3_short(mvert[i].no, verts.normals[i].data());
+      }
+    });
+  }
+
+  return mesh;
+}
+
+}  // namespace blender::bke::playback_cache
+
+using namespace blender::bke::playback_cache;
+
+struct MeshPlaybackCache {
+  Topology deform, final;
+  Map<int, Frame> frames;
+  /* Memory used by #frames. */
+  size_t frames_size;
+
+  /* Evaluation settings of the cached frames. */
+  CustomData_MeshMasks data_mask;
+  bool need_mapping;
+  bool use_quantize;
+
+  /**
+   * Set when the topology or any data other than the vertex positions and normals changes
+   * between frames, nothing is cached until the cache is cleared.
+   */
+  bool is_data_varying;
+};
+
+MeshPlaybackCache *BKE_mesh_playback_cache_new(void)
+{
+  MeshPlaybackCache *cache = OBJECT_GUARDED_NEW(MeshPlaybackCache);
+  BKE_mesh_playback_cache_clear(cache);
+  return cache;
+}
+
+void BKE_mesh_playback_cache_free(MeshPlaybackCache *cache)
+{
+  OBJECT_GUARDED_DELETE(cache, MeshPlaybackCache);
+}
+
+void BKE_mesh_playback_cache_clear(MeshPlaybackCache *cache)
+{
+  cache->deform.clear();
+  cache->final.clear();
+  cache->frames.clear();
+  cache->frames_size = 0;
+  memset(&cache->data_mask, 0, sizeof(cache->data_mask));
+  cache->need_mapping = false;
+  cache->use_quantize = false;
+  cache->is_data_varying = false;
+}
+
+/**
+ * Create the deformed and final mesh of a cached frame.
+ * \return False when the frame is not cached with the requested data layers.
+ */
+bool BKE_mesh_playback_cache_read(MeshPlaybackCache *cache,
+                                  const int frame,
+                                  const CustomData_MeshMasks *data_mask,
+                                  const bool need_mapping,
+                                  Mesh **r_mesh_deform,
+                                  Mesh **r_mesh_final)
+{
+  if (!CustomData_MeshMasks_are_matching(&cache->data_mask, data_mask) ||
+      (need_mapping && !cache->need_mapping)) {
+    return false;
+  }
+  const Frame *cached_frame = cache->frames.lookup_ptr(frame);
+  if (cached_frame == nullptr) {
+    return false;
+  }
+  *r_mesh_deform = frame_verts_read(cache->deform, cached_frame->deform);
+  *r_mesh_final = frame_verts_read(cache->final, cached_frame->final);
+  return true;
+}
+
+/**
+ * Store the evaluated meshes of a frame. Frames evaluated with other settings than the already
+ * cached ones replace them. New frames are not stored once the cached frames use
+ * \a memory_limit bytes, zero for no limit.
+ */
+void BKE_mesh_playback_cache_write(MeshPlaybackCache *cache,
+                                   const int frame,
+                                   const CustomData_MeshMasks *data_mask,
+                                   const bool need_mapping,
+                                   const bool use_quantize,
+                                   const size_t memory_limit,
+                                   const Mesh *mesh_deform,
+                                   const Mesh *mesh_final)
+{
+  if (!CustomData_MeshMasks_are_matching(data_mask, &cache->data_mask) ||
+      !CustomData_MeshMasks_are_matching(&cache->data_mask, data_mask) ||
+      need_mapping != cache->need_mapping || use_quantize != cache->use_quantize) {
+    BKE_mesh_playback_cache_clear(cache);
+    cache->data_mask = *data_mask;
+    cache->need_mapping = need_mapping;
+    cache->use_quantize = use_quantize;
+  }
+  if (cache->is_data_varying) {
+    return;
+  }
+
+  Frame *cached_frame = cache->frames.lookup_ptr(frame);
+  if (cached_frame == nullptr && memory_limit != 0 && cache->frames_size >= memory_limit) {
+    return;
+  }
+
+  bool is_data_matching;
+  if (cache->frames.is_empty()) {
+    is_data_matching = topology_set(cache->deform, mesh_deform) &&
+                       topology_set(cache->final, mesh_final);
+  }
+  else {
+    is_data_matching = topology_matches(cache->deform, mesh_deform) &&
+                       topology_matches(cache->final, mesh_final);
+  }
+  if (!is_data_matching) {
+    BKE_mesh_playback_cache_clear(cache);
+    cache->data_mask = *data_mask;
+    cache->need_mapping = need_mapping;
+    cache->use_quantize = use_quantize;
+    cache->is_data_varying = true;
+    return;
+  }
+
+  if (cached_frame) {
+    cache->frames_size -= frame_verts_size(cached_frame->deform) +
+                          frame_verts_size(cached_frame->final);
+  }
+  else {
+    cached_frame = &cache->frames.lookup_or_add_default(frame);
+  }
+  frame_verts_write(cached_frame->deform, mesh_deform, use_quantize);
+  frame_verts_write(cached_frame->final, mesh_final, use_quantize);
+  cache->frames_size += frame_verts_size(cached_frame->deform) +
+                        frame_verts_size(cached_frame->final);
+}
+
+int BKE_mesh_playback_cache_frames_len(const MeshPlaybackCache *cache)
+{
+  return (int)cache->frames.size();
+}
@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_playback_cache.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+
+namespace blender::bke::tests {
+
+/* Strip of quads, the vertices are moved by the frame number. */
+static Mesh *mesh_strip_new(const int quads_len, const float frame)
+{
+  const int verts_len = (quads_len + 1) * 2;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, quads_len * 4, quads_len);
+  for (int i = 0; i < verts_len; i++) {
+    mesh->mvert[i].co[0] = (float)(i / 2);
+    mesh->mvert[i].co[1] = (float)(i % 2);
+    mesh->mvert[i].co[2] = sinf((float)i + frame);
+  }
+  for (int i = 0; i < quads_len; i++) {
+    mesh->mpoly[i].loopstart = i * 4;
+    mesh->mpoly[i].totloop = 4;
+    mesh->mloop[i * 4 + 0].v = i * 2;
+    mesh->mloop[i * 4 + 1].v = i * 2 + 2;
+    mesh->mloop[i * 4 + 2].v = i * 2 + 3;
+    mesh->mloop[i * 4 + 3].v = i * 2 + 1;
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+static void expect_meshes_near(const Mesh *mesh, const Mesh *mesh_expect, const float threshold)
+{
+  ASSERT_EQ(mesh->totvert, mesh_expect->totvert);
+  ASSERT_EQ(mesh->totloop, mesh_expect->totloop);
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_V3_NEAR(mesh->mvert[i].co, mesh_expect->mvert[i].co, threshold);
+    EXPECT_EQ(mesh->mvert[i].no[0], mesh_expect->mvert[i].no[0]);
+    EXPECT_EQ(mesh->mvert[i].no[1], mesh_expect->mvert[i].no[1]);
+    EXPECT_EQ(mesh->mvert[i].no[2], mesh_expect->mvert[i].no[2]);
+  }
+  for (int i = 0; i < mesh->totloop; i++) {
+    EXPECT_EQ(mesh->mloop[i].v, mesh_expect->mloop[i].v);
+  }
+}
+
+static void test_playback_cache(const bool use_quantize, const float threshold)
+{
+  MeshPlaybackCache *cache = BKE_mesh_playback_cache_new();
+  const CustomData_MeshMasks mask = CD_MASK_MESH;
+
+  Mesh *meshes[3];
+  for (int frame = 0; frame < 3; frame++) {
+    meshes[frame] = mesh_strip_new(100, (float)frame);
+    BKE_mesh_playback_cache_write(
+        cache, frame, &mask, false, use_quantize, 0, meshes[frame], meshes[frame]);
+  }
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 3);
+
+  for (int frame = 2; frame >= 0; frame--) {
+    Mesh *mesh_deform, *mesh_final;
+    ASSERT_TRUE(BKE_mesh_playback_cache_read(
+        cache, frame, &mask, false, &mesh_deform, &mesh_final));
+    expect_meshes_near(mesh_deform, meshes[frame], threshold);
+    expect_meshes_near(mesh_final, meshes[frame], threshold);
+    BKE_id_free(nullptr, mesh_deform);
+    BKE_id_free(nullptr, mesh_final);
+  }
+
+  /* Frames that were not written and frames needing more data layers can't be read. */
+  Mesh *mesh_deform, *mesh_final;
+  EXPECT_FALSE(
+      BKE_mesh_playback_cache_read(cache, 3, &mask, false, &mesh_deform, &mesh_final));
+  EXPECT_FALSE(BKE_mesh_playback_cache_read(cache, 0, &mask, true, &mesh_deform, &mesh_final));
+  CustomData_MeshMasks mask_orco = mask;
+  mask_orco.vmask |= CD_MASK_ORCO;
+  EXPECT_FALSE(
+      BKE_mesh_playback_cache_read(cache, 0, &mask_orco, false, &mesh_deform, &mesh_final));
+
+  /* A change of topology clears the cache. */
+  Mesh *mesh_other = mesh_strip_new(50, 3.0f);
+  BKE_mesh_playback_cache_write(cache, 3, &mask, false, use_quantize, 0, mesh_other, mesh_other);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 0);
+  BKE_mesh_playback_cache_write(cache, 4, &mask, false, use_quantize, 0, mesh_other, mesh_other);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 0);
+
+  /* Clearing starts caching again. */
+  BKE_mesh_playback_cache_clear(cache);
+  BKE_mesh_playback_cache_write(cache, 4, &mask, false, use_quantize, 0, mesh_other, mesh_other);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 1);
+
+  BKE_id_free(nullptr, mesh_other);
+  for (Mesh *mesh : meshes) {
+    BKE_id_free(nullptr, mesh);
+  }
+  BKE_mesh_playback_cache_free(cache);
+}
+
+class mesh_playback_cache : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    /* Needed to copy and free meshes. */
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(mesh_playback_cache, ReadWrite)
+{
+  test_playback_cache(false, 0.0f);
+}
+
+TEST_F(mesh_playback_cache, Quantize)
+{
+  /* Positions are within a range of 100 units. */
+  test_playback_cache(true, 100.0f / 65535.0f);
+}
+
+TEST_F(mesh_playback_cache, DataVarying)
+{
+  MeshPlaybackCache *cache = BKE_mesh_playback_cache_new();
+  const CustomData_MeshMasks mask = CD_MASK_MESH;
+
+  Mesh *meshes[2];
+  for (int frame = 0; frame < 2; frame++) {
+    meshes[frame] = mesh_strip_new(10, (float)frame);
+    MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+        &meshes[frame]->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, meshes[frame]->totloop);
+    mloopuv[0].uv[0] = (float)frame;
+  }
+
+  /* Data layers other than the positions can't change between frames. */
+  BKE_mesh_playback_cache_write(cache, 0, &mask, false, false, 0, meshes[0], meshes[0]);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 1);
+  BKE_mesh_playback_cache_write(cache, 1, &mask, false, false, 0, meshes[1], meshes[1]);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 0);
+  BKE_mesh_playback_cache_write(cache, 0, &mask, false, false, 0, meshes[0], meshes[0]);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 0);
+
+  for (Mesh *mesh : meshes) {
+    BKE_id_free(nullptr, mesh);
+  }
+  BKE_mesh_playback_cache_free(cache);
+}
+
+TEST_F(mesh_playback_cache, MemoryLimit)
+{
+  MeshPlaybackCache *cache = BKE_mesh_playback_cache_new();
+  const CustomData_MeshMasks mask = CD_MASK_MESH;
+
+  /* Each frame stores the positions and normals of 202 vertices, twice. */
+  const size_t frame_size = 2 * 202 * (sizeof(float[3]) + sizeof(short[3]));
+  for (int frame = 0; frame < 5; frame++) {
+    Mesh *mesh = mesh_strip_new(100, (float)frame);
+    BKE_mesh_playback_cache_write(
+        cache, frame, &mask, false, false, frame_size * 3, mesh, mesh);
+    BKE_id_free(nullptr, mesh);
+  }
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 3);
+
+  /* Cached frames can still be updated. */
+  Mesh *mesh = mesh_strip_new(100, 10.0f);
+  BKE_mesh_playback_cache_write(cache, 0, &mask, false, false, frame_size * 3, mesh, mesh);
+  EXPECT_EQ(BKE_mesh_playback_cache_frames_len(cache), 3);
+  Mesh *mesh_deform, *mesh_final;
+  ASSERT_TRUE(BKE_mesh_playback_cache_read(cache, 0, &mask, false, &mesh_deform, &mesh_final));
+  expect_meshes_near(mesh_final, mesh, 0.0f);
+  BKE_id_free(nullptr, mesh_deform);
+  BKE_id_free(nullptr, mesh_final);
+  BKE_id_free(nullptr, mesh);
+
+  BKE_mesh_playback_cache_free(cache);
+}
+
+}  // namespace blender::bke::tests
@@ -751,6 +751,9 @@ void BKE_mesh_calc_loop_tangents(Mesh *me_eval,
                                  int tangent_names_len)
 {
   BKE_mesh_runtime_looptri_ensure(me_eval);
+  if (me_eval->flag & ME_AUTOSMOOTH) {
+    BKE_mesh_ensure_normals_split(me_eval);
+  }
 
   /* TODO(campbell): store in Mesh.runtime to avoid recalculation. */
   short tangent_mask = 0;
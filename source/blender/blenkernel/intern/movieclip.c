@@ -891,6 +891,8 @@ static bool put_imbuf_cache(
                                          moviecache_getprioritydata,
                                          moviecache_getitempriority,
                                          moviecache_prioritydeleter);
+    /* Frames are decoded from movie files and may be undistorted or stabilized. */
+    IMB_moviecache_set_cost(moviecache, 4.0f);
 
     clip->cache->moviecache = moviecache;
     clip->cache->sequence_offset = -1;
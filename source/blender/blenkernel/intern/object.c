@@ -118,6 +118,7 @@
 #include "BKE_material.h"
 #include "BKE_mball.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_playback_cache.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
 #include "BKE_multires.h"
@@ -318,6 +319,11 @@ static void object_free_data(ID *id)
     ob->runtime.curve_cache = NULL;
   }
 
+  if (ob->runtime.playback_cache) {
+    BKE_mesh_playback_cache_free(ob->runtime.playback_cache);
+    ob->runtime.playback_cache = NULL;
+  }
+
   BKE_previewimg_free(&ob->preview);
 }
 
@@ -5057,6 +5063,7 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->curve_cache = NULL;
   runtime->object_as_temp_mesh = NULL;
   runtime->geometry_set_eval = NULL;
+  runtime->playback_cache = NULL;
 }
 
 /**
@@ -171,17 +171,140 @@ static bool grid_materials_match(const DMFlagMat *f1, const DMFlagMat *f2)
   return ((f1->flag & ME_SMOOTH) == (f2->flag & ME_SMOOTH) && (f1->mat_nr == f2->mat_nr));
 }
 
-/* Adapted from BLI_kdopbvh.c */
+/* Number of bins per axis used to evaluate the surface area heuristic. */
+#define SAH_BINS 16
+
+/* Nodes with more primitives than this compute their bounds and bins multi-threaded. */
+#define BUILD_PARALLEL_LIMIT 100000
+
+typedef struct SAHBin {
+  BB bb;
+  int count;
+} SAHBin;
+
+typedef struct PBVHBuildRangeData {
+  const int *prim_indices;
+  BBC *prim_bbc;
+
+  /* Bin placement along each axis, only used for binning. */
+  float bin_min[3];
+  float bin_scale[3];
+} PBVHBuildRangeData;
+
+typedef struct PBVHBuildBoundsTLS {
+  BB vb;
+  BB cb;
+} PBVHBuildBoundsTLS;
+
+typedef struct PBVHBuildBinsTLS {
+  SAHBin bins[3][SAH_BINS];
+} PBVHBuildBinsTLS;
+
+/* Half the surface area of the box, enough to compare costs. */
+static float BB_half_area(const BB *bb)
+{
+  const float dx = bb->bmax[0] - bb->bmin[0];
+  const float dy = bb->bmax[1] - bb->bmin[1];
+  const float dz = bb->bmax[2] - bb->bmin[2];
+  return dx * dy + dy * dz + dz * dx;
+}
+
+static void build_bounds_cb(void *__restrict userdata,
+                            const int i,
+                            const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildRangeData *data = userdata;
+  PBVHBuildBoundsTLS *bounds = tls->userdata_chunk;
+  BBC *bbc = &data->prim_bbc[data->prim_indices[i]];
+
+  BB_expand_with_bb(&bounds->vb, (BB *)bbc);
+  BB_expand(&bounds->cb, bbc->bcentroid);
+}
+
+static void build_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                void *__restrict chunk_join,
+                                void *__restrict chunk)
+{
+  PBVHBuildBoundsTLS *join = chunk_join;
+  PBVHBuildBoundsTLS *bounds = chunk;
+
+  BB_expand_with_bb(&join->vb, &bounds->vb);
+  BB_expand_with_bb(&join->cb, &bounds->cb);
+}
+
+/* Calculate the bounds of the primitives (vb) and of their centroids (cb) in the range. */
+static void build_bounds(PBVH *pbvh, BBC *prim_bbc, int offset, int count, BB *r_vb, BB *r_cb)
+{
+  PBVHBuildRangeData data = {
+      .prim_indices = pbvh->prim_indices,
+      .prim_bbc = prim_bbc,
+  };
+
+  PBVHBuildBoundsTLS bounds;
+  BB_reset(&bounds.vb);
+  BB_reset(&bounds.cb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = count > BUILD_PARALLEL_LIMIT;
+  settings.userdata_chunk = &bounds;
+  settings.userdata_chunk_size = sizeof(bounds);
+  settings.func_reduce = build_bounds_reduce;
+  BLI_task_parallel_range(offset, offset + count, &data, build_bounds_cb, &settings);
+
+  *r_vb = bounds.vb;
+  *r_cb = bounds.cb;
+}
+
+BLI_INLINE int sah_bin_index(const PBVHBuildRangeData *data, const float co[3], int axis)
+{
+  const int bin = (int)((co[axis] - data->bin_min[axis]) * data->bin_scale[axis]);
+  return CLAMPIS(bin, 0, SAH_BINS - 1);
+}
+
+static void build_bins_cb(void *__restrict userdata,
+                          const int i,
+                          const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildRangeData *data = userdata;
+  PBVHBuildBinsTLS *bins = tls->userdata_chunk;
+  BBC *bbc = &data->prim_bbc[data->prim_indices[i]];
+
+  for (int axis = 0; axis < 3; axis++) {
+    SAHBin *bin = &bins->bins[axis][sah_bin_index(data, bbc->bcentroid, axis)];
+    BB_expand_with_bb(&bin->bb, (BB *)bbc);
+    bin->count++;
+  }
+}
+
+static void build_bins_reduce(const void *__restrict UNUSED(userdata),
+                              void *__restrict chunk_join,
+                              void *__restrict chunk)
+{
+  PBVHBuildBinsTLS *join = chunk_join;
+  PBVHBuildBinsTLS *bins = chunk;
+
+  for (int axis = 0; axis < 3; axis++) {
+    for (int b = 0; b < SAH_BINS; b++) {
+      BB_expand_with_bb(&join->bins[axis][b].bb, &bins->bins[axis][b].bb);
+      join->bins[axis][b].count += bins->bins[axis][b].count;
+    }
+  }
+}
+
 /* Returns the index of the first element on the right of the partition */
-static int partition_indices(int *prim_indices, int lo, int hi, int axis, float mid, BBC *prim_bbc)
+static int partition_indices_bin(
+    const PBVHBuildRangeData *data, int *prim_indices, int lo, int hi, int axis, int split_bin)
 {
   int i = lo, j = hi;
   for (;;) {
-    for (; prim_bbc[prim_indices[i]].bcentroid[axis] < mid; i++) {
-      /* pass */
+    while (i <= j &&
+           sah_bin_index(data, data->prim_bbc[prim_indices[i]].bcentroid, axis) <= split_bin) {
+      i++;
     }
-    for (; mid < prim_bbc[prim_indices[j]].bcentroid[axis]; j--) {
-      /* pass */
+    while (i <= j &&
+           sah_bin_index(data, data->prim_bbc[prim_indices[j]].bcentroid, axis) > split_bin) {
+      j--;
     }
 
     if (!(i < j)) {
@@ -190,7 +313,100 @@ static int partition_indices(int *prim_indices, int lo, int hi, int axis, float
 
     SWAP(int, prim_indices[i], prim_indices[j]);
     i++;
+    j--;
+  }
+}
+
+/**
+ * Partition the primitives with a binned surface area heuristic: the centroid bounds (cb) are
+ * divided into #SAH_BINS bins along each axis, and of all the planes between bins the one with
+ * the lowest summed `area * count` of both sides is used.
+ *
+ * Returns the index of the first element on the right of the partition.
+ */
+static int partition_indices_sah(PBVH *pbvh, BBC *prim_bbc, const BB *cb, int offset, int count)
+{
+  PBVHBuildRangeData data = {
+      .prim_indices = pbvh->prim_indices,
+      .prim_bbc = prim_bbc,
+  };
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = cb->bmax[axis] - cb->bmin[axis];
+    data.bin_min[axis] = cb->bmin[axis];
+    data.bin_scale[axis] = (extent > 0.0f) ? (float)SAH_BINS / extent : 0.0f;
+  }
+
+  PBVHBuildBinsTLS *bins = MEM_mallocN(sizeof(*bins), __func__);
+  for (int axis = 0; axis < 3; axis++) {
+    for (int b = 0; b < SAH_BINS; b++) {
+      BB_reset(&bins->bins[axis][b].bb);
+      bins->bins[axis][b].count = 0;
+    }
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = count > BUILD_PARALLEL_LIMIT;
+  settings.userdata_chunk = bins;
+  settings.userdata_chunk_size = sizeof(*bins);
+  settings.func_reduce = build_bins_reduce;
+  BLI_task_parallel_range(offset, offset + count, &data, build_bins_cb, &settings);
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  int best_bin = 0;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (data.bin_scale[axis] == 0.0f) {
+      continue;
+    }
+    const SAHBin *axis_bins = bins->bins[axis];
+
+    /* Sweep from the right to gather the cost of everything above each plane. */
+    float right_area[SAH_BINS];
+    int right_count[SAH_BINS];
+    BB bb;
+    BB_reset(&bb);
+    int totprim = 0;
+    for (int b = SAH_BINS - 1; b > 0; b--) {
+      if (axis_bins[b].count) {
+        BB_expand_with_bb(&bb, (BB *)&axis_bins[b].bb);
+        totprim += axis_bins[b].count;
+      }
+      right_area[b] = totprim ? BB_half_area(&bb) : 0.0f;
+      right_count[b] = totprim;
+    }
+
+    /* Then from the left, evaluating the plane above each bin. */
+    BB_reset(&bb);
+    totprim = 0;
+    for (int b = 0; b < SAH_BINS - 1; b++) {
+      if (axis_bins[b].count) {
+        BB_expand_with_bb(&bb, (BB *)&axis_bins[b].bb);
+        totprim += axis_bins[b].count;
+      }
+      if (totprim == 0 || right_count[b + 1] == 0) {
+        continue;
+      }
+      const float cost = BB_half_area(&bb) * totprim + right_area[b + 1] * right_count[b + 1];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+      }
+    }
   }
+
+  MEM_freeN(bins);
+
+  if (best_axis == -1) {
+    /* All centroids coincide, any split is as good as another. */
+    return offset + count / 2;
+  }
+
+  return partition_indices_bin(
+      &data, pbvh->prim_indices, offset, offset + count - 1, best_axis, best_bin);
 }
 
 /* Returns the index of the first element on the right of the partition */
@@ -343,15 +559,6 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   BLI_ghash_free(map, NULL, NULL);
 }
 
-static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
-{
-  BB_reset(&node->vb);
-  for (int i = offset + count - 1; i >= offset; i--) {
-    BB_expand_with_bb(&node->vb, (BB *)(&prim_bbc[pbvh->prim_indices[i]]));
-  }
-  node->orig_vb = node->vb;
-}
-
 /* Returns the number of visible quads in the nodes' grids. */
 int BKE_pbvh_count_grid_quads(BLI_bitmap **grid_hidden,
                               const int *grid_indices,
@@ -413,16 +620,13 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
+static void build_leaf(PBVH *pbvh, int node_index, int offset, int count)
 {
   pbvh->nodes[node_index].flag |= PBVH_Leaf;
 
   pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
   pbvh->nodes[node_index].totprim = count;
 
-  /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
   if (pbvh->looptri) {
     build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
   }
@@ -465,73 +669,104 @@ static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
   return false;
 }
 
-/* Recursively build a node in the tree
- *
- * vb is the voxel box around all of the primitives contained in
- * this node.
- *
- * cb is the bounding box around all the centroids of the primitives
- * contained in this node
- *
- * offset and start indicate a range in the array of primitive indices
- */
+/* Temporary tree built in parallel, before it's stored in the PBVH nodes array. */
+typedef struct PBVHBuildNode {
+  struct PBVHBuildNode *children[2];
+
+  /* Bounds of the primitives in the node. */
+  BB vb;
+
+  /* Range in the array of primitive indices. */
+  int offset;
+  int count;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildData;
+
+static void build_node_task(TaskPool *__restrict pool, void *taskdata);
 
-static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int offset, int count)
+/* Recursively partition the primitives of a node, spawning tasks for subtrees that still
+ * have to be split along the way. Only the primitive indices in the node's range are
+ * modified, so subtrees can be built independently. */
+static void build_node(TaskPool *pool, PBVHBuildData *data, PBVHBuildNode *node)
 {
+  PBVH *pbvh = data->pbvh;
+  const int offset = node->offset;
+  const int count = node->count;
+  BB cb;
   int end;
-  BB cb_backing;
+
+  build_bounds(pbvh, data->prim_bbc, offset, count, &node->vb, &cb);
 
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = count <= pbvh->leaf_limit;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(pbvh, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
       return;
     }
   }
 
-  /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
-
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
   if (!below_leaf_limit) {
-    /* Find axis with widest range of primitive centroids */
-    if (!cb) {
-      cb = &cb_backing;
-      BB_reset(cb);
-      for (int i = offset + count - 1; i >= offset; i--) {
-        BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
-      }
-    }
-    const int axis = BB_widest_axis(cb);
-
-    /* Partition primitives along that axis */
-    end = partition_indices(pbvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+    end = partition_indices_sah(pbvh, data->prim_bbc, &cb, offset, count);
   }
   else {
     /* Partition primitives by material */
     end = partition_indices_material(pbvh, offset, offset + count - 1);
   }
 
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = MEM_callocN(sizeof(*child), __func__);
+    child->offset = (i == 0) ? offset : end;
+    child->count = (i == 0) ? end - offset : offset + count - end;
+    node->children[i] = child;
+  }
+
   /* Build children */
-  build_sub(pbvh, pbvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(pbvh,
-            pbvh->nodes[node_index].children_offset + 1,
-            NULL,
-            prim_bbc,
-            end,
-            offset + count - end);
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = node->children[i];
+    if (child->count > pbvh->leaf_limit) {
+      BLI_task_pool_push(pool, build_node_task, child, false, NULL);
+    }
+    else {
+      build_node(pool, data, child);
+    }
+  }
 }
 
-static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
+static void build_node_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PBVHBuildData *data = BLI_task_pool_user_data(pool);
+  build_node(pool, data, taskdata);
+}
+
+/* Store the temporary tree in the PBVH nodes, freeing it along the way. Depth first so
+ * leaves are built in the same order as a recursive build would. */
+static void build_store_nodes(PBVH *pbvh, PBVHBuildNode *tree_node, int node_index)
+{
+  PBVHNode *node = &pbvh->nodes[node_index];
+  node->vb = tree_node->vb;
+  node->orig_vb = tree_node->vb;
+
+  if (tree_node->children[0] == NULL) {
+    build_leaf(pbvh, node_index, tree_node->offset, tree_node->count);
+    return;
+  }
+
+  /* Add two child nodes */
+  const int children_offset = pbvh->totnode;
+  node->children_offset = children_offset;
+  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+
+  for (int i = 0; i < 2; i++) {
+    build_store_nodes(pbvh, tree_node->children[i], children_offset + i);
+    MEM_freeN(tree_node->children[i]);
+  }
+}
+
+static void pbvh_build(PBVH *pbvh, BBC *prim_bbc, int totprim)
 {
   if (totprim != pbvh->totprim) {
     pbvh->totprim = totprim;
@@ -552,8 +787,65 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     }
   }
 
+  PBVHBuildData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  PBVHBuildNode root = {
+      .offset = 0,
+      .count = totprim,
+  };
+
+  TaskPool *task_pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+  build_node(task_pool, &data, &root);
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+
   pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_store_nodes(pbvh, &root, 0);
+}
+
+typedef struct PBVHPrimBoundsData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHPrimBoundsData;
+
+static void pbvh_mesh_prim_bounds_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHPrimBoundsData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const MLoopTri *lt = &pbvh->looptri[i];
+  const int sides = 3;
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < sides; j++) {
+    BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+}
+
+static void pbvh_grids_prim_bounds_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHPrimBoundsData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const CCGKey *key = &pbvh->gridkey;
+  CCGElem *grid = pbvh->grids[i];
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
 }
 
 /**
@@ -575,7 +867,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          int looptri_num)
 {
   BBC *prim_bbc = NULL;
-  BB cb;
 
   pbvh->mesh = mesh;
   pbvh->type = PBVH_FACES;
@@ -593,29 +884,20 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
-
   /* For each face, store the AABB and the AABB centroid */
   prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  PBVHPrimBoundsData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, looptri_num, &data, pbvh_mesh_prim_bounds_cb, &settings);
 
   if (looptri_num) {
-    pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
+    pbvh_build(pbvh, prim_bbc, looptri_num);
   }
 
   MEM_freeN(prim_bbc);
@@ -642,29 +924,20 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   pbvh->grid_hidden = grid_hidden;
   pbvh->leaf_limit = max_ii(LEAF_LIMIT / (gridsize * gridsize), 1);
 
-  BB cb;
-  BB_reset(&cb);
-
   /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
 
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  PBVHPrimBoundsData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = max_ii(1024 / (gridsize * gridsize), 1);
+  BLI_task_parallel_range(0, totgrid, &data, pbvh_grids_prim_bounds_cb, &settings);
 
   if (totgrid) {
-    pbvh_build(pbvh, &cb, prim_bbc, totgrid);
+    pbvh_build(pbvh, prim_bbc, totgrid);
   }
 
   MEM_freeN(prim_bbc);
@@ -25,6 +25,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_DerivedMesh.h"
@@ -940,54 +941,127 @@ static void short_edge_queue_edge_add(EdgeQueueContext *eq_ctx, BMEdge *e)
   }
 }
 
-static void long_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
+/* Return true if the face faces the view (when enabled) and intersects the brush. */
+static bool edge_queue_face_test(const EdgeQueue *q, BMFace *f)
 {
 #ifdef USE_EDGEQUEUE_FRONTFACE
-  if (eq_ctx->q->use_view_normal) {
-    if (dot_v3v3(f->no, eq_ctx->q->view_normal) < 0.0f) {
-      return;
+  if (q->use_view_normal) {
+    if (dot_v3v3(f->no, q->view_normal) < 0.0f) {
+      return false;
     }
   }
 #endif
 
-  if (eq_ctx->q->edge_queue_tri_in_range(eq_ctx->q, f)) {
-    /* Check each edge of the face */
-    BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
-    BMLoop *l_iter = l_first;
-    do {
+  return q->edge_queue_tri_in_range(q, f);
+}
+
+/* Faces are expected to pass #edge_queue_face_test. */
+static void long_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
+{
+  /* Check each edge of the face */
+  BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
+  BMLoop *l_iter = l_first;
+  do {
 #ifdef USE_EDGEQUEUE_EVEN_SUBDIV
-      const float len_sq = BM_edge_calc_length_squared(l_iter->e);
-      if (len_sq > eq_ctx->q->limit_len_squared) {
-        long_edge_queue_edge_add_recursive(
-            eq_ctx, l_iter->radial_next, l_iter, len_sq, eq_ctx->q->limit_len);
-      }
+    const float len_sq = BM_edge_calc_length_squared(l_iter->e);
+    if (len_sq > eq_ctx->q->limit_len_squared) {
+      long_edge_queue_edge_add_recursive(
+          eq_ctx, l_iter->radial_next, l_iter, len_sq, eq_ctx->q->limit_len);
+    }
 #else
-      long_edge_queue_edge_add(eq_ctx, l_iter->e);
+    long_edge_queue_edge_add(eq_ctx, l_iter->e);
 #endif
-    } while ((l_iter = l_iter->next) != l_first);
-  }
+  } while ((l_iter = l_iter->next) != l_first);
 }
 
+/* Faces are expected to pass #edge_queue_face_test. */
 static void short_edge_queue_face_add(EdgeQueueContext *eq_ctx, BMFace *f)
 {
-#ifdef USE_EDGEQUEUE_FRONTFACE
-  if (eq_ctx->q->use_view_normal) {
-    if (dot_v3v3(f->no, eq_ctx->q->view_normal) < 0.0f) {
-      return;
+  BMLoop *l_iter;
+  BMLoop *l_first;
+
+  /* Check each edge of the face */
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    short_edge_queue_edge_add(eq_ctx, l_iter->e);
+  } while ((l_iter = l_iter->next) != l_first);
+}
+
+typedef struct EdgeQueueGatherData {
+  const EdgeQueue *q;
+  PBVHNode **nodes;
+  /* Faces of each node that pass #edge_queue_face_test, in #PBVHNode.bm_faces order. */
+  BMFace ***node_faces;
+  int *node_faces_len;
+} EdgeQueueGatherData;
+
+static void edge_queue_gather_faces_cb(void *__restrict userdata,
+                                       const int n,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgeQueueGatherData *data = userdata;
+  PBVHNode *node = data->nodes[n];
+  BMFace **faces = MEM_malloc_arrayN(BLI_gset_len(node->bm_faces), sizeof(*faces), __func__);
+  int faces_len = 0;
+
+  GSetIterator gs_iter;
+  GSET_ITER (gs_iter, node->bm_faces) {
+    BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
+    if (edge_queue_face_test(data->q, f)) {
+      faces[faces_len++] = f;
     }
   }
-#endif
 
-  if (eq_ctx->q->edge_queue_tri_in_range(eq_ctx->q, f)) {
-    BMLoop *l_iter;
-    BMLoop *l_first;
+  data->node_faces[n] = faces;
+  data->node_faces_len[n] = faces_len;
+}
 
-    /* Check each edge of the face */
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      short_edge_queue_edge_add(eq_ctx, l_iter->e);
-    } while ((l_iter = l_iter->next) != l_first);
+/* Fill the queue from the faces of leaf nodes marked for topology update.
+ *
+ * Testing faces against the brush only reads the mesh, so it runs on all nodes in parallel.
+ * Adding edges to the queue tags edges and may walk into neighboring nodes, so that part
+ * runs afterwards on a single thread, in the same order as a serial loop would. Edge lengths
+ * are measured there too, when each edge is added. */
+static void edge_queue_gather(EdgeQueueContext *eq_ctx,
+                              PBVH *pbvh,
+                              void (*face_add)(EdgeQueueContext *eq_ctx, BMFace *f))
+{
+  PBVHNode **nodes = MEM_malloc_arrayN(pbvh->totnode, sizeof(*nodes), __func__);
+  int totnode = 0;
+
+  for (int n = 0; n < pbvh->totnode; n++) {
+    PBVHNode *node = &pbvh->nodes[n];
+
+    /* Check leaf nodes marked for topology update */
+    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
+        !(node->flag & PBVH_FullyHidden)) {
+      nodes[totnode++] = node;
+    }
   }
+
+  EdgeQueueGatherData data = {
+      .q = eq_ctx->q,
+      .nodes = nodes,
+      .node_faces = MEM_malloc_arrayN(totnode, sizeof(*data.node_faces), __func__),
+      .node_faces_len = MEM_malloc_arrayN(totnode, sizeof(*data.node_faces_len), __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totnode > 1);
+  BLI_task_parallel_range(0, totnode, &data, edge_queue_gather_faces_cb, &settings);
+
+  for (int n = 0; n < totnode; n++) {
+    BMFace **faces = data.node_faces[n];
+    for (int i = 0; i < data.node_faces_len[n]; i++) {
+      face_add(eq_ctx, faces[i]);
+    }
+    MEM_freeN(faces);
+  }
+
+  MEM_freeN(data.node_faces);
+  MEM_freeN(data.node_faces_len);
+  MEM_freeN(nodes);
 }
 
 /* Create a priority queue containing vertex pairs connected by a long
@@ -1035,22 +1109,7 @@ static void long_edge_queue_create(EdgeQueueContext *eq_ctx,
   pbvh_bmesh_edge_tag_verify(pbvh);
 #endif
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        long_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_gather(eq_ctx, pbvh, long_edge_queue_face_add);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -1094,22 +1153,7 @@ static void short_edge_queue_create(EdgeQueueContext *eq_ctx,
     eq_ctx->q->edge_queue_tri_in_range = edge_queue_tri_in_sphere;
   }
 
-  for (int n = 0; n < pbvh->totnode; n++) {
-    PBVHNode *node = &pbvh->nodes[n];
-
-    /* Check leaf nodes marked for topology update */
-    if ((node->flag & PBVH_Leaf) && (node->flag & PBVH_UpdateTopology) &&
-        !(node->flag & PBVH_FullyHidden)) {
-      GSetIterator gs_iter;
-
-      /* Check each face */
-      GSET_ITER (gs_iter, node->bm_faces) {
-        BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-        short_edge_queue_face_add(eq_ctx, f);
-      }
-    }
-  }
+  edge_queue_gather(eq_ctx, pbvh, short_edge_queue_face_add);
 }
 
 /*************************** Topology update **************************/
@@ -1953,7 +1997,14 @@ void BKE_pbvh_build_bmesh(PBVH *pbvh,
   MEM_freeN(nodeinfo);
 }
 
-/* Collapse short edges, subdivide long edges */
+/**
+ * Collapse short edges, subdivide long edges.
+ *
+ * Only testing the faces of the nodes against the brush runs in parallel (see
+ * #edge_queue_gather). The edges are collapsed and subdivided on a single thread, in the order of
+ * one queue shared by all nodes: BMesh element allocation, the edge queue tags and #BMLog are not
+ * thread-safe, and an edit may change faces of neighboring nodes.
+ */
 bool BKE_pbvh_bmesh_update_topology(PBVH *pbvh,
                                     PBVHTopologyUpdateMode mode,
                                     const float center[3],
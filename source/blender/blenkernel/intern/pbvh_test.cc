@@ -0,0 +1,181 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_pbvh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+#include "BLI_span.hh"
+
+#include "pbvh_intern.h"
+
+#include <cfloat>
+
+namespace blender::bke::tests {
+
+/* A soup of small random triangles, the material of each triangle is `index % totmat`. */
+static void triangle_soup_create(const int totmat,
+                                 MutableSpan<MVert> verts,
+                                 MutableSpan<MLoop> loops,
+                                 MutableSpan<MPoly> polys)
+{
+  RandomNumberGenerator rng(polys.size());
+  for (const int i : polys.index_range()) {
+    const float center[3] = {rng.get_float(), rng.get_float(), rng.get_float() * 0.1f};
+    for (int j = 0; j < 3; j++) {
+      MVert &mv = verts[i * 3 + j];
+      memset(&mv, 0, sizeof(mv));
+      for (int axis = 0; axis < 3; axis++) {
+        mv.co[axis] = center[axis] + (rng.get_float() - 0.5f) * 0.01f;
+      }
+      loops[i * 3 + j].v = i * 3 + j;
+      loops[i * 3 + j].e = 0;
+    }
+    memset(&polys[i], 0, sizeof(MPoly));
+    polys[i].loopstart = i * 3;
+    polys[i].totloop = 3;
+    polys[i].mat_nr = (short)(i % totmat);
+  }
+}
+
+static PBVH *pbvh_build(Mesh *mesh,
+                        MutableSpan<MVert> verts,
+                        MutableSpan<MLoop> loops,
+                        MutableSpan<MPoly> polys)
+{
+  const int tottri = polys.size();
+  MLoopTri *looptri = (MLoopTri *)MEM_malloc_arrayN(tottri, sizeof(MLoopTri), __func__);
+  for (int i = 0; i < tottri; i++) {
+    looptri[i].tri[0] = i * 3;
+    looptri[i].tri[1] = i * 3 + 1;
+    looptri[i].tri[2] = i * 3 + 2;
+    looptri[i].poly = i;
+  }
+  PBVH *pbvh = BKE_pbvh_new();
+  BKE_pbvh_build_mesh(pbvh,
+                      mesh,
+                      polys.data(),
+                      loops.data(),
+                      verts.data(),
+                      verts.size(),
+                      &mesh->vdata,
+                      &mesh->ldata,
+                      &mesh->pdata,
+                      looptri,
+                      tottri);
+  return pbvh;
+}
+
+static bool bb_contains(const BB &outer, const BB &inner)
+{
+  for (int axis = 0; axis < 3; axis++) {
+    if (inner.bmin[axis] < outer.bmin[axis] || inner.bmax[axis] > outer.bmax[axis]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Check that every primitive is in exactly one leaf, that leaves respect the leaf limit and
+ * only have one material, and that node bounds contain their contents. */
+static void expect_pbvh_valid(const PBVH *pbvh, Span<MVert> verts, Span<MPoly> polys)
+{
+  Array<int> prim_leaf_count(polys.size(), 0);
+  for (int n = 0; n < pbvh->totnode; n++) {
+    const PBVHNode *node = &pbvh->nodes[n];
+    if (!(node->flag & PBVH_Leaf)) {
+      for (int i = 0; i < 2; i++) {
+        const PBVHNode *child = &pbvh->nodes[node->children_offset + i];
+        EXPECT_TRUE(bb_contains(node->vb, child->vb));
+      }
+      continue;
+    }
+
+    EXPECT_GT(node->totprim, 0);
+    EXPECT_LE(node->totprim, pbvh->leaf_limit);
+    const short mat_nr = polys[node->prim_indices[0]].mat_nr;
+    for (int i = 0; i < node->totprim; i++) {
+      const int prim = node->prim_indices[i];
+      prim_leaf_count[prim]++;
+      EXPECT_EQ(polys[prim].mat_nr, mat_nr);
+
+      BB prim_bb;
+      for (int axis = 0; axis < 3; axis++) {
+        prim_bb.bmin[axis] = FLT_MAX;
+        prim_bb.bmax[axis] = -FLT_MAX;
+        for (int j = 0; j < 3; j++) {
+          const float co = verts[prim * 3 + j].co[axis];
+          prim_bb.bmin[axis] = std::min(prim_bb.bmin[axis], co);
+          prim_bb.bmax[axis] = std::max(prim_bb.bmax[axis], co);
+        }
+      }
+      EXPECT_TRUE(bb_contains(node->vb, prim_bb));
+    }
+  }
+
+  for (const int count : prim_leaf_count) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+TEST(pbvh, BuildSingleLeaf)
+{
+  Mesh mesh = {{nullptr}};
+  Array<MVert> verts(300);
+  Array<MLoop> loops(300);
+  Array<MPoly> polys(100);
+  triangle_soup_create(1, verts, loops, polys);
+
+  PBVH *pbvh = pbvh_build(&mesh, verts, loops, polys);
+  EXPECT_EQ(pbvh->totnode, 1);
+  expect_pbvh_valid(pbvh, verts, polys);
+  BKE_pbvh_free(pbvh);
+}
+
+TEST(pbvh, Build)
+{
+  /* Enough triangles for nodes to be split with the surface area heuristic. */
+  Mesh mesh = {{nullptr}};
+  Array<MVert> verts(600000);
+  Array<MLoop> loops(600000);
+  Array<MPoly> polys(200000);
+  triangle_soup_create(1, verts, loops, polys);
+
+  PBVH *pbvh = pbvh_build(&mesh, verts, loops, polys);
+  expect_pbvh_valid(pbvh, verts, polys);
+  BKE_pbvh_free(pbvh);
+}
+
+TEST(pbvh, BuildMaterialSplit)
+{
+  Mesh mesh = {{nullptr}};
+  Array<MVert> verts(150000);
+  Array<MLoop> loops(150000);
+  Array<MPoly> polys(50000);
+  triangle_soup_create(3, verts, loops, polys);
+
+  PBVH *pbvh = pbvh_build(&mesh, verts, loops, polys);
+  expect_pbvh_valid(pbvh, verts, polys);
+  BKE_pbvh_free(pbvh);
+}
+
+}  // namespace blender::bke::tests
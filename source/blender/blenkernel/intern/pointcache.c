@@ -21,6 +21,7 @@
  * \ingroup bke
  */
 
+#include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,8 +46,12 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_mmap.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -95,8 +100,10 @@
 /* needed for directory lookup */
 #ifndef WIN32
 #  include <dirent.h>
+#  include <unistd.h> /* for close */
 #else
 #  include "BLI_winstuff.h"
+#  include <io.h> /* for close */
 #endif
 
 #define PTCACHE_DATA_FROM(data, type, from) \
@@ -148,11 +155,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
   int error = 0;
 
   /* Custom functions should read these basic elements too! */
-  if (!error && !fread(&pf->totpoint, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->totpoint, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
-  if (!error && !fread(&pf->data_types, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->data_types, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -161,11 +168,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
 static int ptcache_basic_header_write(PTCacheFile *pf)
 {
   /* Custom functions should write these basic elements too! */
-  if (!fwrite(&pf->totpoint, sizeof(unsigned int), 1, pf->fp)) {
+  if (!ptcache_file_write(pf, &pf->totpoint, 1, sizeof(unsigned int))) {
     return 0;
   }
 
-  if (!fwrite(&pf->data_types, sizeof(unsigned int), 1, pf->fp)) {
+  if (!ptcache_file_write(pf, &pf->data_types, 1, sizeof(unsigned int))) {
     return 0;
   }
 
@@ -1288,6 +1295,10 @@ bool BKE_ptcache_object_has(struct Scene *scene, struct Object *ob, int duplis)
 
 static const char *ptcache_file_extension(const PTCacheID *pid)
 {
+  if (pid->cache->flag & PTCACHE_DISK_ARCHIVE) {
+    return PTCACHE_ARCHIVE_EXT;
+  }
+
   switch (pid->file_type) {
     default:
     case PTCACHE_FILE_PTCACHE:
@@ -1459,6 +1470,751 @@ static int ptcache_filename(PTCacheID *pid, char *filename, int cfra, short do_p
   return len; /* make sure the above string is always 16 chars */
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Single File Archives
+ *
+ * Disk caches using #PTCACHE_DISK_ARCHIVE store all frames in one file. Every write appends a
+ * record with the contents a per frame file would have, and removing a frame appends an empty
+ * record. The index of the latest record of each frame is rebuilt when the archive is opened.
+ * The file is rewritten without the replaced and removed records when clearing frames, or when
+ * they take more space than the frames in use.
+ *
+ * Records are compressed and written in order by a background task, frames waiting for it are
+ * read from memory. Other frames are parsed directly from a memory mapping of the archive.
+ * \{ */
+
+#define PTCACHE_ARCHIVE_VERSION 1
+
+typedef struct PTCacheArchiveFileHeader {
+  char id[8];
+  unsigned int version;
+  unsigned int _pad;
+} PTCacheArchiveFileHeader;
+
+typedef struct PTCacheArchiveRecordHeader {
+  int frame;
+  unsigned int flag;
+  /** Size of the record data in the archive and after decompression. */
+  unsigned int len, raw_len;
+} PTCacheArchiveRecordHeader;
+
+/* PTCacheArchiveRecordHeader.flag */
+#define PTCACHE_ARCHIVE_COMPRESSED (1 << 0)
+#define PTCACHE_ARCHIVE_REMOVED (1 << 1)
+
+/* Unused records are removed when writing frames once they take this many bytes, and more than
+ * the frames in use. */
+#define PTCACHE_ARCHIVE_COMPACT_MIN_SIZE (16 * 1024 * 1024)
+
+typedef struct PTCacheArchiveFrame {
+  int frame;
+  unsigned int flag;
+  unsigned int len, raw_len;
+  /** Offset of the record data in the archive. */
+  size_t offset;
+  /** Uncompressed record data until the record is written. */
+  unsigned char *pending;
+  /** Replaced or removed while pending, freed once written. */
+  bool discarded;
+} PTCacheArchiveFrame;
+
+typedef struct PTCacheArchive {
+  char filepath[MAX_PTCACHE_FILE];
+  /** Owners of the archive, including #ptcache_archives while it's in there.
+   * Protected by #ptcache_archives_mutex. */
+  int users;
+  /** Removed from #ptcache_archives, no frames are added or removed anymore. */
+  bool is_closed;
+  /** The file is deleted, pending frames are not written anymore. */
+  bool is_deleted;
+  ThreadMutex mutex;
+  /** Frame number to #PTCacheArchiveFrame. */
+  GHash *frames;
+  /** Opened for appending on the first write. */
+  FILE *fp;
+  /** End of the last complete record. */
+  size_t file_len;
+  /** Size of the written records of frames in use, the rest of the file can be compacted. */
+  size_t live_len;
+  BLI_mmap_file *mmap_file;
+  size_t mmap_len;
+  TaskPool *task_pool;
+  bool use_compression;
+} PTCacheArchive;
+
+/** Archive file path to #PTCacheArchive. */
+static GHash *ptcache_archives = NULL;
+static ThreadMutex ptcache_archives_mutex = BLI_MUTEX_INITIALIZER;
+
+static int ptcache_archive_filename(PTCacheID *pid, char *filename)
+{
+  const int len = ptcache_filename(pid, filename, 0, 1, 0);
+  if (len == 0) {
+    return 0;
+  }
+  return (int)ptcache_filename_ext_append(pid, filename, (size_t)len, false, 0);
+}
+
+static size_t ptcache_archive_record_size(const PTCacheArchiveFrame *af)
+{
+  return sizeof(PTCacheArchiveRecordHeader) + af->len;
+}
+
+static size_t ptcache_archive_unused_size(const PTCacheArchive *archive)
+{
+  if (archive->file_len == 0) {
+    return 0;
+  }
+  return archive->file_len - sizeof(PTCacheArchiveFileHeader) - archive->live_len;
+}
+
+/* Must be called with the archive locked. */
+static void ptcache_archive_frame_discard(PTCacheArchive *archive, PTCacheArchiveFrame *af)
+{
+  /* Pending frames are freed by the write task. */
+  if (af->pending) {
+    af->discarded = true;
+  }
+  else {
+    archive->live_len -= ptcache_archive_record_size(af);
+    MEM_freeN(af);
+  }
+}
+
+static void ptcache_archive_frame_free(void *af_v)
+{
+  PTCacheArchiveFrame *af = af_v;
+  MEM_SAFE_FREE(af->pending);
+  MEM_freeN(af);
+}
+
+static void ptcache_archive_mmap_free(PTCacheArchive *archive)
+{
+  if (archive->mmap_file) {
+    BLI_mmap_free(archive->mmap_file);
+    archive->mmap_file = NULL;
+    archive->mmap_len = 0;
+  }
+}
+
+/* Map the archive up to the end of the last complete record. */
+static bool ptcache_archive_mmap_ensure(PTCacheArchive *archive, const size_t len)
+{
+  if (archive->mmap_file && archive->mmap_len >= len) {
+    return true;
+  }
+
+  ptcache_archive_mmap_free(archive);
+
+  if (archive->fp) {
+    fflush(archive->fp);
+  }
+
+  const int file = BLI_open(archive->filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return false;
+  }
+  archive->mmap_file = BLI_mmap_open(file);
+  close(file);
+
+  if (archive->mmap_file == NULL) {
+    return false;
+  }
+  archive->mmap_len = archive->file_len;
+  return archive->mmap_len >= len;
+}
+
+/* Build the frame index from the records of an existing archive. */
+static void ptcache_archive_index_read(PTCacheArchive *archive)
+{
+  const size_t file_size = BLI_file_size(archive->filepath);
+  PTCacheArchiveFileHeader file_header;
+
+  archive->file_len = file_size;
+  if (file_size <= sizeof(file_header) || !ptcache_archive_mmap_ensure(archive, file_size)) {
+    archive->file_len = 0;
+    return;
+  }
+
+  if (!BLI_mmap_read(archive->mmap_file, &file_header, 0, sizeof(file_header)) ||
+      !STREQLEN(file_header.id, "BPHYSARC", 8) ||
+      file_header.version != PTCACHE_ARCHIVE_VERSION) {
+    CLOG_WARN(&LOG, "Invalid point cache archive '%s'", archive->filepath);
+    ptcache_archive_mmap_free(archive);
+    archive->file_len = 0;
+    return;
+  }
+
+  size_t offset = sizeof(file_header);
+  PTCacheArchiveRecordHeader header;
+  while (offset + sizeof(header) <= file_size &&
+         BLI_mmap_read(archive->mmap_file, &header, offset, sizeof(header)) &&
+         header.len <= file_size - offset - sizeof(header)) {
+    offset += sizeof(header);
+
+    PTCacheArchiveFrame *af_prev = BLI_ghash_popkey(
+        archive->frames, POINTER_FROM_INT(header.frame), NULL);
+    if (af_prev) {
+      ptcache_archive_frame_discard(archive, af_prev);
+    }
+
+    if ((header.flag & PTCACHE_ARCHIVE_REMOVED) == 0) {
+      PTCacheArchiveFrame *af = MEM_callocN(sizeof(PTCacheArchiveFrame), __func__);
+      af->frame = header.frame;
+      af->flag = header.flag;
+      af->len = header.len;
+      af->raw_len = header.raw_len;
+      af->offset = offset;
+      BLI_ghash_insert(archive->frames, POINTER_FROM_INT(af->frame), af);
+      archive->live_len += ptcache_archive_record_size(af);
+    }
+    offset += header.len;
+  }
+
+  /* Records after an incomplete one are overwritten by the next write. */
+  archive->file_len = offset;
+  archive->mmap_len = MIN2(archive->mmap_len, offset);
+}
+
+static bool ptcache_archive_file_ensure(PTCacheArchive *archive)
+{
+  if (archive->fp) {
+    return true;
+  }
+
+  BLI_make_existing_file(archive->filepath);
+
+  if (archive->file_len == 0) {
+    PTCacheArchiveFileHeader file_header = {{0}};
+    memcpy(file_header.id, "BPHYSARC", 8);
+    file_header.version = PTCACHE_ARCHIVE_VERSION;
+
+    archive->fp = BLI_fopen(archive->filepath, "wb");
+    if (archive->fp == NULL) {
+      return false;
+    }
+    if (fwrite(&file_header, sizeof(file_header), 1, archive->fp) != 1) {
+      fclose(archive->fp);
+      archive->fp = NULL;
+      return false;
+    }
+    archive->file_len = sizeof(file_header);
+    return true;
+  }
+
+  archive->fp = BLI_fopen(archive->filepath, "rb+");
+  if (archive->fp == NULL) {
+    return false;
+  }
+  if (BLI_fseek(archive->fp, (int64_t)archive->file_len, SEEK_SET) != 0) {
+    fclose(archive->fp);
+    archive->fp = NULL;
+    return false;
+  }
+  return true;
+}
+
+static void ptcache_archive_write_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PTCacheArchive *archive = BLI_task_pool_user_data(pool);
+  PTCacheArchiveFrame *af = taskdata;
+  PTCacheArchiveRecordHeader header = {af->frame, af->flag, af->raw_len, af->raw_len};
+  const unsigned char *data = af->pending;
+  unsigned char *out = NULL;
+
+  /* Compress outside of the lock, the pending data is only freed by this task. */
+  if (header.flag & PTCACHE_ARCHIVE_COMPRESSED) {
+    header.flag &= ~PTCACHE_ARCHIVE_COMPRESSED;
+#ifdef WITH_LZO
+    LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
+    lzo_uint out_len = LZO_OUT_LEN(af->raw_len);
+
+    out = MEM_mallocN(out_len, "pointcache_archive_lzo_buffer");
+    if (lzo1x_1_compress(af->pending, af->raw_len, out, &out_len, wrkmem) == LZO_E_OK &&
+        out_len < af->raw_len) {
+      header.flag |= PTCACHE_ARCHIVE_COMPRESSED;
+      header.len = (unsigned int)out_len;
+      data = out;
+    }
+#endif
+  }
+
+  BLI_mutex_lock(&archive->mutex);
+
+  /* Frames that were replaced or removed meanwhile don't need to be written. */
+  const bool skip = archive->is_deleted ||
+                    (af->discarded && (af->flag & PTCACHE_ARCHIVE_REMOVED) == 0);
+  bool ok = !skip && ptcache_archive_file_ensure(archive) &&
+            fwrite(&header, sizeof(header), 1, archive->fp) == 1 &&
+            (header.len == 0 || fwrite(data, header.len, 1, archive->fp) == 1);
+
+  if (ok) {
+    archive->file_len += sizeof(header);
+    af->offset = archive->file_len;
+    af->flag = header.flag;
+    af->len = header.len;
+    archive->file_len += header.len;
+    if (!af->discarded) {
+      archive->live_len += ptcache_archive_record_size(af);
+    }
+  }
+  else if (skip) {
+    /* Discarded frames are freed below, the others along with the deleted archive. */
+  }
+  else {
+    /* Continue after the last complete record, keeping the frame in memory. */
+    CLOG_ERROR(&LOG, "Failed to write point cache archive '%s'", archive->filepath);
+    if (archive->fp) {
+      fclose(archive->fp);
+      archive->fp = NULL;
+    }
+  }
+
+  if (ok || af->discarded) {
+    MEM_SAFE_FREE(af->pending);
+    if (af->discarded) {
+      MEM_freeN(af);
+    }
+  }
+
+  BLI_mutex_unlock(&archive->mutex);
+
+  if (out) {
+    MEM_freeN(out);
+  }
+}
+
+/* Get the archive of the cache, to be released with #ptcache_archive_release. */
+static PTCacheArchive *ptcache_archive_get(PTCacheID *pid, const bool create)
+{
+  char filepath[MAX_PTCACHE_FILE];
+
+  if (ptcache_archive_filename(pid, filepath) == 0) {
+    return NULL;
+  }
+
+  BLI_mutex_lock(&ptcache_archives_mutex);
+
+  if (ptcache_archives == NULL) {
+    ptcache_archives = BLI_ghash_str_new(__func__);
+  }
+
+  PTCacheArchive *archive = BLI_ghash_lookup(ptcache_archives, filepath);
+  if (archive == NULL && (create || BLI_exists(filepath))) {
+    archive = MEM_callocN(sizeof(PTCacheArchive), __func__);
+    BLI_strncpy(archive->filepath, filepath, sizeof(archive->filepath));
+    archive->users = 1;
+    BLI_mutex_init(&archive->mutex);
+    archive->frames = BLI_ghash_int_new(__func__);
+    archive->task_pool = BLI_task_pool_create_background_serial(archive, TASK_PRIORITY_LOW);
+    ptcache_archive_index_read(archive);
+    BLI_ghash_insert(ptcache_archives, archive->filepath, archive);
+  }
+  if (archive) {
+    archive->users++;
+  }
+
+  BLI_mutex_unlock(&ptcache_archives_mutex);
+
+  if (archive) {
+    archive->use_compression = (pid->cache->compression != PTCACHE_COMPRESS_NO);
+  }
+
+  return archive;
+}
+
+static void ptcache_archive_free(PTCacheArchive *archive)
+{
+  /* Frames that are still pending failed to be written. */
+  BLI_task_pool_work_and_wait(archive->task_pool);
+  BLI_task_pool_free(archive->task_pool);
+
+  if (archive->fp) {
+    fclose(archive->fp);
+  }
+  ptcache_archive_mmap_free(archive);
+
+  BLI_ghash_free(archive->frames, NULL, ptcache_archive_frame_free);
+  BLI_mutex_end(&archive->mutex);
+  MEM_freeN(archive);
+}
+
+static void ptcache_archive_release(PTCacheArchive *archive)
+{
+  BLI_mutex_lock(&ptcache_archives_mutex);
+  BLI_assert(archive->users > 0);
+  const bool is_last_user = (--archive->users == 0);
+  BLI_mutex_unlock(&ptcache_archives_mutex);
+
+  if (is_last_user) {
+    ptcache_archive_free(archive);
+  }
+}
+
+/* Stop changing the frames of an archive removed from #ptcache_archives. */
+static void ptcache_archive_mark_closed(PTCacheArchive *archive, const bool is_deleted)
+{
+  BLI_mutex_lock(&archive->mutex);
+  archive->is_closed = true;
+  archive->is_deleted = is_deleted;
+  if (is_deleted && archive->fp) {
+    fclose(archive->fp);
+    archive->fp = NULL;
+  }
+  BLI_mutex_unlock(&archive->mutex);
+}
+
+/* Close the archive of the cache, optionally deleting its file. Other threads using the archive
+ * keep it until they release it, but it isn't written to anymore. */
+static void ptcache_archive_close(PTCacheID *pid, const bool delete_file)
+{
+  char filepath[MAX_PTCACHE_FILE];
+
+  if (ptcache_archive_filename(pid, filepath) == 0) {
+    return;
+  }
+
+  BLI_mutex_lock(&ptcache_archives_mutex);
+  PTCacheArchive *archive = ptcache_archives ?
+                                BLI_ghash_popkey(ptcache_archives, filepath, NULL) :
+                                NULL;
+  BLI_mutex_unlock(&ptcache_archives_mutex);
+
+  if (archive) {
+    ptcache_archive_mark_closed(archive, delete_file);
+    if (!delete_file) {
+      /* Write the pending frames before the file is opened again. No frames can be added
+       * anymore, background pools can't be used after waiting for them without threading. */
+      BLI_task_pool_work_and_wait(archive->task_pool);
+    }
+    ptcache_archive_release(archive);
+  }
+
+  if (delete_file && BLI_exists(filepath)) {
+    BLI_delete(filepath, false, false);
+  }
+}
+
+/* Rewrite the archive with only the records of the frames in use. Pending frames are written
+ * after the compacted records.
+ *
+ * \return false when the unused records are still in the file. */
+static bool ptcache_archive_compact(PTCacheArchive *archive)
+{
+  BLI_mutex_lock(&archive->mutex);
+
+  if (archive->is_closed) {
+    BLI_mutex_unlock(&archive->mutex);
+    return false;
+  }
+  if (ptcache_archive_unused_size(archive) == 0) {
+    BLI_mutex_unlock(&archive->mutex);
+    return true;
+  }
+  if (!ptcache_archive_mmap_ensure(archive, archive->file_len)) {
+    BLI_mutex_unlock(&archive->mutex);
+    return false;
+  }
+
+  char filepath_tmp[MAX_PTCACHE_FILE + 4];
+  BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s.tmp", archive->filepath);
+
+  const unsigned char *data = BLI_mmap_get_pointer(archive->mmap_file);
+  const int frames_len = (int)BLI_ghash_len(archive->frames);
+  PTCacheArchiveFrame **frames = MEM_malloc_arrayN(frames_len, sizeof(*frames), __func__);
+  size_t *offsets = MEM_malloc_arrayN(frames_len, sizeof(*offsets), __func__);
+  size_t file_len = 0;
+  int i = 0;
+
+  FILE *fp = BLI_fopen(filepath_tmp, "wb");
+  bool ok = (fp != NULL) && fwrite(data, sizeof(PTCacheArchiveFileHeader), 1, fp) == 1;
+  file_len = sizeof(PTCacheArchiveFileHeader);
+
+  GHASH_FOREACH_BEGIN (PTCacheArchiveFrame *, af, archive->frames) {
+    if (!ok || af->pending) {
+      continue;
+    }
+    PTCacheArchiveRecordHeader header = {af->frame, af->flag, af->len, af->raw_len};
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         (af->len == 0 || fwrite(data + af->offset, af->len, 1, fp) == 1);
+    file_len += sizeof(header);
+    frames[i] = af;
+    offsets[i] = file_len;
+    file_len += af->len;
+    i++;
+  }
+  GHASH_FOREACH_END();
+
+  if (fp && fclose(fp) != 0) {
+    ok = false;
+  }
+
+  if (ok) {
+    if (archive->fp) {
+      fclose(archive->fp);
+      archive->fp = NULL;
+    }
+    ptcache_archive_mmap_free(archive);
+    ok = (BLI_rename(filepath_tmp, archive->filepath) == 0);
+  }
+
+  if (ok) {
+    for (int j = 0; j < i; j++) {
+      frames[j]->offset = offsets[j];
+    }
+    archive->file_len = file_len;
+    archive->live_len = file_len - sizeof(PTCacheArchiveFileHeader);
+  }
+  else {
+    CLOG_ERROR(&LOG, "Failed to compact point cache archive '%s'", archive->filepath);
+    BLI_delete(filepath_tmp, false, false);
+  }
+
+  MEM_freeN(frames);
+  MEM_freeN(offsets);
+  BLI_mutex_unlock(&archive->mutex);
+
+  return ok;
+}
+
+/* Takes ownership of the uncompressed record data. */
+static void ptcache_archive_frame_add(PTCacheArchive *archive,
+                                      int frame,
+                                      unsigned char *data,
+                                      unsigned int len)
+{
+  PTCacheArchiveFrame *af = MEM_callocN(sizeof(PTCacheArchiveFrame), __func__);
+  af->frame = frame;
+  af->flag = archive->use_compression ? PTCACHE_ARCHIVE_COMPRESSED : 0;
+  af->raw_len = len;
+  af->pending = data;
+
+  BLI_mutex_lock(&archive->mutex);
+  if (archive->is_closed) {
+    BLI_mutex_unlock(&archive->mutex);
+    MEM_freeN(af->pending);
+    MEM_freeN(af);
+    return;
+  }
+  PTCacheArchiveFrame *af_prev = BLI_ghash_popkey(archive->frames, POINTER_FROM_INT(frame), NULL);
+  if (af_prev) {
+    ptcache_archive_frame_discard(archive, af_prev);
+  }
+  BLI_ghash_insert(archive->frames, POINTER_FROM_INT(frame), af);
+  const size_t unused_size = ptcache_archive_unused_size(archive);
+  const bool do_compact = unused_size >= PTCACHE_ARCHIVE_COMPACT_MIN_SIZE &&
+                          unused_size > archive->live_len;
+  /* Push while locked, closing waits for the frames added before. */
+  BLI_task_pool_push(archive->task_pool, ptcache_archive_write_task, af, false, NULL);
+  BLI_mutex_unlock(&archive->mutex);
+
+  /* Rewritten frames leave their previous records unused. */
+  if (do_compact) {
+    ptcache_archive_compact(archive);
+  }
+}
+
+/* Must be called with the archive locked. */
+static void ptcache_archive_frame_removal_add_locked(PTCacheArchive *archive, int frame)
+{
+  /* Record the removal, freed once written. */
+  PTCacheArchiveFrame *af_removed = MEM_callocN(sizeof(PTCacheArchiveFrame), __func__);
+  af_removed->frame = frame;
+  af_removed->flag = PTCACHE_ARCHIVE_REMOVED;
+  af_removed->discarded = true;
+  BLI_task_pool_push(archive->task_pool, ptcache_archive_write_task, af_removed, false, NULL);
+}
+
+static bool ptcache_archive_frame_exists(PTCacheID *pid, int frame)
+{
+  PTCacheArchive *archive = ptcache_archive_get(pid, false);
+  if (archive == NULL) {
+    return false;
+  }
+
+  BLI_mutex_lock(&archive->mutex);
+  const bool exists = BLI_ghash_haskey(archive->frames, POINTER_FROM_INT(frame));
+  BLI_mutex_unlock(&archive->mutex);
+
+  ptcache_archive_release(archive);
+  return exists;
+}
+
+static void ptcache_archive_clear(PTCacheID *pid, int mode, int cfra)
+{
+  PointCache *cache = pid->cache;
+  const int sta = cache->startframe, end = cache->endframe;
+
+  if (mode == PTCACHE_CLEAR_ALL) {
+    ptcache_archive_close(pid, true);
+    cache->last_exact = MIN2(cache->startframe, 0);
+    if (cache->cached_frames) {
+      memset(cache->cached_frames, 0, MEM_allocN_len(cache->cached_frames));
+    }
+    return;
+  }
+
+  PTCacheArchive *archive = ptcache_archive_get(pid, false);
+  if (archive == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&archive->mutex);
+
+  if (archive->is_closed) {
+    BLI_mutex_unlock(&archive->mutex);
+    ptcache_archive_release(archive);
+    return;
+  }
+
+  int *frames = MEM_malloc_arrayN(
+      BLI_ghash_len(archive->frames) + 1, sizeof(int), "ptcache archive frames");
+  int frames_len = 0;
+
+  GHASH_FOREACH_BEGIN (PTCacheArchiveFrame *, af, archive->frames) {
+    if ((mode == PTCACHE_CLEAR_FRAME && af->frame == cfra) ||
+        (mode == PTCACHE_CLEAR_BEFORE && af->frame < cfra) ||
+        (mode == PTCACHE_CLEAR_AFTER && af->frame > cfra)) {
+      frames[frames_len++] = af->frame;
+    }
+  }
+  GHASH_FOREACH_END();
+
+  for (int i = 0; i < frames_len; i++) {
+    PTCacheArchiveFrame *af = BLI_ghash_popkey(archive->frames, POINTER_FROM_INT(frames[i]), NULL);
+    ptcache_archive_frame_discard(archive, af);
+    if (mode != PTCACHE_CLEAR_FRAME && cache->cached_frames && frames[i] >= sta &&
+        frames[i] <= end) {
+      cache->cached_frames[frames[i] - sta] = 0;
+    }
+  }
+
+  /* Compacting removes the records of the cleared frames from the file, otherwise the removal
+   * is recorded. Single frames are only compacted once unused records take most of the file. */
+  const size_t unused_size = ptcache_archive_unused_size(archive);
+  bool do_compact = (mode != PTCACHE_CLEAR_FRAME) ? unused_size > 0 :
+                                                    unused_size > archive->live_len;
+  if (!do_compact) {
+    for (int i = 0; i < frames_len; i++) {
+      ptcache_archive_frame_removal_add_locked(archive, frames[i]);
+    }
+  }
+  BLI_mutex_unlock(&archive->mutex);
+
+  if (do_compact && !ptcache_archive_compact(archive)) {
+    BLI_mutex_lock(&archive->mutex);
+    for (int i = 0; i < frames_len; i++) {
+      ptcache_archive_frame_removal_add_locked(archive, frames[i]);
+    }
+    BLI_mutex_unlock(&archive->mutex);
+  }
+
+  MEM_freeN(frames);
+  ptcache_archive_release(archive);
+}
+
+/* Set the cached frames of the archive, and return the first and last frame. */
+static void ptcache_archive_frames_range(
+    PTCacheID *pid, char *cached_frames, int *r_start, int *r_end, bool *r_has_info)
+{
+  PointCache *cache = pid->cache;
+  PTCacheArchive *archive = ptcache_archive_get(pid, false);
+
+  if (archive == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&archive->mutex);
+  GHASH_FOREACH_BEGIN (PTCacheArchiveFrame *, af, archive->frames) {
+    if (cached_frames && af->frame >= cache->startframe && af->frame <= cache->endframe) {
+      cached_frames[af->frame - cache->startframe] = 1;
+    }
+    if (af->frame == 0) {
+      if (r_has_info) {
+        *r_has_info = true;
+      }
+    }
+    else if (r_start && r_end) {
+      *r_start = MIN2(*r_start, af->frame);
+      *r_end = MAX2(*r_end, af->frame);
+    }
+  }
+  GHASH_FOREACH_END();
+  BLI_mutex_unlock(&archive->mutex);
+
+  ptcache_archive_release(archive);
+}
+
+/* Open a frame for parsing, keeping the archive locked until the file is closed. */
+static bool ptcache_archive_file_open_read(PTCacheArchive *archive, PTCacheFile *pf, int frame)
+{
+  BLI_mutex_lock(&archive->mutex);
+
+  PTCacheArchiveFrame *af = BLI_ghash_lookup(archive->frames, POINTER_FROM_INT(frame));
+  if (af == NULL) {
+    BLI_mutex_unlock(&archive->mutex);
+    return false;
+  }
+
+  pf->archive = archive;
+  pf->mode = PTCACHE_FILE_READ;
+  pf->mem_pos = 0;
+  pf->mem_alloc = 0;
+  pf->mem_len = af->raw_len;
+
+  if (af->pending) {
+    pf->mem = af->pending;
+    return true;
+  }
+
+  if (ptcache_archive_mmap_ensure(archive, af->offset + af->len)) {
+    unsigned char *data = (unsigned char *)BLI_mmap_get_pointer(archive->mmap_file) +
+                          af->offset;
+    if ((af->flag & PTCACHE_ARCHIVE_COMPRESSED) == 0) {
+      pf->mem = data;
+      return true;
+    }
+#ifdef WITH_LZO
+    lzo_uint out_len = af->raw_len;
+    pf->mem = MEM_mallocN(af->raw_len, "pointcache_archive_frame");
+    pf->mem_alloc = af->raw_len;
+    if (lzo1x_decompress_safe(data, af->len, pf->mem, &out_len, NULL) == LZO_E_OK &&
+        out_len == af->raw_len) {
+      return true;
+    }
+    MEM_freeN(pf->mem);
+#endif
+  }
+
+  pf->archive = NULL;
+  pf->mem = NULL;
+  BLI_mutex_unlock(&archive->mutex);
+  return false;
+}
+
+void BKE_ptcache_exit(void)
+{
+  if (ptcache_archives == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&ptcache_archives_mutex);
+  GHash *archives = ptcache_archives;
+  ptcache_archives = NULL;
+  BLI_mutex_unlock(&ptcache_archives_mutex);
+
+  GHASH_FOREACH_BEGIN (PTCacheArchive *, archive, archives) {
+    ptcache_archive_mark_closed(archive, false);
+    BLI_task_pool_work_and_wait(archive->task_pool);
+    ptcache_archive_release(archive);
+  }
+  GHASH_FOREACH_END();
+
+  BLI_ghash_free(archives, NULL, NULL);
+}
+
+/** \} */
+
 /**
  * Caller must close after!
  */
@@ -1478,6 +2234,34 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
     return NULL; /* save blend file before using disk pointcache */
   }
 
+  if (pid->cache->flag & PTCACHE_DISK_ARCHIVE) {
+    PTCacheArchive *archive = ptcache_archive_get(pid, mode == PTCACHE_FILE_WRITE);
+    if (archive == NULL) {
+      return NULL;
+    }
+    if (mode == PTCACHE_FILE_UPDATE) {
+      ptcache_archive_release(archive);
+      return NULL;
+    }
+
+    pf = MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
+    pf->frame = cfra;
+
+    if (mode == PTCACHE_FILE_WRITE) {
+      pf->archive = archive;
+      pf->mode = PTCACHE_FILE_WRITE;
+      pf->mem_alloc = 4096;
+      pf->mem = MEM_mallocN(pf->mem_alloc, "pointcache_archive_frame");
+    }
+    else if (!ptcache_archive_file_open_read(archive, pf, cfra)) {
+      ptcache_archive_release(archive);
+      MEM_freeN(pf);
+      return NULL;
+    }
+
+    return pf;
+  }
+
   ptcache_filename(pid, filename, cfra, 1, 1);
 
   if (mode == PTCACHE_FILE_READ) {
@@ -1498,7 +2282,7 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
     return NULL;
   }
 
-  pf = MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
+  pf = MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
   pf->fp = fp;
   pf->old_format = 0;
   pf->frame = cfra;
@@ -1507,10 +2291,26 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 }
 static void ptcache_file_close(PTCacheFile *pf)
 {
-  if (pf) {
+  if (pf == NULL) {
+    return;
+  }
+
+  if (pf->archive) {
+    if (pf->mode == PTCACHE_FILE_WRITE) {
+      ptcache_archive_frame_add(pf->archive, pf->frame, pf->mem, (unsigned int)pf->mem_len);
+    }
+    else {
+      if (pf->mem_alloc) {
+        MEM_freeN(pf->mem);
+      }
+      BLI_mutex_unlock(&pf->archive->mutex);
+    }
+    ptcache_archive_release(pf->archive);
+  }
+  else {
     fclose(pf->fp);
-    MEM_freeN(pf);
   }
+  MEM_freeN(pf);
 }
 
 static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len)
@@ -1635,10 +2435,29 @@ static int ptcache_file_compressed_write(
 }
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
+  if (pf->archive) {
+    const size_t len = (size_t)tot * size;
+    if (pf->mem_pos + len > pf->mem_len) {
+      return 0;
+    }
+    memcpy(f, pf->mem + pf->mem_pos, len);
+    pf->mem_pos += len;
+    return 1;
+  }
   return (fread(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
 {
+  if (pf->archive) {
+    const size_t len = (size_t)tot * size;
+    if (pf->mem_len + len > pf->mem_alloc) {
+      pf->mem_alloc = MAX2(pf->mem_alloc * 2, pf->mem_len + len);
+      pf->mem = MEM_reallocN(pf->mem, pf->mem_alloc);
+    }
+    memcpy(pf->mem + pf->mem_len, f, len);
+    pf->mem_len += len;
+    return 1;
+  }
   return (fwrite(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_data_read(PTCacheFile *pf)
@@ -1675,7 +2494,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   pf->data_types = 0;
 
-  if (fread(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_read(pf, bphysics, 8, sizeof(char))) {
     error = 1;
   }
 
@@ -1683,7 +2502,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
     error = 1;
   }
 
-  if (!error && !fread(&typeflag, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &typeflag, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -1692,7 +2511,12 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   /* if there was an error set file as it was */
   if (error) {
-    BLI_fseek(pf->fp, 0, SEEK_SET);
+    if (pf->archive) {
+      pf->mem_pos = 0;
+    }
+    else {
+      BLI_fseek(pf->fp, 0, SEEK_SET);
+    }
   }
 
   return !error;
@@ -1702,11 +2526,11 @@ static int ptcache_file_header_begin_write(PTCacheFile *pf)
   const char *bphysics = "BPHYSICS";
   unsigned int typeflag = pf->type + pf->flag;
 
-  if (fwrite(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_write(pf, bphysics, 8, sizeof(char))) {
     return 0;
   }
 
-  if (!fwrite(&typeflag, sizeof(unsigned int), 1, pf->fp)) {
+  if (!ptcache_file_write(pf, &typeflag, 1, sizeof(unsigned int))) {
     return 0;
   }
 
@@ -2034,8 +2858,14 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 {
   PTCacheFile *pf = NULL;
   unsigned int i, error = 0;
+  /* Archives store the data arrays contiguously and compress whole frames when writing them. */
+  const bool use_archive = (pid->cache->flag & PTCACHE_DISK_ARCHIVE) != 0;
+  const int compression = use_archive ? PTCACHE_COMPRESS_NO : pid->cache->compression;
 
-  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
+  /* Archives replace the previous record of the frame when writing. */
+  if (!use_archive) {
+    BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
+  }
 
   pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, pm->frame);
 
@@ -2055,7 +2885,7 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
     pf->flag |= PTCACHE_TYPEFLAG_EXTRADATA;
   }
 
-  if (pid->cache->compression) {
+  if (compression || use_archive) {
     pf->flag |= PTCACHE_TYPEFLAG_COMPRESS;
   }
 
@@ -2064,15 +2894,16 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
   }
 
   if (!error) {
-    if (pid->cache->compression) {
+    if (compression || use_archive) {
       for (i = 0; i < BPHYS_TOT_DATA; i++) {
         if (pm->data[i]) {
           unsigned int in_len = pm->totpoint * ptcache_data_size[i];
-          unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                            "pointcache_lzo_buffer");
+          unsigned char *out = compression ? (unsigned char *)MEM_callocN(
+                                                 LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer") :
+                                             NULL;
           ptcache_file_compressed_write(
-              pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
-          MEM_freeN(out);
+              pf, (unsigned char *)(pm->data[i]), in_len, out, compression);
+          MEM_SAFE_FREE(out);
         }
       }
     }
@@ -2103,13 +2934,14 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
       ptcache_file_write(pf, &extra->type, 1, sizeof(unsigned int));
       ptcache_file_write(pf, &extra->totdata, 1, sizeof(unsigned int));
 
-      if (pid->cache->compression) {
+      if (compression || use_archive) {
         unsigned int in_len = extra->totdata * ptcache_extra_datasize[extra->type];
-        unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                          "pointcache_lzo_buffer");
+        unsigned char *out = compression ? (unsigned char *)MEM_callocN(
+                                               LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer") :
+                                           NULL;
         ptcache_file_compressed_write(
-            pf, (unsigned char *)(extra->data), in_len, out, pid->cache->compression);
-        MEM_freeN(out);
+            pf, (unsigned char *)(extra->data), in_len, out, compression);
+        MEM_SAFE_FREE(out);
       }
       else {
         ptcache_file_write(pf, extra->data, extra->totdata, ptcache_extra_datasize[extra->type]);
@@ -2128,13 +2960,15 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 
 static int ptcache_read_stream(PTCacheID *pid, int cfra)
 {
-  PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
+  PTCacheFile *pf;
   int error = 0;
 
   if (pid->read_stream == NULL) {
     return 0;
   }
 
+  pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
+
   if (pf == NULL) {
     if (G.debug & G_DEBUG) {
       printf("Error opening disk cache file for reading\n");
@@ -2389,7 +3223,10 @@ static int ptcache_write_stream(PTCacheID *pid, int cfra, int totpoint)
   PTCacheFile *pf = NULL;
   int error = 0;
 
-  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, cfra);
+  /* Archives replace the previous record of the frame when writing. */
+  if ((pid->cache->flag & PTCACHE_DISK_ARCHIVE) == 0) {
+    BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, cfra);
+  }
 
   pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, cfra);
 
@@ -2639,7 +3476,10 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
     case PTCACHE_CLEAR_ALL:
     case PTCACHE_CLEAR_BEFORE:
     case PTCACHE_CLEAR_AFTER:
-      if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+      if (pid->cache->flag & PTCACHE_DISK_ARCHIVE && pid->cache->flag & PTCACHE_DISK_CACHE) {
+        ptcache_archive_clear(pid, mode, cfra);
+      }
+      else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         ptcache_path(pid, path);
 
         dir = opendir(path);
@@ -2727,7 +3567,10 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
       break;
 
     case PTCACHE_CLEAR_FRAME:
-      if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+      if (pid->cache->flag & PTCACHE_DISK_ARCHIVE && pid->cache->flag & PTCACHE_DISK_CACHE) {
+        ptcache_archive_clear(pid, mode, cfra);
+      }
+      else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         if (BKE_ptcache_id_exist(pid, cfra)) {
           ptcache_filename(pid, filename, cfra, 1, 1); /* no path */
           BLI_delete(filename, false, false);
@@ -2770,6 +3613,10 @@ int BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
   if (pid->cache->flag & PTCACHE_DISK_CACHE) {
     char filename[MAX_PTCACHE_FILE];
 
+    if (pid->cache->flag & PTCACHE_DISK_ARCHIVE) {
+      return ptcache_archive_frame_exists(pid, cfra);
+    }
+
     ptcache_filename(pid, filename, cfra, 1, 1);
 
     return BLI_exists(filename);
@@ -2835,7 +3682,10 @@ void BKE_ptcache_id_time(
     cache->cached_frames = MEM_callocN(sizeof(char) * cache->cached_frames_len,
                                        "cached frames array");
 
-    if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+    if (pid->cache->flag & PTCACHE_DISK_ARCHIVE && pid->cache->flag & PTCACHE_DISK_CACHE) {
+      ptcache_archive_frames_range(pid, cache->cached_frames, NULL, NULL, NULL);
+    }
+    else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
       /* mode is same as fopen's modes */
       DIR *dir;
       struct dirent *de;
@@ -3038,7 +3888,7 @@ void BKE_ptcache_remove(void)
       if (FILENAME_IS_CURRPAR(de->d_name)) {
         /* do nothing */
       }
-      else if (strstr(de->d_name, PTCACHE_EXT)) { /* do we have the right extension?*/
+      else if (strstr(de->d_name, PTCACHE_EXT) || strstr(de->d_name, PTCACHE_ARCHIVE_EXT)) {
         BLI_join_dirfile(path_full, sizeof(path_full), path, de->d_name);
         BLI_delete(path_full, false, false);
       }
@@ -3120,7 +3970,8 @@ static PointCache *ptcache_copy(PointCache *cache, const bool copy_data)
     ncache->cached_frames_len = 0;
 
     /* flag is a mix of user settings and simulator/baking state */
-    ncache->flag = ncache->flag & (PTCACHE_DISK_CACHE | PTCACHE_EXTERNAL | PTCACHE_IGNORE_LIBPATH);
+    ncache->flag = ncache->flag & (PTCACHE_DISK_CACHE | PTCACHE_DISK_ARCHIVE | PTCACHE_EXTERNAL |
+                                   PTCACHE_IGNORE_LIBPATH);
     ncache->simframe = 0;
   }
   else {
@@ -3535,6 +4386,55 @@ void BKE_ptcache_toggle_disk_cache(PTCacheID *pid)
   }
 }
 
+void BKE_ptcache_toggle_disk_archive(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  ListBase mem_cache = {NULL, NULL};
+  int last_exact = cache->last_exact;
+  int baked = cache->flag & PTCACHE_BAKED;
+
+  if ((cache->flag & PTCACHE_DISK_CACHE) == 0 || pid->read_stream || !G.relbase_valid) {
+    return;
+  }
+
+  /* Read the frames in the previous format and clear them. */
+  cache->flag &= ~PTCACHE_BAKED;
+  cache->flag ^= PTCACHE_DISK_ARCHIVE;
+
+  for (int cfra = cache->startframe; cfra <= cache->endframe; cfra++) {
+    PTCacheMem *pm = ptcache_disk_frame_to_mem(pid, cfra);
+
+    if (pm) {
+      BLI_addtail(&mem_cache, pm);
+    }
+  }
+
+  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_ALL, 0);
+  cache->flag ^= PTCACHE_DISK_ARCHIVE;
+
+  LISTBASE_FOREACH (PTCacheMem *, pm, &mem_cache) {
+    ptcache_mem_frame_to_disk(pid, pm);
+  }
+  BKE_ptcache_free_mem(&mem_cache);
+
+  cache->flag |= baked;
+  cache->last_exact = last_exact;
+
+  /* write info file */
+  if (cache->flag & PTCACHE_BAKED) {
+    BKE_ptcache_write(pid, 0);
+  }
+
+  if (cache->cached_frames) {
+    MEM_freeN(cache->cached_frames);
+    cache->cached_frames = NULL;
+    cache->cached_frames_len = 0;
+  }
+  BKE_ptcache_id_time(pid, NULL, 0.0f, NULL, NULL, NULL);
+
+  cache->flag |= PTCACHE_FLAG_INFO_DIRTY;
+}
+
 void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const char *name_dst)
 {
   char old_name[80];
@@ -3554,6 +4454,20 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   /* get "from" filename */
   BLI_strncpy(pid->cache->name, name_src, sizeof(pid->cache->name));
 
+  if (pid->cache->flag & PTCACHE_DISK_ARCHIVE) {
+    ptcache_archive_close(pid, false);
+    ptcache_archive_filename(pid, old_path_full);
+
+    BLI_strncpy(pid->cache->name, name_dst, sizeof(pid->cache->name));
+    ptcache_archive_filename(pid, new_path_full);
+    if (BLI_exists(old_path_full)) {
+      BLI_rename(old_path_full, new_path_full);
+    }
+
+    BLI_strncpy(pid->cache->name, old_name, sizeof(pid->cache->name));
+    return;
+  }
+
   len = ptcache_filename(pid, old_filename, 0, 0, 0); /* no path */
 
   ptcache_path(pid, path);
@@ -3607,43 +4521,53 @@ void BKE_ptcache_load_external(PTCacheID *pid)
     return;
   }
 
-  ptcache_path(pid, path);
-
-  len = ptcache_filename(pid, filename, 1, 0, 0); /* no path */
+  if (cache->flag & PTCACHE_DISK_ARCHIVE) {
+    bool has_info = false;
 
-  dir = opendir(path);
-  if (dir == NULL) {
-    return;
+    /* The archive may have been replaced on disk. */
+    ptcache_archive_close(pid, false);
+    ptcache_archive_frames_range(pid, NULL, &start, &end, &has_info);
+    info = has_info;
   }
+  else {
+    ptcache_path(pid, path);
 
-  const char *fext = ptcache_file_extension(pid);
+    len = ptcache_filename(pid, filename, 1, 0, 0); /* no path */
 
-  if (cache->index >= 0) {
-    BLI_snprintf(ext, sizeof(ext), "_%02d%s", cache->index, fext);
-  }
-  else {
-    BLI_strncpy(ext, fext, sizeof(ext));
-  }
+    dir = opendir(path);
+    if (dir == NULL) {
+      return;
+    }
 
-  while ((de = readdir(dir)) != NULL) {
-    if (strstr(de->d_name, ext)) {               /* do we have the right extension?*/
-      if (STREQLEN(filename, de->d_name, len)) { /* do we have the right prefix */
-        /* read the number of the file */
-        const int frame = ptcache_frame_from_filename(de->d_name, ext);
+    const char *fext = ptcache_file_extension(pid);
 
-        if (frame != -1) {
-          if (frame) {
-            start = MIN2(start, frame);
-            end = MAX2(end, frame);
-          }
-          else {
-            info = 1;
+    if (cache->index >= 0) {
+      BLI_snprintf(ext, sizeof(ext), "_%02d%s", cache->index, fext);
+    }
+    else {
+      BLI_strncpy(ext, fext, sizeof(ext));
+    }
+
+    while ((de = readdir(dir)) != NULL) {
+      if (strstr(de->d_name, ext)) {               /* do we have the right extension?*/
+        if (STREQLEN(filename, de->d_name, len)) { /* do we have the right prefix */
+          /* read the number of the file */
+          const int frame = ptcache_frame_from_filename(de->d_name, ext);
+
+          if (frame != -1) {
+            if (frame) {
+              start = MIN2(start, frame);
+              end = MAX2(end, frame);
+            }
+            else {
+              info = 1;
+            }
           }
         }
       }
     }
+    closedir(dir);
   }
-  closedir(dir);
 
   if (start != MAXFRAME) {
     PTCacheFile *pf;
@@ -3673,7 +4597,7 @@ void BKE_ptcache_load_external(PTCacheID *pid)
       }
     }
     /* or from any old format cache file */
-    else {
+    else if ((cache->flag & PTCACHE_DISK_ARCHIVE) == 0) {
       float old_data[14];
       int elemsize = ptcache_old_elemsize(pid);
       pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cache->startframe);
@@ -0,0 +1,153 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_pointcache.h"
+#include "BKE_softbody.h"
+
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcache_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+#include "BLI_span.hh"
+#include "BLI_string.h"
+
+namespace blender::bke::tests {
+
+static void softbody_points_set(MutableSpan<BodyPoint> points, const int frame)
+{
+  for (const int i : points.index_range()) {
+    for (int axis = 0; axis < 3; axis++) {
+      points[i].pos[axis] = (float)(frame * 1000 + i) + (float)axis * 0.1f;
+      points[i].vec[axis] = (float)frame - (float)axis;
+    }
+  }
+}
+
+static void softbody_frame_write(PTCacheID *pid, MutableSpan<BodyPoint> points, const int frame)
+{
+  softbody_points_set(points, frame);
+  EXPECT_TRUE(BKE_ptcache_write(pid, frame));
+}
+
+static void softbody_frame_expect(PTCacheID *pid, MutableSpan<BodyPoint> points, const int frame)
+{
+  for (BodyPoint &point : points) {
+    zero_v3(point.pos);
+    zero_v3(point.vec);
+  }
+  ASSERT_EQ(BKE_ptcache_read(pid, (float)frame, false), PTCACHE_READ_EXACT);
+  for (const int i : points.index_range()) {
+    for (int axis = 0; axis < 3; axis++) {
+      EXPECT_EQ(points[i].pos[axis], (float)(frame * 1000 + i) + (float)axis * 0.1f);
+      EXPECT_EQ(points[i].vec[axis], (float)frame - (float)axis);
+    }
+  }
+}
+
+TEST(pointcache, DiskArchive)
+{
+  BKE_tempdir_init(nullptr);
+
+  /* Soft body with an external disk cache stored in a single file archive. */
+  Object ob = {{nullptr}};
+  SoftBody sb = {0};
+  SoftBody_Shared shared = {nullptr};
+  Array<BodyPoint> points(1000);
+
+  STRNCPY(ob.id.name, "OBSoftBody");
+  ob.type = OB_MESH;
+  sb.shared = &shared;
+  sb.totpoint = (int)points.size();
+  sb.bpoint = points.data();
+
+  PointCache *cache = BKE_ptcache_add(&shared.ptcaches);
+  shared.pointcache = cache;
+  cache->flag |= PTCACHE_DISK_CACHE | PTCACHE_DISK_ARCHIVE | PTCACHE_EXTERNAL;
+  cache->compression = PTCACHE_COMPRESS_LZO;
+  cache->index = 0;
+  STRNCPY(cache->name, "archive");
+  STRNCPY(cache->path, BKE_tempdir_session());
+
+  PTCacheID pid;
+  BKE_ptcache_id_from_softbody(&pid, &ob, &sb);
+
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), cache->path, "archive_00" PTCACHE_ARCHIVE_EXT);
+
+  for (int frame = 1; frame <= 10; frame++) {
+    softbody_frame_write(&pid, points, frame);
+  }
+  /* Frames may still be waiting to be written. */
+  for (int frame = 1; frame <= 10; frame++) {
+    softbody_frame_expect(&pid, points, frame);
+  }
+
+  /* Read the frames back through the index of the written archive. */
+  BKE_ptcache_exit();
+  EXPECT_TRUE(BLI_exists(filepath));
+  const size_t file_size = BLI_file_size(filepath);
+  for (int frame = 1; frame <= 10; frame++) {
+    EXPECT_TRUE(BKE_ptcache_id_exist(&pid, frame));
+    softbody_frame_expect(&pid, points, frame);
+  }
+
+  /* Simulating again after the first frame doesn't grow the file. */
+  for (int i = 0; i < 3; i++) {
+    BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_AFTER, 1);
+    for (int frame = 2; frame <= 10; frame++) {
+      softbody_frame_write(&pid, points, frame);
+    }
+    BKE_ptcache_exit();
+    EXPECT_EQ(BLI_file_size(filepath), file_size);
+  }
+
+  /* Cleared frames are removed from the file, and stay removed after reopening the archive. */
+  BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_AFTER, 5);
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid, 6));
+  EXPECT_LT(BLI_file_size(filepath), file_size * 6 / 10);
+  BKE_ptcache_exit();
+  EXPECT_TRUE(BKE_ptcache_id_exist(&pid, 5));
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid, 6));
+  softbody_frame_expect(&pid, points, 5);
+
+  /* Rewritten frames replace the previous records. */
+  softbody_frame_write(&pid, points, 6);
+  BKE_ptcache_exit();
+  softbody_frame_expect(&pid, points, 6);
+
+  /* Copies keep using an archive. */
+  ListBase ptcaches_copy = {nullptr};
+  BKE_ptcache_copy_list(&ptcaches_copy, &shared.ptcaches, 0);
+  EXPECT_TRUE(((PointCache *)ptcaches_copy.first)->flag & PTCACHE_DISK_ARCHIVE);
+  BKE_ptcache_free_list(&ptcaches_copy);
+
+  BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_ALL, 0);
+  EXPECT_FALSE(BLI_exists(filepath));
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid, 1));
+
+  BKE_ptcache_exit();
+  BKE_ptcache_free_list(&shared.ptcaches);
+}
+
+}  // namespace blender::bke::tests
@@ -149,6 +149,7 @@ bool BKE_shrinkwrap_init_tree(
   if (force_normals || BKE_shrinkwrap_needs_normals(shrinkType, shrinkMode)) {
     data->pnors = CustomData_get_layer(&mesh->pdata, CD_NORMAL);
     if ((mesh->flag & ME_AUTOSMOOTH) != 0) {
+      BKE_mesh_ensure_normals_split(mesh);
       data->clnors = CustomData_get_layer(&mesh->ldata, CD_NORMAL);
     }
   }
@@ -2021,6 +2021,9 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   int gridSideEdges;
   int gridInternalEdges;
   WeightTable wtable = {NULL};
+  float *interp_weights = NULL;
+  int *interp_indices = NULL;
+  int interp_len, interp_size, interp_size_alloc = 0;
   MEdge *medge = NULL;
   MPoly *mpoly = NULL;
   bool has_edge_cd;
@@ -2090,28 +2093,27 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       vertidx[s] = POINTER_AS_INT(ccgSubSurf_getVertVertHandle(v));
     }
 
-    /*I think this is for interpolating the center vert?*/
-    w2 = w;  // + numVerts*(g2_wid-1) * (g2_wid-1); //numVerts*((g2_wid-1) * g2_wid+g2_wid-1);
-    DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
-    if (vertOrigIndex) {
-      *vertOrigIndex = ORIGINDEX_NONE;
-      vertOrigIndex++;
+    /* The weights of all interpolated verts and loops of the face are gathered first, so their
+     * data can be interpolated with one call per face. */
+    interp_size = numVerts * gridFaces * gridFaces * 4 * numVerts;
+    if (interp_size > interp_size_alloc) {
+      MEM_SAFE_FREE(interp_weights);
+      MEM_SAFE_FREE(interp_indices);
+      interp_weights = MEM_malloc_arrayN((size_t)interp_size, sizeof(*interp_weights), __func__);
+      interp_indices = MEM_malloc_arrayN((size_t)interp_size, sizeof(*interp_indices), __func__);
+      interp_size_alloc = interp_size;
     }
+    interp_len = 0;
 
-    vertNum++;
+    /*I think this is for interpolating the center vert?*/
+    w2 = w;  // + numVerts*(g2_wid-1) * (g2_wid-1); //numVerts*((g2_wid-1) * g2_wid+g2_wid-1);
+    memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
 
     /*interpolate per-vert data*/
     for (s = 0; s < numVerts; s++) {
       for (x = 1; x < gridFaces; x++) {
         w2 = w + s * numVerts * g2_wid * g2_wid + x * numVerts;
-        DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
-
-        if (vertOrigIndex) {
-          *vertOrigIndex = ORIGINDEX_NONE;
-          vertOrigIndex++;
-        }
-
-        vertNum++;
+        memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
       }
     }
 
@@ -2120,47 +2122,67 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       for (y = 1; y < gridFaces; y++) {
         for (x = 1; x < gridFaces; x++) {
           w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-          DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
-
-          if (vertOrigIndex) {
-            *vertOrigIndex = ORIGINDEX_NONE;
-            vertOrigIndex++;
-          }
-
-          vertNum++;
+          memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
         }
       }
     }
 
+    for (i = 0; i < interp_len; i++) {
+      memcpy(&interp_indices[i * numVerts], vertidx, sizeof(*vertidx) * numVerts);
+    }
+    CustomData_interp_indices(&dm->vertData,
+                              &ccgdm->dm.vertData,
+                              interp_indices,
+                              interp_weights,
+                              numVerts,
+                              vertNum,
+                              interp_len);
+    if (vertOrigIndex) {
+      copy_vn_i(vertOrigIndex, interp_len, ORIGINDEX_NONE);
+      vertOrigIndex += interp_len;
+    }
+    vertNum += interp_len;
+
     if (edgeOrigIndex) {
       for (i = 0; i < numFinalEdges; i++) {
         edgeOrigIndex[edgeNum + i] = ORIGINDEX_NONE;
       }
     }
 
+    /*interpolate per-face data*/
+    interp_len = 0;
     for (s = 0; s < numVerts; s++) {
-      /*interpolate per-face data*/
       for (y = 0; y < gridFaces; y++) {
         for (x = 0; x < gridFaces; x++) {
           w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
 
           w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
 
           w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x + 1)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
 
           w2 = w + s * numVerts * g2_wid * g2_wid + ((y)*g2_wid + (x + 1)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          memcpy(&interp_weights[interp_len++ * numVerts], w2, sizeof(*w2) * numVerts);
+        }
+      }
+    }
+    for (i = 0; i < interp_len; i++) {
+      memcpy(&interp_indices[i * numVerts], loopidx, sizeof(*loopidx) * numVerts);
+    }
+    CustomData_interp_indices(&dm->loopData,
+                              &ccgdm->dm.loopData,
+                              interp_indices,
+                              interp_weights,
+                              numVerts,
+                              loopindex2,
+                              interp_len);
+    loopindex2 += interp_len;
+
+    for (s = 0; s < numVerts; s++) {
+      for (y = 0; y < gridFaces; y++) {
+        for (x = 0; x < gridFaces; x++) {
 
           /*copy over poly data, e.g. mtexpoly*/
           CustomData_copy_data(&dm->polyData, &ccgdm->dm.polyData, origIndex, faceNum, 1);
@@ -2279,6 +2301,8 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   BLI_array_free(vertidx);
   BLI_array_free(loopidx);
 #endif
+  MEM_SAFE_FREE(interp_weights);
+  MEM_SAFE_FREE(interp_indices);
   free_ss_weights(&wtable);
 
   BLI_assert(vertNum == ccgSubSurf_getNumFinalVerts(ss));
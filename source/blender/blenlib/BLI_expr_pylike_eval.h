@@ -45,6 +45,10 @@ void BLI_expr_pylike_free(struct ExprPyLike_Parsed *expr);
 bool BLI_expr_pylike_is_valid(struct ExprPyLike_Parsed *expr);
 bool BLI_expr_pylike_is_constant(struct ExprPyLike_Parsed *expr);
 bool BLI_expr_pylike_is_using_param(struct ExprPyLike_Parsed *expr, int index);
+int BLI_expr_pylike_param_paths_len(struct ExprPyLike_Parsed *expr);
+const char *BLI_expr_pylike_param_path_get(struct ExprPyLike_Parsed *expr,
+                                           int path_index,
+                                           int *r_param_index);
 ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression,
                                          const char **param_names,
                                          int param_names_len);
@@ -49,6 +49,12 @@ int incircle_fast(const double2 &a, const double2 &b, const double2 &c, const do
 int orient3d(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
 int orient3d_fast(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
 
+/* #orient3d_filter is for approximate inputs, such as the double coordinates of vertices whose
+ * exact coordinates are rational. It returns the sign that #orient3d of the exact coordinates
+ * would give when a static error bound proves it, else 0 and the caller has to fall back to
+ * exact arithmetic. */
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
+
 int insphere(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e);
 int insphere_fast(
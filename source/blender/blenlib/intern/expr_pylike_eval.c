@@ -29,14 +29,19 @@
  *  - Literals:
  *      floating point and decimal integer.
  *  - Constants:
- *      pi, True, False
+ *      pi, tau, e, True, False
  *  - Operators:
  *      +, -, *, /, ==, !=, <, <=, >, >=, and, or, not, ternary if
  *  - Functions:
  *      min, max, radians, degrees,
- *      abs, fabs, floor, ceil, trunc, int,
+ *      abs, fabs, floor, ceil, trunc, int, float, bool, round,
  *      sin, cos, tan, asin, acos, atan, atan2,
- *      exp, log, sqrt, pow, fmod
+ *      sinh, cosh, tanh, asinh, acosh, atanh,
+ *      exp, expm1, log, log1p, log2, log10, sqrt, pow, fmod, hypot, copysign,
+ *      lerp, clamp, smoothstep
+ *  - Parameter attributes and subscripts:
+ *      param.attr[0]["name"].attr, added as extra parameters with a path (`attr[0]["name"].attr`)
+ *      that the caller evaluates, see #BLI_expr_pylike_param_path_get.
  *
  * The implementation has no global state and can be used multi-threaded.
  */
@@ -44,6 +49,7 @@
 #include <ctype.h>
 #include <fenv.h>
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -53,8 +59,10 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_alloca.h"
+#include "BLI_dynstr.h"
 #include "BLI_expr_pylike_eval.h"
 #include "BLI_math_base.h"
+#include "BLI_string.h"
 #include "BLI_utildefines.h"
 
 #ifdef _MSC_VER
@@ -111,13 +119,30 @@ typedef struct ExprOp {
   } arg;
 } ExprOp;
 
+/* Attribute or subscript path of a parameter, evaluated by the caller as an extra parameter. */
+typedef struct ExprParamPath {
+  int param_index;
+  char *path;
+} ExprParamPath;
+
 struct ExprPyLike_Parsed {
   int ops_count;
   int max_stack;
 
+  int param_paths_len;
+  ExprParamPath *param_paths;
+
   ExprOp ops[];
 };
 
+static void expr_param_paths_free(ExprParamPath *param_paths, int param_paths_len)
+{
+  for (int i = 0; i < param_paths_len; i++) {
+    MEM_freeN(param_paths[i].path);
+  }
+  MEM_SAFE_FREE(param_paths);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -128,6 +153,7 @@ struct ExprPyLike_Parsed {
 void BLI_expr_pylike_free(ExprPyLike_Parsed *expr)
 {
   if (expr != NULL) {
+    expr_param_paths_free(expr->param_paths, expr->param_paths_len);
     MEM_freeN(expr);
   }
 }
@@ -162,6 +188,28 @@ bool BLI_expr_pylike_is_using_param(ExprPyLike_Parsed *expr, int index)
   return false;
 }
 
+/**
+ * Number of parameter paths used by the expression. Their values follow the named parameters
+ * in the values given to #BLI_expr_pylike_eval.
+ */
+int BLI_expr_pylike_param_paths_len(ExprPyLike_Parsed *expr)
+{
+  return expr != NULL ? expr->param_paths_len : 0;
+}
+
+/**
+ * Get a parameter path, i.e. `location[0]` for `var.location[0]` where `var` is the parameter
+ * with index \a r_param_index. Subscripts use RNA path syntax (strings are always double-quoted).
+ */
+const char *BLI_expr_pylike_param_path_get(ExprPyLike_Parsed *expr,
+                                           int path_index,
+                                           int *r_param_index)
+{
+  BLI_assert(path_index >= 0 && path_index < expr->param_paths_len);
+  *r_param_index = expr->param_paths[path_index].param_index;
+  return expr->param_paths[path_index].path;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -364,6 +412,16 @@ static double op_smoothstep(double a, double b, double x)
   return t * t * (3.0 - 2.0 * t);
 }
 
+static double op_float(double a)
+{
+  return a;
+}
+
+static double op_bool(double a)
+{
+  return a ? 1.0 : 0.0;
+}
+
 static double op_not(double a)
 {
   return a ? 0.0 : 1.0;
@@ -405,7 +463,7 @@ typedef struct BuiltinConstDef {
 } BuiltinConstDef;
 
 static BuiltinConstDef builtin_consts[] = {
-    {"pi", M_PI}, {"True", 1.0}, {"False", 0.0}, {NULL, 0.0}};
+    {"pi", M_PI}, {"tau", 2.0 * M_PI}, {"e", M_E}, {"True", 1.0}, {"False", 0.0}, {NULL, 0.0}};
 
 typedef struct BuiltinOpDef {
   const char *name;
@@ -430,6 +488,8 @@ static BuiltinOpDef builtin_ops[] = {
     {"trunc", OPCODE_FUNC1, trunc},
     {"round", OPCODE_FUNC1, round},
     {"int", OPCODE_FUNC1, trunc},
+    {"float", OPCODE_FUNC1, op_float},
+    {"bool", OPCODE_FUNC1, op_bool},
     {"sin", OPCODE_FUNC1, sin},
     {"cos", OPCODE_FUNC1, cos},
     {"tan", OPCODE_FUNC1, tan},
@@ -437,12 +497,24 @@ static BuiltinOpDef builtin_ops[] = {
     {"acos", OPCODE_FUNC1, acos},
     {"atan", OPCODE_FUNC1, atan},
     {"atan2", OPCODE_FUNC2, atan2},
+    {"sinh", OPCODE_FUNC1, sinh},
+    {"cosh", OPCODE_FUNC1, cosh},
+    {"tanh", OPCODE_FUNC1, tanh},
+    {"asinh", OPCODE_FUNC1, asinh},
+    {"acosh", OPCODE_FUNC1, acosh},
+    {"atanh", OPCODE_FUNC1, atanh},
     {"exp", OPCODE_FUNC1, exp},
+    {"expm1", OPCODE_FUNC1, expm1},
     {"log", OPCODE_FUNC1, log},
     {"log", OPCODE_FUNC2, op_log2},
+    {"log1p", OPCODE_FUNC1, log1p},
+    {"log2", OPCODE_FUNC1, log2},
+    {"log10", OPCODE_FUNC1, log10},
     {"sqrt", OPCODE_FUNC1, sqrt},
     {"pow", OPCODE_FUNC2, pow},
     {"fmod", OPCODE_FUNC2, fmod},
+    {"hypot", OPCODE_FUNC2, hypot},
+    {"copysign", OPCODE_FUNC2, copysign},
     {"lerp", OPCODE_FUNC3, op_lerp},
     {"clamp", OPCODE_FUNC1, op_clamp},
     {"clamp", OPCODE_FUNC3, op_clamp3},
@@ -468,6 +540,7 @@ static BuiltinOpDef builtin_ops[] = {
  * these are special identifiers for multi-character tokens. */
 #define TOKEN_ID MAKE_CHAR2('I', 'D')
 #define TOKEN_NUMBER MAKE_CHAR2('0', '0')
+#define TOKEN_STRING MAKE_CHAR2('S', 'T')
 #define TOKEN_GE MAKE_CHAR2('>', '=')
 #define TOKEN_LE MAKE_CHAR2('<', '=')
 #define TOKEN_NE MAKE_CHAR2('!', '=')
@@ -514,6 +587,10 @@ typedef struct ExprParseState {
 
   /* Stack space requirement tracking */
   int stack_ptr, max_stack;
+
+  /* Parameter paths, added as extra parameters */
+  int param_paths_len, max_param_paths;
+  ExprParamPath *param_paths;
 } ExprParseState;
 
 /* Reserve space for the specified number of operations in the buffer. */
@@ -713,6 +790,23 @@ static bool parse_next_token(ExprParseState *state)
     return (end == out);
   }
 
+  /* String literals, only used in parameter subscripts. Escape sequences aren't supported. */
+  if (ELEM(*state->cur, '"', '\'')) {
+    const char quote = *state->cur++;
+    char *out = state->tokenbuf;
+
+    while (!ELEM(*state->cur, quote, '\\', '\0')) {
+      *out++ = *state->cur++;
+    }
+
+    CHECK_ERROR(*state->cur == quote);
+    state->cur++;
+    *out = 0;
+
+    state->token = TOKEN_STRING;
+    return true;
+  }
+
   /* ?= tokens */
   if (state->cur[1] == '=' && strchr(token_eq_characters, state->cur[0])) {
     state->token = MAKE_CHAR2(state->cur[0], state->cur[1]);
@@ -758,6 +852,77 @@ static bool parse_next_token(ExprParseState *state)
 
 static bool parse_expr(ExprParseState *state);
 
+/* Add a parameter path as an extra parameter, reusing an identical one. */
+static void parse_add_param_path(ExprParseState *state, int param_index, char *path)
+{
+  int path_index;
+
+  for (path_index = 0; path_index < state->param_paths_len; path_index++) {
+    ExprParamPath *param_path = &state->param_paths[path_index];
+    if (param_path->param_index == param_index && STREQ(param_path->path, path)) {
+      MEM_freeN(path);
+      break;
+    }
+  }
+
+  if (path_index == state->param_paths_len) {
+    if (state->param_paths_len == state->max_param_paths) {
+      state->max_param_paths = max_ii(4, state->max_param_paths * 2);
+      state->param_paths = MEM_reallocN(state->param_paths,
+                                        state->max_param_paths * sizeof(ExprParamPath));
+    }
+    state->param_paths[path_index].param_index = param_index;
+    state->param_paths[path_index].path = path;
+    state->param_paths_len++;
+  }
+
+  parse_add_op(state, OPCODE_PARAMETER, 1)->arg.ival = state->param_names_len + path_index;
+}
+
+/* Parse attributes and subscripts following a parameter name, i.e. `.location[0]`. */
+static bool parse_param_path(ExprParseState *state, int param_index)
+{
+  DynStr *path = BLI_dynstr_new();
+  bool ok = true;
+
+  while (ok && ELEM(state->token, '.', '[')) {
+    if (state->token == '.') {
+      ok = parse_next_token(state) && state->token == TOKEN_ID;
+      if (ok) {
+        if (BLI_dynstr_get_len(path) > 0) {
+          BLI_dynstr_append(path, ".");
+        }
+        BLI_dynstr_append(path, state->tokenbuf);
+      }
+    }
+    else {
+      ok = parse_next_token(state);
+      if (ok && state->token == TOKEN_NUMBER) {
+        /* Only plain non-negative integers, other indices aren't valid RNA paths. */
+        ok = state->tokenbuf[strspn(state->tokenbuf, "0123456789")] == '\0' &&
+             state->tokenval <= INT_MAX;
+        if (ok) {
+          BLI_dynstr_appendf(path, "[%d]", (int)state->tokenval);
+        }
+      }
+      else if (ok && state->token == TOKEN_STRING) {
+        BLI_dynstr_appendf(path, "[\"%s\"]", state->tokenbuf);
+      }
+      else {
+        ok = false;
+      }
+      ok = ok && parse_next_token(state) && state->token == ']';
+    }
+    ok = ok && parse_next_token(state);
+  }
+
+  if (ok) {
+    parse_add_param_path(state, param_index, BLI_dynstr_get_cstring(path));
+  }
+  BLI_dynstr_free(path);
+  return ok;
+}
+
 static int parse_function_args(ExprParseState *state)
 {
   if (!parse_next_token(state) || state->token != '(' || !parse_next_token(state)) {
@@ -818,8 +983,14 @@ static bool parse_unary(ExprParseState *state)
        * the last one should win. */
       for (i = state->param_names_len - 1; i >= 0; i--) {
         if (STREQ(state->tokenbuf, state->param_names[i])) {
+          CHECK_ERROR(parse_next_token(state));
+
+          if (ELEM(state->token, '.', '[')) {
+            return parse_param_path(state, i);
+          }
+
           parse_add_op(state, OPCODE_PARAMETER, 1)->arg.ival = i;
-          return parse_next_token(state);
+          return true;
         }
       }
 
@@ -1108,12 +1279,15 @@ ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression,
     expr = MEM_mallocN(bytesize, "ExprPyLike_Parsed");
     expr->ops_count = state.ops_count;
     expr->max_stack = state.max_stack;
+    expr->param_paths_len = state.param_paths_len;
+    expr->param_paths = state.param_paths;
 
     memcpy(expr->ops, state.ops, state.ops_count * sizeof(ExprOp));
   }
   else {
     /* Always return a non-NULL object so that parse failure can be cached. */
     expr = MEM_callocN(sizeof(ExprPyLike_Parsed), "ExprPyLike_Parsed(empty)");
+    expr_param_paths_free(state.param_paths, state.param_paths_len);
   }
 
   MEM_freeN(state.tokenbuf);
@@ -2518,6 +2518,54 @@ int orient3d_fast(const double3 &a, const double3 &b, const double3 &c, const do
   return sgn(robust_pred::orient3dfast(a, b, c, d));
 }
 
+/**
+ * The error bound follows Burnikel, Funke and Seel, "Exact Geometric Computation Using Cascading":
+ * the sign of an expression E calculated in doubles is correct if
+ *   |E| > supremum(E) * index(E) * DBL_EPSILON
+ * where supremum(E) is E evaluated with the absolute values of its inputs and all operations
+ * replaced by +, and index(E) counts the roundings along the longest path of E.
+ * Inputs are assumed to be rounded already (index 1), so the differences have index 2,
+ * the 2x2 minors have index 6 and the determinant has index 11.
+ */
+constexpr int index_orient3d_filter = 11;
+
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
+{
+  const double adx = a[0] - d[0];
+  const double bdx = b[0] - d[0];
+  const double cdx = c[0] - d[0];
+  const double ady = a[1] - d[1];
+  const double bdy = b[1] - d[1];
+  const double cdy = c[1] - d[1];
+  const double adz = a[2] - d[2];
+  const double bdz = b[2] - d[2];
+  const double cdz = c[2] - d[2];
+
+  const double det = adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy) +
+                     cdz * (adx * bdy - bdx * ady);
+
+  const double3 abs_a = double3::abs(a);
+  const double3 abs_b = double3::abs(b);
+  const double3 abs_c = double3::abs(c);
+  const double3 abs_d = double3::abs(d);
+  const double3 sup_ad = abs_a + abs_d;
+  const double3 sup_bd = abs_b + abs_d;
+  const double3 sup_cd = abs_c + abs_d;
+
+  const double supremum = sup_ad[2] * (sup_bd[0] * sup_cd[1] + sup_cd[0] * sup_bd[1]) +
+                          sup_bd[2] * (sup_cd[0] * sup_ad[1] + sup_ad[0] * sup_cd[1]) +
+                          sup_cd[2] * (sup_ad[0] * sup_bd[1] + sup_bd[0] * sup_ad[1]);
+  const double err_bound = supremum * index_orient3d_filter * DBL_EPSILON;
+
+  if (det > err_bound) {
+    return 1;
+  }
+  if (det < -err_bound) {
+    return -1;
+  }
+  return 0;
+}
+
 int insphere(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e)
 {
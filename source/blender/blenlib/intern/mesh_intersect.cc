@@ -1252,14 +1252,23 @@ static inline mpq3 tti_interp(const mpq3 &a, const mpq3 &b, const mpq3 &c, const
 }
 
 /**
- * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
- * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
+ * Return +1, 0, -1 as d is above, on, or below the oriented plane containing a, b, c in CCW
+ * order. This is the same as -orient3d(a, b, c, d).
+ * The double coordinates are tried first, exact arithmetic is only needed when d is
+ * (nearly) on the plane.
  */
-static inline int tti_above(const mpq3 &a, const mpq3 &b, const mpq3 &c, const mpq3 &ad)
+static inline int tti_above(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
 {
-  mpq3 n = mpq3::cross(b - a, c - a);
-  return sgn(mpq3::dot(ad, n));
+  const int filter_orient = orient3d_filter(a->co, b->co, c->co, d->co);
+  if (filter_orient != 0) {
+#  ifdef PERFDEBUG
+    incperfcount(5); /* Orientation tests decided by filter. */
+#  endif
+    return -filter_orient;
+  }
+  const mpq3 &a_exact = a->co_exact;
+  mpq3 n = mpq3::cross(b->co_exact - a_exact, c->co_exact - a_exact);
+  return sgn(mpq3::dot(d->co_exact - a_exact, n));
 }
 
 /**
@@ -1275,16 +1284,22 @@ static inline int tti_above(const mpq3 &a, const mpq3 &b, const mpq3 &c, const m
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *vp1,
+                            const Vert *vq1,
+                            const Vert *vr1,
+                            const Vert *vp2,
+                            const Vert *vq2,
+                            const Vert *vr2,
                             const mpq3 &n1,
                             const mpq3 &n2)
 {
   constexpr int dbg_level = 0;
+  const mpq3 &p1 = vp1->co_exact;
+  const mpq3 &q1 = vq1->co_exact;
+  const mpq3 &r1 = vr1->co_exact;
+  const mpq3 &p2 = vp2->co_exact;
+  const mpq3 &q2 = vq2->co_exact;
+  const mpq3 &r2 = vr2->co_exact;
   if (dbg_level > 0) {
     std::cout << "\ntri_tri_intersect_canon:\n";
     std::cout << "p1=" << p1 << " q1=" << q1 << " r1=" << r1 << "\n";
@@ -1300,16 +1315,15 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
     std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
   }
-  mpq3 p1p2 = p2 - p1;
   mpq3 intersect_1;
   mpq3 intersect_2;
   bool no_overlap = false;
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2) > 0) {
+  if (tti_above(vp1, vq1, vr2, vp2) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2) <= 0) {
+    if (tti_above(vp1, vr1, vr2, vp2) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2) > 0) {
+      if (tti_above(vp1, vr1, vq2, vp2) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
@@ -1338,7 +1352,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2) < 0) {
+    if (tti_above(vp1, vq1, vq2, vp2) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1347,7 +1361,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2) >= 0) {
+      if (tti_above(vp1, vr1, vq2, vp2) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
@@ -1384,12 +1398,12 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Arguments have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
@@ -1578,49 +1592,49 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
         if (dbg_level > 0) {
@@ -2868,6 +2882,10 @@ static void perfdata_init(void)
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("orientation tests decided by filter");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
@@ -111,6 +111,15 @@ TEST_PARSE_FAIL(Truncated7, "1 and")
 TEST_PARSE_FAIL(Truncated8, "1 or")
 TEST_PARSE_FAIL(Truncated9, "sqrt(1")
 TEST_PARSE_FAIL(Truncated10, "fmod(1,")
+TEST_PARSE_FAIL(Truncated11, "x.")
+TEST_PARSE_FAIL(Truncated12, "x[0")
+TEST_PARSE_FAIL(Truncated13, "x['a]")
+TEST_PARSE_FAIL(PathNegativeIndex, "x[-1]")
+TEST_PARSE_FAIL(PathFloatIndex, "x[1.0]")
+TEST_PARSE_FAIL(PathExprIndex, "x[1 + 1]")
+TEST_PARSE_FAIL(PathEscape, "x['a\\'b']")
+TEST_PARSE_FAIL(PathNoParam, "pi.real")
+TEST_PARSE_FAIL(StringValue, "'a'")
 
 /* Constant expression with working constant folding */
 #define TEST_CONST(name, str, value) \
@@ -143,6 +152,8 @@ TEST_CONST(TenE, "1.e+1", 10.0)
 TEST_CONST(Half, ".5", 0.5)
 
 TEST_CONST(Pi, "pi", M_PI)
+TEST_CONST(Tau, "tau", M_PI * 2.0)
+TEST_CONST(E, "e", M_E)
 TEST_CONST(True, "True", TRUE_VAL)
 TEST_CONST(False, "False", FALSE_VAL)
 
@@ -156,6 +167,18 @@ TEST_CONST(Pow, "pow(4, 0.5)", 2.0)
 TEST_EVAL(Pow, "pow(4, x)", 0.5, 2.0)
 
 TEST_CONST(Log2_1, "log(4, 2)", 2.0)
+TEST_CONST(Log2_2, "log2(8)", 3.0)
+TEST_CONST(Log10, "log10(100)", 2.0)
+TEST_CONST(Hypot, "hypot(3, 4)", 5.0)
+TEST_CONST(CopySign, "copysign(2, -0.5)", -2.0)
+TEST_CONST(Sinh, "sinh(0)", 0.0)
+TEST_CONST(Cosh, "cosh(0)", 1.0)
+TEST_EVAL(Tanh, "tanh(x)", 0.5, tanh(0.5))
+TEST_EVAL(Acosh, "acosh(x)", 1.0, 0.0)
+
+TEST_CONST(Float, "float(2)", 2.0)
+TEST_CONST(Bool1, "bool(2)", TRUE_VAL)
+TEST_CONST(Bool2, "bool(0)", FALSE_VAL)
 
 TEST_CONST(Round1, "round(-0.5)", -1.0)
 TEST_CONST(Round2, "round(-0.4)", 0.0)
@@ -319,6 +342,40 @@ TEST(expr_pylike, UsingParam)
   BLI_expr_pylike_free(expr);
 }
 
+TEST(expr_pylike, ParamPaths)
+{
+  const char *names[2] = {"x", "var"};
+
+  ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(
+      "var.location[1] * x + var.pose.bones['Bone'].location.z - var.location[1] + "
+      "var[\"prop\"] / var.matrix_world[0][3]",
+      names,
+      ARRAY_SIZE(names));
+
+  EXPECT_TRUE(BLI_expr_pylike_is_valid(expr));
+  EXPECT_FALSE(BLI_expr_pylike_is_using_param(expr, 1));
+  ASSERT_EQ(BLI_expr_pylike_param_paths_len(expr), 4);
+
+  /* Identical paths are only evaluated once. */
+  const char *paths[4] = {
+      "location[1]", "pose.bones[\"Bone\"].location.z", "[\"prop\"]", "matrix_world[0][3]"};
+  for (int i = 0; i < 4; i++) {
+    int param_index;
+    EXPECT_STREQ(BLI_expr_pylike_param_path_get(expr, i, &param_index), paths[i]);
+    EXPECT_EQ(param_index, 1);
+  }
+
+  double values[6] = {2.0, 0.0, 3.0, 5.0, 8.0, 4.0};
+  double result;
+  EXPECT_EQ(BLI_expr_pylike_eval(expr, values, 6, &result), EXPR_PYLIKE_SUCCESS);
+  EXPECT_EQ(result, 3.0 * 2.0 + 5.0 - 3.0 + 8.0 / 4.0);
+
+  /* Values for the paths are required. */
+  EXPECT_EQ(BLI_expr_pylike_eval(expr, values, 2, &result), EXPR_PYLIKE_FATAL_ERROR);
+
+  BLI_expr_pylike_free(expr);
+}
+
 #define TEST_ERROR(name, str, x, code) \
   TEST(expr_pylike, Error_##name) \
   { \
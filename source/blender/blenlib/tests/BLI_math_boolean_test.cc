@@ -0,0 +1,55 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_double3.hh"
+#include "BLI_math_boolean.hh"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+TEST(math_boolean, Orient3dFilterSimple)
+{
+  double3 a(0.0, 0.0, 0.0);
+  double3 b(1.0, 0.0, 0.0);
+  double3 c(0.0, 1.0, 0.0);
+  /* #orient3d is positive when d is below the plane of a, b, c. */
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.3, -1.0)), 1);
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.3, 1.0)), -1);
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.3, 0.0)), 0);
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(5.0, -3.0, 0.0)), 0);
+}
+
+TEST(math_boolean, Orient3dFilterNearlyCoplanar)
+{
+  /* Points so close to the plane that the double determinant can't be trusted,
+   * the filter has to leave those to exact arithmetic. */
+  double3 a(0.1, 0.1, 0.1);
+  double3 b(1.1, 0.3, 0.1);
+  double3 c(0.7, 1.9, 0.1);
+  double3 d(0.3, 0.7, 0.1 + 1e-15);
+  EXPECT_EQ(orient3d_filter(a, b, c, d), 0);
+}
+
+TEST(math_boolean, Orient3dFilterAgreesWithExact)
+{
+  RandomNumberGenerator rng(0);
+  for (int i = 0; i < 10000; i++) {
+    double3 p[4];
+    for (int j = 0; j < 4; j++) {
+      p[j] = double3(rng.get_double(), rng.get_double(), rng.get_double());
+    }
+    /* Every other test puts d (nearly) on the plane of a, b, c. */
+    if (i % 2) {
+      const double u = rng.get_double();
+      const double v = rng.get_double();
+      p[3] = p[0] + (p[1] - p[0]) * u + (p[2] - p[0]) * v;
+    }
+    const int filter = orient3d_filter(p[0], p[1], p[2], p[3]);
+    if (filter != 0) {
+      EXPECT_EQ(filter, orient3d(p[0], p[1], p[2], p[3]));
+    }
+  }
+}
+
+}  // namespace blender::tests
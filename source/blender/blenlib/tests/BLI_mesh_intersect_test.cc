@@ -1169,6 +1169,85 @@ static void gridgrid_test(int x_level_1,
   BLI_task_scheduler_exit();
 }
 
+static void fill_cube_data(const double3 &center,
+                           double size,
+                           MutableSpan<Face *> face,
+                           int vid_start,
+                           int fid_start,
+                           IMeshArena *arena)
+{
+  BLI_assert(face.size() == 12);
+  Array<int> eid = {0, 0, 0, 0}; /* Don't care about edge ids. */
+  double r = size / 2.0;
+  const Vert *vert[8];
+  int vid = vid_start;
+  for (int i = 0; i < 8; ++i) {
+    double x = center[0] + ((i & 1) ? r : -r);
+    double y = center[1] + ((i & 2) ? r : -r);
+    double z = center[2] + ((i & 4) ? r : -r);
+    vert[i] = arena->add_or_find_vert(mpq3(x, y, z), vid++);
+  }
+  /* Quads with outward facing normals, each split into two triangles. */
+  const int quads[6][4] = {
+      {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+  int fid = fid_start;
+  for (int q = 0; q < 6; ++q) {
+    const Vert *v0 = vert[quads[q][0]];
+    const Vert *v1 = vert[quads[q][1]];
+    const Vert *v2 = vert[quads[q][2]];
+    const Vert *v3 = vert[quads[q][3]];
+    face[2 * q] = arena->add_face({v0, v1, v2}, fid++, eid);
+    face[2 * q + 1] = arena->add_face({v2, v3, v0}, fid++, eid);
+  }
+}
+
+static void cubelattice_test(int n, double overlap, bool use_self)
+{
+  /* Make an n x n x n lattice of unit cubes, each overlapping its neighbors by `overlap`.
+   * Lots of axis aligned, co-planar and nearly co-planar faces, as in hard-surface modeling,
+   * which is where the floating point filters of the exact predicates matter most. */
+  if (n < 1) {
+    return;
+  }
+  BLI_task_scheduler_init(); /* Without this, no parallelism. */
+  double time_start = PIL_check_seconds_timer();
+  IMeshArena arena;
+  const int num_cubes = n * n * n;
+  Array<Face *> tris(12 * num_cubes);
+  arena.reserve(3 * 8 * num_cubes, 4 * 12 * num_cubes);
+  const double step = 1.0 - overlap;
+  int c = 0;
+  for (int iz = 0; iz < n; ++iz) {
+    for (int iy = 0; iy < n; ++iy) {
+      for (int ix = 0; ix < n; ++ix) {
+        double3 center(ix * step, iy * step, iz * step);
+        fill_cube_data(
+            center, 1.0, MutableSpan<Face *>(tris.begin() + 12 * c, 12), 8 * c, 12 * c, &arena);
+        c++;
+      }
+    }
+  }
+  IMesh mesh(tris);
+  double time_create = PIL_check_seconds_timer();
+  // write_obj_mesh(mesh, "cubelattice_in");
+  IMesh out;
+  if (use_self) {
+    out = trimesh_self_intersect(mesh, &arena);
+  }
+  else {
+    out = trimesh_nary_intersect(
+        mesh, num_cubes, [](int t) { return t / 12; }, false, &arena);
+  }
+  double time_intersect = PIL_check_seconds_timer();
+  std::cout << "Create time: " << time_create - time_start << "\n";
+  std::cout << "Intersect time: " << time_intersect - time_create << "\n";
+  std::cout << "Total time: " << time_intersect - time_start << "\n";
+  if (DO_OBJ) {
+    write_obj_mesh(out, "cubelattice");
+  }
+  BLI_task_scheduler_exit();
+}
+
 TEST(mesh_intersect_perf, SphereSphere)
 {
   spheresphere_test(512, 0.5, false);
@@ -1199,6 +1278,16 @@ TEST(mesh_intersect_perf, GridGridTilt)
   gridgrid_test(8, 2, 4, 2, 0.0, 0.0, 1.0, false);
 }
 
+TEST(mesh_intersect_perf, CubeLattice)
+{
+  cubelattice_test(8, 0.25, false);
+}
+
+TEST(mesh_intersect_perf, CubeLatticeSelf)
+{
+  cubelattice_test(8, 0.25, true);
+}
+
 #  endif
 
 }  // namespace blender::meshintersect::tests
@@ -69,6 +69,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -2151,72 +2152,106 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
-{
-  void *temp = NULL;
-
-  if (bh->len) {
-#ifdef USE_BHEAD_READ_ON_DEMAND
-    BHead *bh_orig = bh;
-#endif
+/**
+ * Reading a struct is split in parts which may read from the file, these have to run on the main
+ * thread, and the conversion of the read data, which can run in parallel for multiple structs.
+ */
+typedef struct ReadStructState {
+  /** Block header, replaced by a fully read copy when its data needs to be converted. */
+  BHead *bh;
+  BHead *bh_orig;
+  const char *blockname;
+  /** The read struct, owned by the caller after #read_struct_end. */
+  void *data;
+  /** The data still needs to be converted by #read_struct_convert. */
+  bool need_convert;
+} ReadStructState;
+
+static void read_struct_begin(FileData *fd,
+                              BHead *bh,
+                              const char *blockname,
+                              ReadStructState *state)
+{
+  state->bh = bh;
+  state->bh_orig = bh;
+  state->blockname = blockname;
+  state->data = NULL;
+  state->need_convert = false;
+
+  if (bh->len == 0) {
+    return;
+  }
 
-    /* switch is based on file dna */
-    if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
-      if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-        bh = blo_bhead_read_full(fd, bh);
-        if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
-          return NULL;
-        }
+  if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+    const bool do_switch_endian = bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN);
+    const char compflag = fd->compflags[bh->SDNAnr];
+    if (do_switch_endian || compflag == SDNA_CMP_NOT_EQUAL) {
+      state->bh = blo_bhead_read_full(fd, bh);
+      if (UNLIKELY(state->bh == NULL)) {
+        fd->flags &= ~FD_FLAGS_FILE_OK;
+        return;
       }
-#endif
-      switch_endian_structs(fd->filesdna, bh);
     }
-
-    if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
-      if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
-#ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
-          }
-        }
-#endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
-      }
-      else {
-        /* SDNA_CMP_EQUAL */
-        temp = MEM_mallocN(bh->len, blockname);
-#ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data) {
-          memcpy(temp, (bh + 1), bh->len);
-        }
-        else {
-          /* Instead of allocating the bhead, then copying it,
-           * read the data from the file directly into the memory. */
-          if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            MEM_freeN(temp);
-            temp = NULL;
-          }
-        }
-#else
-        memcpy(temp, (bh + 1), bh->len);
-#endif
+    else if (compflag == SDNA_CMP_EQUAL) {
+      /* Instead of allocating the bhead, then copying it,
+       * read the data from the file directly into the memory. */
+      state->data = MEM_mallocN(bh->len, blockname);
+      if (UNLIKELY(!blo_bhead_read_data(fd, bh, state->data))) {
+        fd->flags &= ~FD_FLAGS_FILE_OK;
+        MEM_freeN(state->data);
+        state->data = NULL;
       }
+      return;
     }
-
-#ifdef USE_BHEAD_READ_ON_DEMAND
-    if (bh_orig != bh) {
-      MEM_freeN(BHEADN_FROM_BHEAD(bh));
+    else {
+      /* SDNA_CMP_REMOVED */
+      return;
     }
+  }
 #endif
+
+  state->need_convert = true;
+}
+
+/* Doesn't access the file, can be used from multiple threads for different structs. */
+static void read_struct_convert(const FileData *fd, ReadStructState *state)
+{
+  if (!state->need_convert) {
+    return;
+  }
+  BHead *bh = state->bh;
+
+  /* switch is based on file dna */
+  if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    switch_endian_structs(fd->filesdna, bh);
+  }
+
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    state->data = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+  }
+  else if (fd->compflags[bh->SDNAnr] == SDNA_CMP_EQUAL) {
+    state->data = MEM_mallocN(bh->len, state->blockname);
+    memcpy(state->data, (bh + 1), bh->len);
+  }
+}
+
+static void *read_struct_end(ReadStructState *state)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (state->bh != state->bh_orig && state->bh != NULL) {
+    MEM_freeN(BHEADN_FROM_BHEAD(state->bh));
   }
+#endif
+  return state->data;
+}
 
-  return temp;
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  ReadStructState state;
+  read_struct_begin(fd, bh, blockname, &state);
+  read_struct_convert(fd, &state);
+  return read_struct_end(&state);
 }
 
 /* Like read_struct, but gets a pointer without allocating. Only works for
@@ -3315,11 +3350,91 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+/* The data of a data-block is converted using multiple threads when there is at least this many
+ * bytes to convert. Otherwise the blocks are read and converted one at a time, which avoids the
+ * threading overhead and keeping all blocks of the data-block in memory at once. */
+#define READ_DATA_PARALLEL_MIN_SIZE (256 * 1024)
+
+typedef struct ReadDataConvertData {
+  const FileData *fd;
+  ReadStructState *states;
+} ReadDataConvertData;
+
+static void read_data_convert_fn(void *__restrict userdata,
+                                 const int index,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadDataConvertData *data = userdata;
+  read_struct_convert(data->fd, &data->states[index]);
+}
+
+/* Check whether the data of the block needs endian switching or DNA reconstruction. */
+static bool read_struct_needs_convert(const FileData *fd, const BHead *bh)
+{
+  if (bh->len == 0) {
+    return false;
+  }
+  if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    return true;
+  }
+  return fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL;
+}
+
+/* Read the data blocks of a datablock into datamap, converting them using multiple threads.
+ * All blocks which need conversion are kept in memory until they are converted. */
+static BHead *read_data_into_datamap_threaded(FileData *fd,
+                                              BHead *bhead,
+                                              const int blocks_len,
+                                              const char *allocname)
+{
+  ReadStructState *states = MEM_malloc_arrayN(blocks_len, sizeof(*states), __func__);
+
+  /* Read the data which needs it from the file, this can't be done from threads. */
+  for (int i = 0; i < blocks_len; i++) {
+    read_struct_begin(fd, bhead, allocname, &states[i]);
+    bhead = blo_bhead_next(fd, bhead);
+  }
+
+  /* Endian switching and DNA reconstruction of the blocks are independent of each other. */
+  ReadDataConvertData data = {
+      .fd = fd,
+      .states = states,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, blocks_len, &data, read_data_convert_fn, &settings);
+
+  /* Insert in file order, so the mapping doesn't depend on the order the threads finished. */
+  for (int i = 0; i < blocks_len; i++) {
+    void *data_new = read_struct_end(&states[i]);
+    if (data_new) {
+      oldnewmap_insert(fd->datamap, states[i].bh_orig->old, data_new, 0);
+    }
+  }
+
+  MEM_freeN(states);
+
+  return bhead;
+}
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+  /* Only the block headers are read here, the data is read on demand. */
+  int blocks_len = 0;
+  size_t convert_size = 0;
+  for (BHead *bh = bhead; bh && bh->code == DATA; bh = blo_bhead_next(fd, bh)) {
+    if (read_struct_needs_convert(fd, bh)) {
+      convert_size += (size_t)bh->len;
+    }
+    blocks_len++;
+  }
+  if (convert_size >= READ_DATA_PARALLEL_MIN_SIZE && blocks_len > 1) {
+    return read_data_into_datamap_threaded(fd, bhead, blocks_len, allocname);
+  }
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -3348,6 +3463,237 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
   return bhead;
 }
 
+/* Reading ahead: while the main thread links a data-block, worker threads convert the data
+ * blocks of the data-blocks following it. The data-blocks are handled in batches: the blocks of
+ * the next batch are read from the file and their conversion is started before the current batch
+ * is linked. Reading from the file itself stays on the main thread.
+ *
+ * Only used when reading all data-blocks of a file in order (see #blo_read_file_internal), not
+ * for undo or when linking from libraries. */
+
+/* Stop adding data-blocks to a batch once it has this many bytes of data. */
+#define READ_AHEAD_BATCH_SIZE (4 * 1024 * 1024)
+#define READ_AHEAD_BATCH_IDS_MAX 256
+/* Blocks are converted in tasks of at least this many bytes. */
+#define READ_AHEAD_TASK_SIZE (64 * 1024)
+
+typedef struct ReadAheadID {
+  /** Block header of the data-block. */
+  BHead *bhead;
+  /** Block header following the data blocks of the data-block. */
+  BHead *bhead_next;
+  /** Data blocks of the data-block in #ReadAheadBatch.states. */
+  int states_start;
+  int states_len;
+} ReadAheadID;
+
+typedef struct ReadAheadBatch {
+  ReadAheadID ids[READ_AHEAD_BATCH_IDS_MAX];
+  int ids_len;
+  /** Data-blocks before this one were used or skipped. */
+  int ids_used;
+  ReadStructState *states;
+  /** Where the next batch starts, NULL at the end of the file. */
+  BHead *bhead_end;
+  /** Converts the blocks, NULL when there is nothing to convert or it finished. Each batch gets
+   * a new pool, without TBB a background pool can't be used again after waiting for it. */
+  TaskPool *pool;
+} ReadAheadBatch;
+
+typedef struct ReadAhead {
+  /** Batch which is converted, its data-blocks are used by #read_libblock. */
+  ReadAheadBatch *current;
+  /** Batch which is being converted by the worker threads. */
+  ReadAheadBatch *next;
+  ReadAheadBatch batches[2];
+} ReadAhead;
+
+typedef struct ReadAheadTaskData {
+  ReadStructState *states;
+  int states_len;
+} ReadAheadTaskData;
+
+static void read_ahead_convert_task(TaskPool *__restrict pool, void *taskdata)
+{
+  const FileData *fd = BLI_task_pool_user_data(pool);
+  ReadAheadTaskData *data = taskdata;
+  for (int i = 0; i < data->states_len; i++) {
+    read_struct_convert(fd, &data->states[i]);
+  }
+}
+
+/* Blocks which #blo_read_file_internal reads as data-blocks, with #read_libblock. */
+static bool read_ahead_is_id_code(const int code)
+{
+  return !ELEM(code, DATA, DNA1, TEST, REND, GLOB, USER, ENDB, ID_LINK_PLACEHOLDER);
+}
+
+/* Read the data blocks of the data-blocks starting at bhead into the next batch, and start
+ * converting them. */
+static void read_ahead_batch_begin(FileData *fd, ReadAhead *ra, BHead *bhead)
+{
+  ReadAheadBatch *batch = ra->next;
+  BLI_assert(batch->ids_len == 0);
+
+  /* Only the block headers are read here, the data is read on demand. */
+  int states_len = 0;
+  size_t batch_size = 0;
+  while (bhead && bhead->code != ENDB && batch->ids_len < READ_AHEAD_BATCH_IDS_MAX &&
+         batch_size < READ_AHEAD_BATCH_SIZE) {
+    if (!read_ahead_is_id_code(bhead->code)) {
+      bhead = blo_bhead_next(fd, bhead);
+      continue;
+    }
+    ReadAheadID *id = &batch->ids[batch->ids_len++];
+    id->bhead = bhead;
+    id->states_start = states_len;
+    id->states_len = 0;
+    for (bhead = blo_bhead_next(fd, bhead); bhead && bhead->code == DATA;
+         bhead = blo_bhead_next(fd, bhead)) {
+      batch_size += (size_t)bhead->len;
+      id->states_len++;
+    }
+    id->bhead_next = bhead;
+    states_len += id->states_len;
+  }
+  batch->bhead_end = (bhead && bhead->code != ENDB) ? bhead : NULL;
+
+  if (states_len == 0) {
+    return;
+  }
+
+  batch->states = MEM_malloc_arrayN(states_len, sizeof(*batch->states), __func__);
+  for (int i = 0; i < batch->ids_len; i++) {
+    ReadAheadID *id = &batch->ids[i];
+    /* The file identifier of screens is patched later, see #blo_read_file_internal. */
+    const char *allocname = dataname((id->bhead->code == ID_SCRN) ? ID_SCR : id->bhead->code);
+    BHead *bh = blo_bhead_next(fd, id->bhead);
+    for (int j = 0; j < id->states_len; j++) {
+      read_struct_begin(fd, bh, allocname, &batch->states[id->states_start + j]);
+      bh = blo_bhead_next(fd, bh);
+    }
+  }
+
+  int task_start = 0;
+  size_t task_size = 0;
+  for (int i = 0; i < states_len; i++) {
+    const ReadStructState *state = &batch->states[i];
+    if (state->need_convert) {
+      task_size += (size_t)state->bh->len;
+    }
+    if (task_size >= READ_AHEAD_TASK_SIZE || (i == states_len - 1 && task_size > 0)) {
+      ReadAheadTaskData *data = MEM_mallocN(sizeof(*data), __func__);
+      data->states = &batch->states[task_start];
+      data->states_len = i + 1 - task_start;
+      if (batch->pool == NULL) {
+        batch->pool = BLI_task_pool_create_background(fd, TASK_PRIORITY_HIGH);
+      }
+      BLI_task_pool_push(batch->pool, read_ahead_convert_task, data, true, NULL);
+      task_start = i + 1;
+      task_size = 0;
+    }
+  }
+}
+
+static void read_ahead_batch_wait(ReadAheadBatch *batch)
+{
+  if (batch->pool) {
+    BLI_task_pool_work_and_wait(batch->pool);
+    BLI_task_pool_free(batch->pool);
+    batch->pool = NULL;
+  }
+}
+
+static void read_ahead_id_discard(ReadAheadBatch *batch, const ReadAheadID *id)
+{
+  for (int i = 0; i < id->states_len; i++) {
+    void *data = read_struct_end(&batch->states[id->states_start + i]);
+    MEM_SAFE_FREE(data);
+  }
+}
+
+/* Free the data of the data-blocks of the batch which were not used. */
+static void read_ahead_batch_clear(ReadAheadBatch *batch)
+{
+  read_ahead_batch_wait(batch);
+  for (int i = batch->ids_used; i < batch->ids_len; i++) {
+    read_ahead_id_discard(batch, &batch->ids[i]);
+  }
+  MEM_SAFE_FREE(batch->states);
+  batch->ids_len = 0;
+  batch->ids_used = 0;
+  batch->bhead_end = NULL;
+}
+
+/* Wait for the next batch to be converted and make it the current one, then start reading the
+ * batch after it. */
+static void read_ahead_batch_next(FileData *fd, ReadAhead *ra, BHead *bhead)
+{
+  read_ahead_batch_clear(ra->current);
+  if (ra->next->ids_len == 0) {
+    read_ahead_batch_begin(fd, ra, bhead);
+  }
+  read_ahead_batch_wait(ra->next);
+  SWAP(ReadAheadBatch *, ra->current, ra->next);
+  if (ra->current->bhead_end) {
+    read_ahead_batch_begin(fd, ra, ra->current->bhead_end);
+  }
+}
+
+static ReadAhead *read_ahead_create(void)
+{
+  ReadAhead *ra = MEM_callocN(sizeof(*ra), __func__);
+  ra->current = &ra->batches[0];
+  ra->next = &ra->batches[1];
+  return ra;
+}
+
+static void read_ahead_free(ReadAhead *ra)
+{
+  read_ahead_batch_clear(ra->current);
+  read_ahead_batch_clear(ra->next);
+  MEM_freeN(ra);
+}
+
+/**
+ * Like #read_data_into_datamap, using the data blocks which were read ahead.
+ * Returns false when the data-block at \a r_bhead was not read ahead.
+ */
+static bool read_ahead_data_into_datamap(FileData *fd, ReadAhead *ra, BHead **r_bhead)
+{
+  BHead *bhead = *r_bhead;
+
+  /* Data-blocks are used in file order, skip the ones #read_libblock didn't read the data of
+   * (like unknown data-block types). Three attempts cover the current batch, the batch after it,
+   * and starting again at bhead. */
+  for (int attempt = 0; attempt < 3; attempt++) {
+    ReadAheadBatch *batch = ra->current;
+    while (batch->ids_used < batch->ids_len) {
+      ReadAheadID *id = &batch->ids[batch->ids_used];
+      if (id->bhead != bhead) {
+        read_ahead_id_discard(batch, id);
+        batch->ids_used++;
+        continue;
+      }
+
+      /* Insert in file order, so the mapping doesn't depend on the order the threads finished. */
+      for (int j = 0; j < id->states_len; j++) {
+        ReadStructState *state = &batch->states[id->states_start + j];
+        void *data = read_struct_end(state);
+        if (data) {
+          oldnewmap_insert(fd->datamap, state->bh_orig->old, data, 0);
+        }
+      }
+      batch->ids_used++;
+      *r_bhead = id->bhead_next;
+      return true;
+    }
+    read_ahead_batch_next(fd, ra, bhead);
+  }
+
+  return false;
+}
+
 /* Verify if the datablock and all associated data is identical. */
 static bool read_libblock_is_identical(FileData *fd, BHead *bhead)
 {
@@ -3671,7 +4017,9 @@ static BHead *read_libblock(FileData *fd,
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   const char *allocname = dataname(idcode);
-  bhead = read_data_into_datamap(fd, bhead, allocname);
+  if (fd->read_ahead == NULL || !read_ahead_data_into_datamap(fd, fd->read_ahead, &bhead)) {
+    bhead = read_data_into_datamap(fd, bhead, allocname);
+  }
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
 
@@ -4091,6 +4439,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  /* Convert the data of upcoming data-blocks while linking, with a single thread this would
+   * only delay the conversion. */
+  if (fd->memfile == NULL && (fd->skip_flags & BLO_READ_SKIP_DATA) == 0 &&
+      BLI_task_scheduler_num_threads() > 1) {
+    fd->read_ahead = read_ahead_create();
+  }
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -4142,6 +4497,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  if (fd->read_ahead) {
+    read_ahead_free(fd->read_ahead);
+    fd->read_ahead = NULL;
+  }
+
   /* do before read_libraries, but skip undo case */
   if (fd->memfile == NULL) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -129,6 +129,9 @@ typedef struct FileData {
   struct BHeadSort *bheadmap;
   int tot_bheadmap;
 
+  /** Converts the data of upcoming data-blocks while reading the file, may be NULL. */
+  struct ReadAhead *read_ahead;
+
   /** See: #USE_GHASH_BHEAD. */
   struct GHash *bhead_idname_hash;
 
@@ -1671,5 +1671,25 @@ void blo_do_versions_290(FileData *fd, Library *UNUSED(lib), Main *bmain)
    */
   {
     /* Keep this block, even when empty. */
+
+    if (!DNA_struct_elem_find(
+            fd->filesdna, "FluidDomainSettings", "short", "cache_prefetch_frames")) {
+      LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+        LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+          if (md->type == eModifierType_Fluid) {
+            FluidModifierData *fmd = (FluidModifierData *)md;
+            if (fmd->domain != NULL) {
+              fmd->domain->cache_prefetch_frames = 10;
+            }
+          }
+        }
+      }
+    }
+
+    if (!DNA_struct_elem_find(fd->filesdna, "Object", "ushort", "playback_cache_memory")) {
+      LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+        ob->playback_cache_memory = 1024;
+      }
+    }
   }
 }
@@ -0,0 +1,144 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_timeit.hh"
+#include "BLI_utildefines.h"
+
+#include "bmesh.h"
+#include "bmesh_tools.h"
+
+/* Height of the smooth surface the test grids are sampled from. */
+static float surface_height(const float x, const float y)
+{
+  return sinf(x * 0.1f) * cosf(y * 0.07f) * 4.0f;
+}
+
+/* Triangulated grid of `res * res` quads sampled from #surface_height. */
+static BMesh *bm_surface_grid_create(const int res)
+{
+  BMeshCreateParams bm_params = {};
+  bm_params.use_toolflags = false;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+  const int res_verts = res + 1;
+  BMVert **verts = (BMVert **)MEM_mallocN(sizeof(*verts) * res_verts * res_verts, __func__);
+  for (int y = 0; y < res_verts; y++) {
+    for (int x = 0; x < res_verts; x++) {
+      const float co[3] = {(float)x, (float)y, surface_height((float)x, (float)y)};
+      verts[y * res_verts + x] = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+    }
+  }
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      BMVert *tri_a[3] = {
+          verts[y * res_verts + x],
+          verts[y * res_verts + x + 1],
+          verts[(y + 1) * res_verts + x + 1],
+      };
+      BMVert *tri_b[3] = {
+          verts[y * res_verts + x],
+          verts[(y + 1) * res_verts + x + 1],
+          verts[(y + 1) * res_verts + x],
+      };
+      BM_face_create_verts(bm, tri_a, 3, nullptr, BM_CREATE_NOP, true);
+      BM_face_create_verts(bm, tri_b, 3, nullptr, BM_CREATE_NOP, true);
+    }
+  }
+  MEM_freeN(verts);
+
+  BM_mesh_normals_update(bm);
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  return bm;
+}
+
+/* One sided Hausdorff distance from the decimated vertices to the source surface. */
+static float surface_distance_max(BMesh *bm)
+{
+  float dist_max = 0.0f;
+  BMIter iter;
+  BMVert *v;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    dist_max = max_ff(dist_max, fabsf(v->co[2] - surface_height(v->co[0], v->co[1])));
+  }
+  return dist_max;
+}
+
+TEST(bmesh_decimate, Collapse)
+{
+  /* Enough vertices for quadrics and costs to be calculated multi-threaded (see #BM_OMP_LIMIT). */
+  BMesh *bm = bm_surface_grid_create(128);
+  const float factor = 0.1f;
+  const int face_tot_target = (int)(bm->totface * factor);
+
+  float min[3], max[3];
+  INIT_MINMAX(min, max);
+  BMIter iter;
+  BMVert *v;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    minmax_v3v3_v3(min, max, v->co);
+  }
+
+  BM_mesh_decimate_collapse(bm, factor, nullptr, 1.0f, false, -1, 0.0f);
+
+  EXPECT_LE(bm->totface, face_tot_target);
+  /* Collapsing may remove a few more faces than requested, not many more. */
+  EXPECT_GE(bm->totface, face_tot_target - 4);
+
+  /* Boundaries are weighted so the grid doesn't shrink. */
+  float min_dec[3], max_dec[3];
+  INIT_MINMAX(min_dec, max_dec);
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    minmax_v3v3_v3(min_dec, max_dec, v->co);
+  }
+  EXPECT_V2_NEAR(min_dec, min, 1e-2f);
+  EXPECT_V2_NEAR(max_dec, max, 1e-2f);
+
+  /* Vertices should stay close to the smooth surface. */
+  EXPECT_LT(surface_distance_max(bm), 0.25f);
+
+  BMFace *f;
+  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+    EXPECT_EQ(f->len, 3);
+  }
+
+  BM_mesh_free(bm);
+}
+
+TEST(bmesh_decimate, CollapseReference)
+{
+  /* Results of the single threaded implementation. Quadrics are summed in a different order
+   * when calculated in parallel, so small differences are expected. */
+  BMesh *bm = bm_surface_grid_create(128);
+  BM_mesh_decimate_collapse(bm, 0.1f, nullptr, 1.0f, false, -1, 0.0f);
+  EXPECT_NEAR(bm->totvert, 1694, 2);
+  EXPECT_NEAR(bm->totface, 3275, 4);
+  EXPECT_NEAR(surface_distance_max(bm), 0.0399f, 1e-3f);
+  BM_mesh_free(bm);
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ * Times collapse decimation by mesh size and prints the resulting surface error.
+ */
+#if 0
+TEST(bmesh_decimate, Benchmark)
+{
+  for (const int res : {256, 1024, 2048}) {
+    for (const float factor : {0.1f, 0.01f}) {
+      BMesh *bm = bm_surface_grid_create(res);
+      const std::string name = std::to_string(bm->totface) + " faces, factor " +
+                               std::to_string(factor);
+      {
+        SCOPED_TIMER("Decimate " + name);
+        BM_mesh_decimate_collapse(bm, factor, nullptr, 1.0f, false, -1, 0.0f);
+      }
+      std::cout << "  Hausdorff distance: " << surface_distance_max(bm) << "\n";
+      BM_mesh_free(bm);
+    }
+  }
+}
+#endif
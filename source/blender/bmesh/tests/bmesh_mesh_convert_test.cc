@@ -0,0 +1,174 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_timeit.hh"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+
+#include "bmesh.h"
+
+/* Build a grid of `res * res` quads, with a float layer on vertices to check custom-data. */
+static BMesh *bm_grid_create(const int res)
+{
+  BMeshCreateParams bm_params = {};
+  bm_params.use_toolflags = false;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  BM_data_layer_add(bm, &bm->vdata, CD_PROP_FLOAT);
+  const int cd_float_offset = CustomData_get_offset(&bm->vdata, CD_PROP_FLOAT);
+
+  const int res_verts = res + 1;
+  BMVert **verts = (BMVert **)MEM_mallocN(sizeof(*verts) * res_verts * res_verts, __func__);
+  for (int y = 0; y < res_verts; y++) {
+    for (int x = 0; x < res_verts; x++) {
+      const int i = y * res_verts + x;
+      const float co[3] = {(float)x, (float)y, (float)((x * y) % 7)};
+      verts[i] = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+      BM_ELEM_CD_SET_FLOAT(verts[i], cd_float_offset, (float)i * 0.5f);
+    }
+  }
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      BMVert *quad[4] = {
+          verts[y * res_verts + x],
+          verts[y * res_verts + x + 1],
+          verts[(y + 1) * res_verts + x + 1],
+          verts[(y + 1) * res_verts + x],
+      };
+      BMFace *f = BM_face_create_verts(bm, quad, 4, nullptr, BM_CREATE_NOP, true);
+      f->mat_nr = (short)((x + y) % 3);
+    }
+  }
+  MEM_freeN(verts);
+
+  BM_mesh_normals_update(bm);
+  return bm;
+}
+
+static void mesh_data_free(Mesh *me)
+{
+  CustomData_free(&me->vdata, me->totvert);
+  CustomData_free(&me->edata, me->totedge);
+  CustomData_free(&me->fdata, me->totface);
+  CustomData_free(&me->ldata, me->totloop);
+  CustomData_free(&me->pdata, me->totpoly);
+  MEM_SAFE_FREE(me->mselect);
+}
+
+static void bm_to_mesh(BMesh *bm, Mesh *me)
+{
+  BMeshToMeshParams params = {};
+  params.cd_mask_extra.vmask = CD_MASK_PROP_FLOAT;
+  BM_mesh_bm_to_me(nullptr, bm, me, &params);
+}
+
+static BMesh *bm_from_mesh(const Mesh *me)
+{
+  BMeshCreateParams bm_params = {};
+  bm_params.use_toolflags = false;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+  BMeshFromMeshParams params = {};
+  params.calc_face_normal = true;
+  params.cd_mask_extra.vmask = CD_MASK_PROP_FLOAT;
+  BM_mesh_bm_from_me(bm, me, &params);
+  return bm;
+}
+
+TEST(bmesh_mesh_convert, RoundTrip)
+{
+  /* Enough faces for the conversion to run multi-threaded (see #BM_OMP_LIMIT). */
+  BMesh *bm_src = bm_grid_create(128);
+
+  Mesh me = {{nullptr}};
+  bm_to_mesh(bm_src, &me);
+
+  EXPECT_EQ(me.totvert, bm_src->totvert);
+  EXPECT_EQ(me.totedge, bm_src->totedge);
+  EXPECT_EQ(me.totpoly, bm_src->totface);
+  EXPECT_EQ(me.totloop, bm_src->totloop);
+
+  int loopstart = 0;
+  for (int i = 0; i < me.totpoly; i++) {
+    EXPECT_EQ(me.mpoly[i].loopstart, loopstart);
+    EXPECT_EQ(me.mpoly[i].totloop, 4);
+    loopstart += me.mpoly[i].totloop;
+  }
+
+  BMesh *bm_dst = bm_from_mesh(&me);
+  EXPECT_EQ(bm_dst->totvert, bm_src->totvert);
+  EXPECT_EQ(bm_dst->totedge, bm_src->totedge);
+  EXPECT_EQ(bm_dst->totface, bm_src->totface);
+  EXPECT_EQ(bm_dst->totloop, bm_src->totloop);
+
+  BM_mesh_elem_table_ensure(bm_src, BM_VERT | BM_FACE);
+  BM_mesh_elem_table_ensure(bm_dst, BM_VERT | BM_FACE);
+
+  const int cd_src_offset = CustomData_get_offset(&bm_src->vdata, CD_PROP_FLOAT);
+  const int cd_dst_offset = CustomData_get_offset(&bm_dst->vdata, CD_PROP_FLOAT);
+  ASSERT_NE(cd_dst_offset, -1);
+
+  for (int i = 0; i < bm_src->totvert; i++) {
+    const BMVert *v_src = bm_src->vtable[i];
+    const BMVert *v_dst = bm_dst->vtable[i];
+    EXPECT_V3_NEAR(v_src->co, v_dst->co, 1e-6f);
+    EXPECT_V3_NEAR(v_src->no, v_dst->no, 1e-4f);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT(v_src, cd_src_offset),
+              BM_ELEM_CD_GET_FLOAT(v_dst, cd_dst_offset));
+    EXPECT_EQ(BM_elem_index_get(v_dst), i);
+  }
+
+  for (int i = 0; i < bm_src->totface; i++) {
+    const BMFace *f_src = bm_src->ftable[i];
+    const BMFace *f_dst = bm_dst->ftable[i];
+    EXPECT_EQ(f_src->len, f_dst->len);
+    EXPECT_EQ(f_src->mat_nr, f_dst->mat_nr);
+    EXPECT_V3_NEAR(f_src->no, f_dst->no, 1e-5f);
+
+    const BMLoop *l_src = BM_FACE_FIRST_LOOP(f_src);
+    const BMLoop *l_dst = BM_FACE_FIRST_LOOP(f_dst);
+    for (int j = 0; j < f_src->len; j++, l_src = l_src->next, l_dst = l_dst->next) {
+      EXPECT_EQ(BM_elem_index_get(l_src->v), BM_elem_index_get(l_dst->v));
+    }
+  }
+
+  BM_mesh_free(bm_dst);
+  BM_mesh_free(bm_src);
+  mesh_data_free(&me);
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ * Times entering (Mesh -> BMesh) and exiting (BMesh -> Mesh) edit-mode by mesh size.
+ */
+#if 0
+TEST(bmesh_mesh_convert, Benchmark)
+{
+  for (const int res : {64, 256, 1024, 2048}) {
+    BMesh *bm_src = bm_grid_create(res);
+    Mesh me = {{nullptr}};
+    const std::string size = std::to_string(bm_src->totface) + " faces";
+
+    {
+      SCOPED_TIMER("BMesh -> Mesh " + size);
+      bm_to_mesh(bm_src, &me);
+    }
+    BMesh *bm_dst;
+    {
+      SCOPED_TIMER("Mesh -> BMesh " + size);
+      bm_dst = bm_from_mesh(&me);
+    }
+
+    BM_mesh_free(bm_dst);
+    BM_mesh_free(bm_src);
+    mesh_data_free(&me);
+  }
+}
+#endif
@@ -32,6 +32,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_quadric.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "BKE_customdata.h"
@@ -76,62 +77,98 @@ typedef enum CD_UseFlag {
 /* BMesh Helper Functions
  * ********************** */
 
+static void bm_decim_face_quadric(BMFace *f, Quadric *r_q)
+{
+  float center[3];
+  double plane_db[4];
+
+  BM_face_calc_center_median(f, center);
+  copy_v3db_v3fl(plane_db, f->no);
+  plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+
+  BLI_quadric_from_plane(r_q, plane_db);
+}
+
 /**
- * \param vquadrics: must be calloc'd
+ * Boundary edges add a (heavily weighted) plane perpendicular to their face,
+ * so collapsing doesn't shrink open borders.
+ *
+ * \return false when the edge isn't a boundary or its plane is degenerate.
  */
-static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
+static bool bm_decim_boundary_edge_quadric(BMEdge *e, Quadric *r_q)
 {
-  BMIter iter;
-  BMFace *f;
-  BMEdge *e;
+  if (LIKELY(!BM_edge_is_boundary(e))) {
+    return false;
+  }
 
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_first;
-    BMLoop *l_iter;
+  float edge_vector[3];
+  float edge_plane[3];
+  double edge_plane_db[4];
+  sub_v3_v3v3(edge_vector, e->v2->co, e->v1->co);
 
-    float center[3];
-    double plane_db[4];
-    Quadric q;
+  cross_v3_v3v3(edge_plane, edge_vector, e->l->f->no);
+  copy_v3db_v3fl(edge_plane_db, edge_plane);
 
-    BM_face_calc_center_median(f, center);
-    copy_v3db_v3fl(plane_db, f->no);
-    plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+  if (normalize_v3_db(edge_plane_db) > (double)FLT_EPSILON) {
+    float center[3];
 
-    BLI_quadric_from_plane(&q, plane_db);
+    mid_v3_v3v3(center, e->v1->co, e->v2->co);
 
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(l_iter->v)], &q);
-    } while ((l_iter = l_iter->next) != l_first);
+    edge_plane_db[3] = -dot_v3db_v3fl(edge_plane_db, center);
+    BLI_quadric_from_plane(r_q, edge_plane_db);
+    BLI_quadric_mul(r_q, BOUNDARY_PRESERVE_WEIGHT);
+    return true;
   }
+  return false;
+}
 
-  /* boundary edges */
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    if (UNLIKELY(BM_edge_is_boundary(e))) {
-      float edge_vector[3];
-      float edge_plane[3];
-      double edge_plane_db[4];
-      sub_v3_v3v3(edge_vector, e->v2->co, e->v1->co);
-      f = e->l->f;
-
-      cross_v3_v3v3(edge_plane, edge_vector, f->no);
-      copy_v3db_v3fl(edge_plane_db, edge_plane);
-
-      if (normalize_v3_db(edge_plane_db) > (double)FLT_EPSILON) {
-        Quadric q;
-        float center[3];
+/**
+ * Each vertex gathers the quadrics of its own faces and boundary edges,
+ * so vertices can be handled in parallel without write conflicts.
+ * Face planes are calculated once per corner, this is cheaper than storing them.
+ */
+static void bm_decim_build_quadrics_vert_cb(void *userdata, MempoolIterData *mp_v)
+{
+  Quadric *vquadrics = userdata;
+  BMVert *v = (BMVert *)mp_v;
+  Quadric *v_quadric = &vquadrics[BM_elem_index_get(v)];
 
-        mid_v3_v3v3(center, e->v1->co, e->v2->co);
+  if (v->e == NULL) {
+    return;
+  }
 
-        edge_plane_db[3] = -dot_v3db_v3fl(edge_plane_db, center);
-        BLI_quadric_from_plane(&q, edge_plane_db);
-        BLI_quadric_mul(&q, BOUNDARY_PRESERVE_WEIGHT);
+  BMEdge *e_iter, *e_first;
+  e_iter = e_first = v->e;
+  do {
+    BMLoop *l_iter, *l_first;
+    if ((l_iter = l_first = e_iter->l)) {
+      do {
+        /* Each face using `v` has exactly one loop on `v`, count it once from that loop. */
+        if (l_iter->v == v) {
+          Quadric q;
+          bm_decim_face_quadric(l_iter->f, &q);
+          BLI_quadric_add_qu_qu(v_quadric, &q);
+        }
+      } while ((l_iter = l_iter->radial_next) != l_first);
+    }
 
-        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v1)], &q);
-        BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(e->v2)], &q);
-      }
+    Quadric q;
+    if (bm_decim_boundary_edge_quadric(e_iter, &q)) {
+      BLI_quadric_add_qu_qu(v_quadric, &q);
     }
-  }
+  } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
+}
+
+/**
+ * \param vquadrics: must be calloc'd
+ */
+static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
+{
+  BM_iter_parallel(bm,
+                   BM_VERTS_OF_MESH,
+                   bm_decim_build_quadrics_vert_cb,
+                   vquadrics,
+                   bm->totvert >= BM_OMP_LIMIT);
 }
 
 static void bm_decim_calc_target_co_db(BMEdge *e, double optimize_co[3], const Quadric *vquadrics)
@@ -236,12 +273,16 @@ static float bm_decim_build_edge_cost_single__topology(BMEdge *e)
 
 #endif /* USE_TOPOLOGY_FALLBACK */
 
-static void bm_decim_build_edge_cost_single(BMEdge *e,
-                                            const Quadric *vquadrics,
-                                            const float *vweights,
-                                            const float vweight_factor,
-                                            Heap *eheap,
-                                            HeapNode **eheap_table)
+/**
+ * Calculate the cost of collapsing \a e, only reads the mesh so it's thread-safe.
+ *
+ * \return false when the edge must not be collapsed.
+ */
+static bool bm_decim_edge_cost_calc(BMEdge *e,
+                                    const Quadric *vquadrics,
+                                    const float *vweights,
+                                    const float vweight_factor,
+                                    float *r_cost)
 {
   float cost;
 
@@ -322,10 +363,26 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
     }
   }
 
-  BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
-  return;
+  *r_cost = cost;
+  return true;
 
 clear:
+  return false;
+}
+
+static void bm_decim_build_edge_cost_single(BMEdge *e,
+                                            const Quadric *vquadrics,
+                                            const float *vweights,
+                                            const float vweight_factor,
+                                            Heap *eheap,
+                                            HeapNode **eheap_table)
+{
+  float cost;
+  if (bm_decim_edge_cost_calc(e, vquadrics, vweights, vweight_factor, &cost)) {
+    BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
+    return;
+  }
+
   if (eheap_table[BM_elem_index_get(e)]) {
     BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
   }
@@ -340,6 +397,29 @@ static void bm_decim_invalid_edge_cost_single(BMEdge *e, Heap *eheap, HeapNode *
   eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, COST_INVALID, e);
 }
 
+typedef struct DecimBuildEdgeCostData {
+  const Quadric *vquadrics;
+  const float *vweights;
+  float vweight_factor;
+  /* Edge index aligned, #COST_INVALID for edges that are not added to the heap. */
+  float *ecosts;
+} DecimBuildEdgeCostData;
+
+static void bm_decim_build_edge_cost_cb(void *userdata, MempoolIterData *mp_e)
+{
+  DecimBuildEdgeCostData *data = userdata;
+  BMEdge *e = (BMEdge *)mp_e;
+  float cost;
+  if (!bm_decim_edge_cost_calc(e, data->vquadrics, data->vweights, data->vweight_factor, &cost)) {
+    cost = COST_INVALID;
+  }
+  data->ecosts[BM_elem_index_get(e)] = cost;
+}
+
+/**
+ * Costs are calculated in parallel, then added to the heap in edge order
+ * so the result matches a single threaded build.
+ */
 static void bm_decim_build_edge_cost(BMesh *bm,
                                      const Quadric *vquadrics,
                                      const float *vweights,
@@ -351,11 +431,23 @@ static void bm_decim_build_edge_cost(BMesh *bm,
   BMEdge *e;
   uint i;
 
+  DecimBuildEdgeCostData data = {
+      .vquadrics = vquadrics,
+      .vweights = vweights,
+      .vweight_factor = vweight_factor,
+      .ecosts = MEM_mallocN(sizeof(float) * bm->totedge, __func__),
+  };
+
+  BM_iter_parallel(
+      bm, BM_EDGES_OF_MESH, bm_decim_build_edge_cost_cb, &data, bm->totedge >= BM_OMP_LIMIT);
+
   BM_ITER_MESH_INDEX (e, &iter, bm, BM_EDGES_OF_MESH, i) {
-    /* keep sanity check happy */
-    eheap_table[i] = NULL;
-    bm_decim_build_edge_cost_single(e, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+    BLI_assert(BM_elem_index_get(e) == i);
+    const float cost = data.ecosts[i];
+    eheap_table[i] = (cost != COST_INVALID) ? BLI_heap_insert(eheap, cost, e) : NULL;
   }
+
+  MEM_freeN(data.ecosts);
 }
 
 #ifdef USE_SYMMETRY
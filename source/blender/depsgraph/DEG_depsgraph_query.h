@@ -76,6 +76,10 @@ bool DEG_id_type_any_exists(const struct Depsgraph *depsgraph, short id_type);
 /* Get additional evaluation flags for the given ID. */
 uint32_t DEG_get_eval_flags_for_id(const struct Depsgraph *graph, struct ID *id);
 
+/* Check whether the update of the given ID was caused by a change done by the user, as opposed to
+ * a change of the current frame only. */
+bool DEG_id_is_user_modified(const struct Depsgraph *graph, struct ID *id);
+
 /* Get additional mesh CustomData_MeshMasks flags for the given object. */
 void DEG_get_customdata_mask_for_object(const struct Depsgraph *graph,
                                         struct Object *object,
@@ -36,6 +36,7 @@
 
 #include "BKE_action.h"
 
+#include "intern/builder/deg_builder_batch.h"
 #include "intern/builder/deg_builder_cache.h"
 #include "intern/builder/deg_builder_remove_noop.h"
 #include "intern/depsgraph.h"
@@ -208,6 +209,8 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   /* Make sure dependencies of visible ID datablocks are visible. */
   deg_graph_build_flush_visibility(graph);
   deg_graph_remove_unused_noops(graph);
+  deg_graph_build_batches(graph);
+  graph->need_measure_batches = true;
 
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
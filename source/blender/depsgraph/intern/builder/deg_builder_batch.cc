@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Batching of operations to reduce the overhead of scheduling every operation as a separate task.
+ *
+ * An operation which only depends on a single other operation, directly or through no-op nodes,
+ * can be evaluated right after it in the same task. For the most expensive such child of an
+ * operation (the continuation) this never reduces the amount of parallelism, since the rest of
+ * the children are pushed to the task pool first, so it is always done. This merges linear chains
+ * of operations (which are common in rigs) into single tasks. Other such children are only
+ * batched when they are known to be cheap, using the costs measured during the evaluation after
+ * the graph was built. They are evaluated before the continuation, and their own children are
+ * pushed to the task pool.
+ */
+
+#include "intern/builder/deg_builder_batch.h"
+
+#include "BLI_vector.hh"
+
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_operation.h"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/depsgraph_type.h"
+
+namespace blender::deg {
+
+/* Operations cheaper than this (in seconds) are batched with their siblings. On a rig of 8000
+ * bones 99% of the pose operations measured below 2us, operations doing more work (constraints,
+ * drivers, geometry) measure from 5us up. */
+#define BATCH_CHEAP_OPERATION_TIME 2e-6
+/* Limit of the accumulated cost of cheap operations batched into one task. They are evaluated
+ * before the continuation, so this bounds how much the continuation is delayed, while many cheap
+ * siblings are still spread over multiple threads. */
+#define BATCH_MAX_CHEAP_TIME 20e-6
+
+/* Check whether the given node only depends on the given parent operation, either directly or
+ * through no-op nodes which only depend on the parent. */
+static bool depends_only_on(const OperationNode *parent, const OperationNode *node)
+{
+  for (const Relation *rel : node->inlinks) {
+    if (rel->from->type != NodeType::OPERATION) {
+      continue;
+    }
+    if (rel->flag & RELATION_FLAG_CYCLIC) {
+      return false;
+    }
+    const OperationNode *from = (const OperationNode *)rel->from;
+    if (from != parent && !(from->is_noop() && depends_only_on(parent, from))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool is_cheap_operation(const OperationNode *operation)
+{
+  return operation->eval_cost >= 0.0 && operation->eval_cost < BATCH_CHEAP_OPERATION_TIME;
+}
+
+/* Gather the operations which only depend on the parent. No-op nodes are looked through, since
+ * they are not evaluated in tasks and their children are scheduled right away. */
+static void gather_exclusive_children(OperationNode *parent,
+                                      OperationNode *node,
+                                      Vector<OperationNode *, 16> &r_children)
+{
+  for (Relation *rel : node->outlinks) {
+    OperationNode *child = (OperationNode *)rel->to;
+    BLI_assert(child->type == NodeType::OPERATION);
+    if ((rel->flag & RELATION_FLAG_CYCLIC) || !depends_only_on(parent, child)) {
+      continue;
+    }
+    if (child->is_noop()) {
+      gather_exclusive_children(parent, child, r_children);
+    }
+    else {
+      r_children.append_non_duplicates(child);
+    }
+  }
+}
+
+static int build_batches_for_parent(OperationNode *parent)
+{
+  Vector<OperationNode *, 16> children;
+  gather_exclusive_children(parent, parent, children);
+  if (children.is_empty()) {
+    return 0;
+  }
+
+  /* Continue with the most expensive child in the same task, operations with unknown cost are
+   * considered expensive. */
+  OperationNode *continuation = children[0];
+  for (OperationNode *child : children) {
+    if (child->eval_cost < 0.0) {
+      continuation = child;
+      break;
+    }
+    if (child->eval_cost > continuation->eval_cost) {
+      continuation = child;
+    }
+  }
+  continuation->batch_parent = parent;
+  parent->batch_continuation = continuation;
+  int num_batched = 1;
+
+  double cheap_time = 0.0;
+  for (OperationNode *child : children) {
+    if (child == continuation || !is_cheap_operation(child)) {
+      continue;
+    }
+    if (cheap_time + child->eval_cost > BATCH_MAX_CHEAP_TIME) {
+      continue;
+    }
+    cheap_time += child->eval_cost;
+    child->batch_parent = parent;
+    num_batched++;
+  }
+  return num_batched;
+}
+
+int deg_graph_build_batches(Span<OperationNode *> operations)
+{
+  for (OperationNode *node : operations) {
+    node->batch_parent = nullptr;
+    node->batch_continuation = nullptr;
+  }
+
+  int num_batched = 0;
+  for (OperationNode *node : operations) {
+    /* No-op nodes are not evaluated in tasks, their children are scheduled right away. */
+    if (node->is_noop()) {
+      continue;
+    }
+    num_batched += build_batches_for_parent(node);
+  }
+  return num_batched;
+}
+
+void deg_graph_build_batches(Depsgraph *graph)
+{
+  const int num_batched = deg_graph_build_batches(graph->operations);
+  DEG_DEBUG_PRINTF((::Depsgraph *)graph,
+                   BUILD,
+                   "Batched %d of %d operations into the tasks of their parents\n",
+                   num_batched,
+                   (int)graph->operations.size());
+}
+
+}  // namespace blender::deg
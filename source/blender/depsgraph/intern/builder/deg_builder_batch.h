@@ -0,0 +1,41 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "BLI_span.hh"
+
+namespace blender {
+namespace deg {
+
+struct Depsgraph;
+struct OperationNode;
+
+/* Choose operations which are evaluated in the task of their parent operation, see
+ * OperationNode::batch_parent. Uses the measured operation costs when they are known. */
+void deg_graph_build_batches(Depsgraph *graph);
+/* Same as above for the given operations, returns the number of batched operations. */
+int deg_graph_build_batches(Span<OperationNode *> operations);
+
+}  // namespace deg
+}  // namespace blender
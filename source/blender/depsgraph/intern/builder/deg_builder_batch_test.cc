@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_batch.h"
+
+#include "BLI_vector.hh"
+
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_operation.h"
+
+#include "testing/testing.h"
+
+namespace blender::deg::tests {
+
+class TestGraph {
+ public:
+  Vector<OperationNode *> operations;
+
+  ~TestGraph()
+  {
+    /* Nodes free their incoming relations. */
+    for (OperationNode *node : operations) {
+      delete node;
+    }
+  }
+
+  /* Add an operation with the given cost in seconds, negative when it's unknown. */
+  OperationNode *add_operation(const double eval_cost)
+  {
+    OperationNode *node = add_noop();
+    node->evaluate = [](::Depsgraph * /*depsgraph*/) {};
+    node->eval_cost = eval_cost;
+    return node;
+  }
+
+  OperationNode *add_noop()
+  {
+    OperationNode *node = new OperationNode();
+    /* Set by the node factory in the graph builder. */
+    node->type = NodeType::OPERATION;
+    operations.append(node);
+    return node;
+  }
+
+  void add_relation(OperationNode *from, OperationNode *to)
+  {
+    new Relation(from, to, "Test");
+  }
+};
+
+TEST(deg_builder_batch, chain)
+{
+  TestGraph graph;
+  OperationNode *a = graph.add_operation(-1.0);
+  OperationNode *noop = graph.add_noop();
+  OperationNode *b = graph.add_operation(-1.0);
+  OperationNode *c = graph.add_operation(-1.0);
+  graph.add_relation(a, noop);
+  graph.add_relation(noop, b);
+  graph.add_relation(b, c);
+
+  EXPECT_EQ(deg_graph_build_batches(graph.operations), 2);
+  EXPECT_EQ(a->batch_continuation, b);
+  EXPECT_EQ(b->batch_parent, a);
+  EXPECT_EQ(b->batch_continuation, c);
+  EXPECT_EQ(c->batch_parent, b);
+  EXPECT_EQ(noop->batch_parent, nullptr);
+}
+
+TEST(deg_builder_batch, multiple_parents)
+{
+  TestGraph graph;
+  OperationNode *a = graph.add_operation(1e-6);
+  OperationNode *b = graph.add_operation(1e-6);
+  OperationNode *noop = graph.add_noop();
+  OperationNode *c = graph.add_operation(1e-6);
+  OperationNode *d = graph.add_operation(1e-6);
+  graph.add_relation(a, c);
+  graph.add_relation(b, c);
+  graph.add_relation(a, noop);
+  graph.add_relation(b, noop);
+  graph.add_relation(noop, d);
+
+  EXPECT_EQ(deg_graph_build_batches(graph.operations), 0);
+  EXPECT_EQ(c->batch_parent, nullptr);
+  EXPECT_EQ(d->batch_parent, nullptr);
+}
+
+TEST(deg_builder_batch, siblings)
+{
+  TestGraph graph;
+  OperationNode *parent = graph.add_operation(1e-6);
+  OperationNode *expensive = graph.add_operation(1e-3);
+  OperationNode *medium = graph.add_operation(50e-6);
+  Vector<OperationNode *> cheap;
+  for (int i = 0; i < 20; i++) {
+    OperationNode *node = graph.add_operation(1.5e-6);
+    graph.add_relation(parent, node);
+    cheap.append(node);
+  }
+  graph.add_relation(parent, expensive);
+  graph.add_relation(parent, medium);
+
+  deg_graph_build_batches(graph.operations);
+
+  /* The task of the parent continues with the most expensive child, cheap children are batched
+   * up to a limit, the others are scheduled as separate tasks. */
+  EXPECT_EQ(parent->batch_continuation, expensive);
+  EXPECT_EQ(expensive->batch_parent, parent);
+  EXPECT_EQ(medium->batch_parent, nullptr);
+  int num_cheap_batched = 0;
+  for (OperationNode *node : cheap) {
+    if (node->batch_parent == parent) {
+      num_cheap_batched++;
+    }
+  }
+  EXPECT_GT(num_cheap_batched, 0);
+  EXPECT_LT(num_cheap_batched, (int)cheap.size());
+}
+
+TEST(deg_builder_batch, unknown_cost)
+{
+  TestGraph graph;
+  OperationNode *parent = graph.add_operation(1e-6);
+  OperationNode *measured = graph.add_operation(1e-3);
+  OperationNode *unknown = graph.add_operation(-1.0);
+  graph.add_relation(parent, measured);
+  graph.add_relation(parent, unknown);
+
+  deg_graph_build_batches(graph.operations);
+
+  /* Operations which were not measured yet may be expensive. */
+  EXPECT_EQ(parent->batch_continuation, unknown);
+  EXPECT_EQ(measured->batch_parent, nullptr);
+}
+
+}  // namespace blender::deg::tests
@@ -270,6 +270,7 @@ static void deg_debug_graphviz_relation_color(const Relation *rel, dot::Directed
   const char *color_default = "black";
   const char *color_cyclic = "red4";   /* The color of crime scene. */
   const char *color_godmode = "blue4"; /* The color of beautiful sky. */
+  const char *color_batched = "forestgreen";
   const char *color = color_default;
   if (rel->flag & RELATION_FLAG_CYCLIC) {
     color = color_cyclic;
@@ -277,6 +278,11 @@ static void deg_debug_graphviz_relation_color(const Relation *rel, dot::Directed
   else if (rel->flag & RELATION_FLAG_GODMODE) {
     color = color_godmode;
   }
+  else if (rel->to->get_class() == NodeClass::OPERATION &&
+           ((OperationNode *)rel->to)->batch_parent == rel->from) {
+    /* Child is evaluated in the same task as its parent. */
+    color = color_batched;
+  }
   edge.attributes.set("color", color);
 }
 
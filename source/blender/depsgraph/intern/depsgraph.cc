@@ -62,6 +62,7 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_measure_batches(false),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
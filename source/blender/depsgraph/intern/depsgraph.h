@@ -110,6 +110,10 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Indicates whether the next evaluation is to measure the cost of operations, which is then used
+   * to batch cheap operations into the tasks of their parents. */
+  bool need_measure_batches;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -126,6 +126,16 @@ uint32_t DEG_get_eval_flags_for_id(const Depsgraph *graph, ID *id)
   return id_node->eval_flags;
 }
 
+bool DEG_id_is_user_modified(const Depsgraph *graph, ID *id)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  const deg::IDNode *id_node = deg_graph->find_id_node(DEG_get_original_id(id));
+  if (id_node == nullptr) {
+    return false;
+  }
+  return id_node->is_user_modified;
+}
+
 void DEG_get_customdata_mask_for_object(const Depsgraph *graph,
                                         Object *ob,
                                         CustomData_MeshMasks *r_mask)
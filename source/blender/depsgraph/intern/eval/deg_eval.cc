@@ -31,6 +31,7 @@
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -43,6 +44,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/builder/deg_builder_batch.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
@@ -93,6 +95,8 @@ enum class EvaluationStage {
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  /* Store evaluation time of operations in OperationNode::eval_cost. */
+  bool do_measure_cost;
   EvaluationStage stage;
   bool need_single_thread_pass;
 };
@@ -104,27 +108,77 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_stats || state->do_measure_cost) {
     const double start_time = PIL_check_seconds_timer();
     operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    const double eval_time = PIL_check_seconds_timer() - start_time;
+    if (state->do_stats) {
+      operation_node->stats.current_time += eval_time;
+    }
+    if (state->do_measure_cost) {
+      operation_node->eval_cost = eval_time;
+    }
   }
   else {
     operation_node->evaluate(depsgraph);
   }
 }
 
+/* Operations which became ready after evaluating an operation of a task. */
+struct DepsgraphTaskBatch {
+  TaskPool *pool;
+  /* Operation whose children are being scheduled. */
+  OperationNode *parent;
+  /* Cheap children which are evaluated in the current task, see OperationNode::batch_parent. */
+  Vector<OperationNode *, 16> cheap_nodes;
+  /* Child which is evaluated in the current task after the cheap ones. */
+  OperationNode *continuation;
+};
+
+void schedule_node_to_batch(OperationNode *node,
+                            const int UNUSED(thread_id),
+                            DepsgraphTaskBatch *batch)
+{
+  if (node->batch_parent != batch->parent) {
+    BLI_task_pool_push(batch->pool, deg_task_run_func, node, false, nullptr);
+  }
+  else if (node == batch->parent->batch_continuation) {
+    batch->continuation = node;
+  }
+  else {
+    batch->cheap_nodes.append(node);
+  }
+}
+
 void deg_task_run_func(TaskPool *pool, void *taskdata)
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
+  DepsgraphTaskBatch batch;
+  batch.pool = pool;
+
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  while (operation_node != nullptr) {
+    /* Evaluate node. */
+    evaluate_node(state, operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+    /* Schedule children, the ones which are not batched with this node are pushed to the pool
+     * first, so other threads can pick them up. */
+    batch.parent = operation_node;
+    batch.continuation = nullptr;
+    batch.cheap_nodes.clear();
+    schedule_children(state, operation_node, schedule_node_to_batch, &batch);
+
+    /* Evaluate the cheap children, only the continuation is followed further in this task so
+     * the chains below the cheap children can run in parallel with it. */
+    for (OperationNode *cheap_node : batch.cheap_nodes) {
+      evaluate_node(state, cheap_node);
+      schedule_children(state, cheap_node, schedule_node_to_pool, pool);
+    }
+
+    operation_node = batch.continuation;
+  }
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -378,6 +432,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   DepsgraphEvalState state;
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
+  state.do_measure_cost = graph->need_measure_batches;
   state.need_single_thread_pass = false;
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
@@ -408,6 +463,11 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  /* Batch cheap operations now that their cost is known. */
+  if (state.do_measure_cost) {
+    deg_graph_build_batches(graph);
+    graph->need_measure_batches = false;
+  }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
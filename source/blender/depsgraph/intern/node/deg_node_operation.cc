@@ -209,7 +209,12 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : name_tag(-1),
+      flag(0),
+      batch_parent(nullptr),
+      batch_continuation(nullptr),
+      eval_cost(-1.0)
 {
 }
 
@@ -273,6 +273,16 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* Operation which evaluates this one in its own task once it's ready, instead of pushing it to
+   * the task pool. Set by deg_graph_build_batches(). */
+  OperationNode *batch_parent;
+  /* The child which this operation's task continues with after evaluating the other batched
+   * children. Children of those are pushed to the task pool again. */
+  OperationNode *batch_continuation;
+
+  /* Measured evaluation time in seconds, negative when it was not measured yet. */
+  double eval_cost;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -600,6 +600,15 @@ typedef struct SculptUndoNodeGeometry {
   int totpoly;
 } SculptUndoNodeGeometry;
 
+/* Maximum number of arrays of a #SculptUndoNode that are compressed. */
+#define SCULPT_UNDO_COMPRESSED_ARRAYS 2
+
+typedef struct SculptUndoCompressedArray {
+  void *data;
+  size_t size;
+  size_t uncompressed_size;
+} SculptUndoCompressedArray;
+
 typedef struct SculptUndoNode {
   struct SculptUndoNode *next, *prev;
 
@@ -615,6 +624,10 @@ typedef struct SculptUndoNode {
   float *mask;
   int totvert;
 
+  /* Compressed copies of the co and orig_co, mask or col arrays once the undo step is finished,
+   * the arrays themselves are freed then (see #sculpt_undo_compress_begin). */
+  SculptUndoCompressedArray compressed[SCULPT_UNDO_COMPRESSED_ARRAYS];
+
   /* non-multires */
   int maxvert; /* to verify if totvert it still the same */
   int *index;  /* to restore into right location */
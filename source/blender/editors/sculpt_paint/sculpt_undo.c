@@ -70,6 +70,10 @@
 #include "bmesh.h"
 #include "sculpt_intern.h"
 
+#include "atomic_ops.h"
+
+#include <zlib.h>
+
 /* Implementation of undo system for objects in sculpt mode.
  *
  * Each undo step in sculpt mode consists of list of nodes, each node contains:
@@ -107,12 +111,21 @@
  * does modifications on it.
  *
  * End of dynamic topology and symmetrize in this mode are handled in a special
- * manner as well. */
+ * manner as well.
+ *
+ * Once a step is finished the arrays of COORDS, MASK and COLOR nodes are compressed in the
+ * background, and only decompressed when the step is restored or its nodes are accessed again.
+ * A step that was decompressed for access is compressed again when the next step is pushed. */
 
 typedef struct UndoSculpt {
   ListBase nodes;
 
   size_t undo_size;
+
+  /* Background compression of the nodes, NULL when it's not running. */
+  TaskPool *compress_pool;
+  /* Nodes were handed to compression, they have to be decompressed before they are accessed. */
+  bool is_compressed;
 } UndoSculpt;
 
 static UndoSculpt *sculpt_undo_get_nodes(void);
@@ -859,6 +872,11 @@ static void sculpt_undo_free_list(ListBase *lb)
     if (unode->co) {
       MEM_freeN(unode->co);
     }
+    for (int slot = 0; slot < SCULPT_UNDO_COMPRESSED_ARRAYS; slot++) {
+      if (unode->compressed[slot].data) {
+        MEM_freeN(unode->compressed[slot].data);
+      }
+    }
     if (unode->no) {
       MEM_freeN(unode->no);
     }
@@ -1433,6 +1451,198 @@ void SCULPT_undo_push_end_ex(const bool use_nested_undo)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compressed Storage
+ *
+ * Each element is delta encoded against the previous element of the node first. Vertices of a
+ * node (and grid elements in particular) are close to each other, so this leaves mostly small
+ * values, which are zigzag encoded and split into byte planes so the codec sees long runs of
+ * zero bytes. The result is compressed with the fastest zlib level.
+ *
+ * Since restoring swaps the stored values with the mesh, nodes are compressed again after
+ * they have been restored.
+ * \{ */
+
+/* Returns the array of the node that is compressed into the given slot of
+ * #SculptUndoNode.compressed, and its number of floats per element. */
+static float **sculpt_undo_node_compress_array(SculptUndoNode *unode, int slot, int *r_stride)
+{
+  if (slot == 1) {
+    *r_stride = 3;
+    return (unode->type == SCULPT_UNDO_COORDS) ? (float **)&unode->orig_co : NULL;
+  }
+
+  switch (unode->type) {
+    case SCULPT_UNDO_COORDS:
+      *r_stride = 3;
+      return (float **)&unode->co;
+    case SCULPT_UNDO_MASK:
+      *r_stride = 1;
+      return &unode->mask;
+    case SCULPT_UNDO_COLOR:
+      *r_stride = 4;
+      return (float **)&unode->col;
+    default:
+      *r_stride = 0;
+      return NULL;
+  }
+}
+
+static void sculpt_undo_delta_encode(const uint32_t *src, uchar *dst, size_t num, int stride)
+{
+  for (size_t i = 0; i < num; i++) {
+    const int32_t delta = (int32_t)((i < (size_t)stride) ? src[i] : src[i] - src[i - stride]);
+    const uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    dst[i] = (uchar)zigzag;
+    dst[i + num] = (uchar)(zigzag >> 8);
+    dst[i + num * 2] = (uchar)(zigzag >> 16);
+    dst[i + num * 3] = (uchar)(zigzag >> 24);
+  }
+}
+
+static void sculpt_undo_delta_decode(const uchar *src, uint32_t *dst, size_t num, int stride)
+{
+  for (size_t i = 0; i < num; i++) {
+    const uint32_t zigzag = (uint32_t)src[i] | ((uint32_t)src[i + num] << 8) |
+                            ((uint32_t)src[i + num * 2] << 16) |
+                            ((uint32_t)src[i + num * 3] << 24);
+    const uint32_t delta = (zigzag >> 1) ^ -(zigzag & 1);
+    dst[i] = (i < (size_t)stride) ? delta : dst[i - stride] + delta;
+  }
+}
+
+static void sculpt_undo_node_compress_array_slot(UndoSculpt *usculpt,
+                                                 SculptUndoNode *unode,
+                                                 int slot)
+{
+  SculptUndoCompressedArray *compressed_array = &unode->compressed[slot];
+  int stride;
+  float **array = sculpt_undo_node_compress_array(unode, slot, &stride);
+  if (array == NULL || *array == NULL) {
+    return;
+  }
+  const size_t size = MEM_allocN_len(*array);
+
+  uchar *encoded = MEM_mallocN(size, __func__);
+  sculpt_undo_delta_encode((const uint32_t *)*array, encoded, size / sizeof(float), stride);
+
+  uLongf compressed_size = compressBound(size);
+  Bytef *compressed = MEM_mallocN(compressed_size, __func__);
+  const int result = compress2(compressed, &compressed_size, encoded, size, Z_BEST_SPEED);
+  MEM_freeN(encoded);
+
+  if (result != Z_OK || compressed_size >= size) {
+    /* Keep the array as it is. */
+    MEM_freeN(compressed);
+    return;
+  }
+
+  compressed_array->data = MEM_reallocN(compressed, compressed_size);
+  compressed_array->size = compressed_size;
+  compressed_array->uncompressed_size = size;
+  MEM_freeN(*array);
+  *array = NULL;
+
+  atomic_sub_and_fetch_z(&usculpt->undo_size, size - compressed_size);
+}
+
+static void sculpt_undo_node_compress_task(TaskPool *__restrict pool, void *taskdata)
+{
+  UndoSculpt *usculpt = BLI_task_pool_user_data(pool);
+  SculptUndoNode *unode = taskdata;
+  for (int slot = 0; slot < SCULPT_UNDO_COMPRESSED_ARRAYS; slot++) {
+    sculpt_undo_node_compress_array_slot(usculpt, unode, slot);
+  }
+}
+
+static void sculpt_undo_node_decompress_array_slot(UndoSculpt *usculpt,
+                                                   SculptUndoNode *unode,
+                                                   int slot)
+{
+  SculptUndoCompressedArray *compressed_array = &unode->compressed[slot];
+  if (compressed_array->data == NULL) {
+    return;
+  }
+
+  int stride;
+  float **array = sculpt_undo_node_compress_array(unode, slot, &stride);
+  const size_t size = compressed_array->uncompressed_size;
+
+  uchar *encoded = MEM_mallocN(size, __func__);
+  uLongf uncompressed_size = size;
+  const int result = uncompress(
+      encoded, &uncompressed_size, compressed_array->data, compressed_array->size);
+  BLI_assert(result == Z_OK && uncompressed_size == size);
+  UNUSED_VARS_NDEBUG(result);
+
+  *array = MEM_mallocN(size, "SculptUndoNode decompressed");
+  sculpt_undo_delta_decode(encoded, (uint32_t *)*array, size / sizeof(float), stride);
+  MEM_freeN(encoded);
+
+  atomic_add_and_fetch_z(&usculpt->undo_size, size - compressed_array->size);
+  MEM_freeN(compressed_array->data);
+  compressed_array->data = NULL;
+  compressed_array->size = 0;
+  compressed_array->uncompressed_size = 0;
+}
+
+static void sculpt_undo_node_decompress_cb(void *__restrict userdata,
+                                           void *item,
+                                           int UNUSED(index),
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UndoSculpt *usculpt = userdata;
+  SculptUndoNode *unode = item;
+  for (int slot = 0; slot < SCULPT_UNDO_COMPRESSED_ARRAYS; slot++) {
+    sculpt_undo_node_decompress_array_slot(usculpt, unode, slot);
+  }
+}
+
+/* Start compressing the nodes in the background, the nodes can't be accessed until
+ * #sculpt_undo_compress_end is called. */
+static void sculpt_undo_compress_begin(UndoSculpt *usculpt)
+{
+  BLI_assert(usculpt->compress_pool == NULL);
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    int stride;
+    float **array = sculpt_undo_node_compress_array(unode, 0, &stride);
+    if (array == NULL || *array == NULL) {
+      continue;
+    }
+    if (usculpt->compress_pool == NULL) {
+      usculpt->compress_pool = BLI_task_pool_create_background(usculpt, TASK_PRIORITY_LOW);
+      usculpt->is_compressed = true;
+    }
+    BLI_task_pool_push(usculpt->compress_pool, sculpt_undo_node_compress_task, unode, false, NULL);
+  }
+}
+
+/* Wait for background compression to finish. */
+static void sculpt_undo_compress_end(UndoSculpt *usculpt)
+{
+  if (usculpt->compress_pool) {
+    BLI_task_pool_work_and_wait(usculpt->compress_pool);
+    BLI_task_pool_free(usculpt->compress_pool);
+    usculpt->compress_pool = NULL;
+  }
+}
+
+static void sculpt_undo_decompress(UndoSculpt *usculpt)
+{
+  if (!usculpt->is_compressed) {
+    return;
+  }
+  usculpt->is_compressed = false;
+  sculpt_undo_compress_end(usculpt);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_listbase(&usculpt->nodes, usculpt, sculpt_undo_node_decompress_cb, &settings);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  * \{ */
@@ -1443,6 +1653,33 @@ typedef struct SculptUndoStep {
   UndoSculpt data;
 } SculptUndoStep;
 
+/* Compression finishes in the background, so the actual size of steps is only known later.
+ * Update the sizes of all sculpt steps up to this one, for the undo memory limit. */
+static void sculpt_undosys_step_data_size_update(UndoStep *us_p)
+{
+  for (UndoStep *us_iter = us_p; us_iter; us_iter = us_iter->prev) {
+    if (us_iter->type == us_p->type) {
+      SculptUndoStep *us = (SculptUndoStep *)us_iter;
+      us->step.data_size = atomic_add_and_fetch_z(&us->data.undo_size, 0);
+    }
+  }
+}
+
+/* The previous sculpt step may have been decompressed because its nodes were accessed (see
+ * #sculpt_undo_get_nodes), they are not used anymore once a new step is pushed. */
+static void sculpt_undosys_step_recompress_previous(UndoStep *us_p)
+{
+  for (UndoStep *us_iter = us_p->prev; us_iter; us_iter = us_iter->prev) {
+    if (us_iter->type == us_p->type) {
+      SculptUndoStep *us = (SculptUndoStep *)us_iter;
+      if (!us->data.is_compressed) {
+        sculpt_undo_compress_begin(&us->data);
+      }
+      break;
+    }
+  }
+}
+
 static void sculpt_undosys_step_encode_init(struct bContext *UNUSED(C), UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
@@ -1457,7 +1694,9 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
   /* Dummy, encoding is done along the way by adding tiles
    * to the current 'SculptUndoStep' added by encode_init. */
   SculptUndoStep *us = (SculptUndoStep *)us_p;
-  us->step.data_size = us->data.undo_size;
+  sculpt_undo_compress_begin(&us->data);
+  sculpt_undosys_step_recompress_previous(us_p);
+  sculpt_undosys_step_data_size_update(us_p);
 
   SculptUndoNode *unode = us->data.nodes.last;
   if (unode && unode->type == SCULPT_UNDO_DYNTOPO_END) {
@@ -1477,7 +1716,9 @@ static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == true);
+  sculpt_undo_decompress(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_compress_begin(&us->data);
   us->step.is_applied = false;
 }
 
@@ -1486,7 +1727,9 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == false);
+  sculpt_undo_decompress(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_compress_begin(&us->data);
   us->step.is_applied = true;
 }
 
@@ -1584,6 +1827,7 @@ static void sculpt_undosys_step_decode(struct bContext *C,
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  sculpt_undo_compress_end(&us->data);
   sculpt_undo_free_list(&us->data.nodes);
 }
 
@@ -1630,7 +1874,13 @@ static UndoSculpt *sculpt_undo_get_nodes(void)
 {
   UndoStack *ustack = ED_undo_stack_get();
   UndoStep *us = BKE_undosys_stack_init_or_active_with_type(ustack, BKE_UNDOSYS_TYPE_SCULPT);
-  return sculpt_undosys_step_get_nodes(us);
+  UndoSculpt *usculpt = sculpt_undosys_step_get_nodes(us);
+  /* The active step may be finished already, its nodes must not be read or extended while they
+   * are compressed. */
+  if (us) {
+    sculpt_undo_decompress(usculpt);
+  }
+  return usculpt;
 }
 
 /** \} */
@@ -1241,7 +1241,7 @@ static void do_movie_proxy(void *pjv,
   int cfra, sfra = SFRA, efra = EFRA;
 
   if (pj->index_context) {
-    IMB_anim_index_rebuild(pj->index_context, stop, do_update, progress);
+    IMB_anim_index_rebuild(pj->index_context, stop, do_update, progress, NULL, NULL);
   }
 
   if (!build_undistort_count) {
@@ -42,6 +42,7 @@
 #include "BLI_fileops_types.h"
 #include "BLI_fnmatch.h"
 #include "BLI_ghash.h"
+#include "BLI_heap.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_stack.h"
@@ -335,6 +336,10 @@ typedef struct FileListEntryCache {
   /* Previews handling. */
   TaskPool *previews_pool;
   ThreadQueue *previews_done;
+  /* Previews waiting to be generated, ordered by distance to the block center (i.e. visible
+   * entries first). Tasks pick the next preview from here, not in the order they were pushed. */
+  Heap *previews_todo;
+  ThreadMutex previews_todo_lock;
 } FileListEntryCache;
 
 /* FileListCache.flags */
@@ -354,12 +359,6 @@ typedef struct FileListEntryPreview {
   int icon_id;
 } FileListEntryPreview;
 
-/* Dummy wrapper around FileListEntryPreview to ensure we do not access freed memory when freeing
- * tasks' data (see T74609). */
-typedef struct FileListEntryPreviewTaskData {
-  FileListEntryPreview *preview;
-} FileListEntryPreviewTaskData;
-
 typedef struct FileListFilter {
   uint64_t filter;
   uint64_t filter_id;
@@ -1475,15 +1474,25 @@ static void filelist_intern_free(FileListIntern *filelist_intern)
   MEM_SAFE_FREE(filelist_intern->filtered);
 }
 
-static void filelist_cache_preview_runf(TaskPool *__restrict pool, void *taskdata)
+static void filelist_cache_preview_runf(TaskPool *__restrict pool, void *UNUSED(taskdata))
 {
   FileListEntryCache *cache = BLI_task_pool_user_data(pool);
-  FileListEntryPreviewTaskData *preview_taskdata = taskdata;
-  FileListEntryPreview *preview = preview_taskdata->preview;
+  FileListEntryPreview *preview = NULL;
 
   ThumbSource source = 0;
   bool done = false;
 
+  /* Each task generates the most urgent preview left, whichever task it was pushed for. */
+  BLI_mutex_lock(&cache->previews_todo_lock);
+  if (!BLI_heap_is_empty(cache->previews_todo)) {
+    preview = BLI_heap_pop_min(cache->previews_todo);
+  }
+  BLI_mutex_unlock(&cache->previews_todo_lock);
+
+  if (preview == NULL) {
+    return;
+  }
+
   //  printf("%s: Start (%d)...\n", __func__, threadid);
 
   if (preview->in_memory_preview) {
@@ -1526,28 +1535,22 @@ static void filelist_cache_preview_runf(TaskPool *__restrict pool, void *taskdat
   }
 
   if (done) {
-    /* That way task freeing function won't free th preview, since it does not own it anymore. */
-    atomic_cas_ptr((void **)&preview_taskdata->preview, preview, NULL);
     BLI_thread_queue_push(cache->previews_done, preview);
   }
+  else {
+    /* In-memory preview not ready yet, it will be pushed again on next cache update. */
+    MEM_freeN(preview);
+  }
 
   //  printf("%s: End (%d)...\n", __func__, threadid);
 }
 
-static void filelist_cache_preview_freef(TaskPool *__restrict UNUSED(pool), void *taskdata)
+static void filelist_cache_preview_free(FileListEntryPreview *preview)
 {
-  FileListEntryPreviewTaskData *preview_taskdata = taskdata;
-  FileListEntryPreview *preview = preview_taskdata->preview;
-
-  /* preview_taskdata->preview is atomically set to NULL once preview has been processed and sent
-   * to previews_done queue. */
-  if (preview != NULL) {
-    if (preview->icon_id) {
-      BKE_icon_delete(preview->icon_id);
-    }
-    MEM_freeN(preview);
+  if (preview->icon_id) {
+    BKE_icon_delete(preview->icon_id);
   }
-  MEM_freeN(preview_taskdata);
+  MEM_freeN(preview);
 }
 
 static void filelist_cache_preview_ensure_running(FileListEntryCache *cache)
@@ -1555,6 +1558,8 @@ static void filelist_cache_preview_ensure_running(FileListEntryCache *cache)
   if (!cache->previews_pool) {
     cache->previews_pool = BLI_task_pool_create_background(cache, TASK_PRIORITY_LOW);
     cache->previews_done = BLI_thread_queue_init();
+    cache->previews_todo = BLI_heap_new();
+    BLI_mutex_init(&cache->previews_todo_lock);
 
     IMB_thumb_locks_acquire();
   }
@@ -1565,14 +1570,14 @@ static void filelist_cache_previews_clear(FileListEntryCache *cache)
   if (cache->previews_pool) {
     BLI_task_pool_cancel(cache->previews_pool);
 
+    /* No task is running anymore, previews left in the heap were never started. */
+    BLI_heap_clear(cache->previews_todo, (HeapFreeFP)filelist_cache_preview_free);
+
     FileListEntryPreview *preview;
     while ((preview = BLI_thread_queue_pop_timeout(cache->previews_done, 0))) {
       // printf("%s: DONE %d - %s - %p\n", __func__, preview->index, preview->path,
       // preview->img);
-      if (preview->icon_id) {
-        BKE_icon_delete(preview->icon_id);
-      }
-      MEM_freeN(preview);
+      filelist_cache_preview_free(preview);
     }
   }
 }
@@ -1586,8 +1591,11 @@ static void filelist_cache_previews_free(FileListEntryCache *cache)
 
     BLI_thread_queue_free(cache->previews_done);
     BLI_task_pool_free(cache->previews_pool);
+    BLI_heap_free(cache->previews_todo, NULL);
+    BLI_mutex_end(&cache->previews_todo_lock);
     cache->previews_pool = NULL;
     cache->previews_done = NULL;
+    cache->previews_todo = NULL;
 
     IMB_thumb_locks_release();
   }
@@ -1623,14 +1631,13 @@ static void filelist_cache_previews_push(FileList *filelist, FileDirEntry *entry
 
     filelist_cache_preview_ensure_running(cache);
 
-    FileListEntryPreviewTaskData *preview_taskdata = MEM_mallocN(sizeof(*preview_taskdata),
-                                                                 __func__);
-    preview_taskdata->preview = preview;
-    BLI_task_pool_push(cache->previews_pool,
-                       filelist_cache_preview_runf,
-                       preview_taskdata,
-                       true,
-                       filelist_cache_preview_freef);
+    /* Entries closest to the block center are assumed visible, generate those first. */
+    BLI_mutex_lock(&cache->previews_todo_lock);
+    BLI_heap_insert(
+        cache->previews_todo, (float)abs(index - cache->block_center_index), preview);
+    BLI_mutex_unlock(&cache->previews_todo_lock);
+
+    BLI_task_pool_push(cache->previews_pool, filelist_cache_preview_runf, NULL, false, NULL);
   }
 }
 
@@ -2360,6 +2367,9 @@ bool filelist_file_cache_block(struct FileList *filelist, const int index)
     filelist_cache_previews_clear(cache);
   }
 
+  /* Previews are prioritized by their distance to the center. */
+  cache->block_center_index = index;
+
   //  printf("Re-queueing previews...\n");
 
   /* Note we try to preview first images around given index - i.e. assumed visible ones. */
@@ -2376,8 +2386,6 @@ bool filelist_file_cache_block(struct FileList *filelist, const int index)
     }
   }
 
-  cache->block_center_index = index;
-
   //  printf("%s Finished!\n", __func__);
 
   return true;
@@ -106,6 +106,25 @@ typedef struct SnapObjectData {
   };
 } SnapObjectData;
 
+/** A visible base that passed the selection filter, see #snap_objects_base_test. */
+typedef struct SnapObjectBase {
+  Object *ob;
+  bool has_duplis;
+  bool is_object_active;
+} SnapObjectBase;
+
+/** An object (or dupli-instance) to snap to. */
+typedef struct SnapObjectInstance {
+  Object *ob;
+  /** Matrix to snap with, may not be #Object.obmat with dupli-instances. */
+  float obmat[4][4];
+  /** Copy of the local bounds, to detect changes. */
+  float bb_min[3], bb_max[3];
+  /** Leaf of #SnapObjectContext.objects.tree, or -1 to check the instance on every query. */
+  int tree_leaf;
+  bool is_object_active;
+} SnapObjectInstance;
+
 struct SnapObjectContext {
   Scene *scene;
 
@@ -127,6 +146,28 @@ struct SnapObjectContext {
     MemArena *mem_arena;
   } cache;
 
+  /* Objects to snap to, kept between queries, see #snap_objects_cache_ensure. */
+  struct {
+    const Depsgraph *depsgraph;
+    eSnapSelect snap_select;
+    const Base *base_act;
+
+    struct SnapObjectBase *bases;
+    uint bases_len;
+    /** The objects of #bases, in the same order. */
+    struct SnapObjectInstance *instances;
+    uint instances_len;
+    /**
+     * Dupli-instances of #bases, gathered again on every query and checked without culling.
+     * Instanced objects are not owned by the bases and may be freed or change between queries.
+     */
+    struct SnapObjectInstance *duplis;
+    uint duplis_len, duplis_alloc;
+
+    /** World space bounds of the instances with a #SnapObjectInstance.tree_leaf. */
+    BVHTree *tree;
+  } objects;
+
   /* Filter data, returns true to check this value */
   struct {
     struct {
@@ -375,71 +416,362 @@ typedef void (*IterSnapObjsCallback)(SnapObjectContext *sctx,
                                      void *data);
 
 /**
- * Walks through all objects in the scene to create the list of objects to snap.
+ * Local bounds used to skip whole objects, only objects that can't change while snapping
+ * and that are never snapped to outside these bounds are culled.
+ *
+ * \return false when the object must be checked on every query.
+ */
+static bool snap_object_instance_bounds(Object *ob, float r_min[3], float r_max[3])
+{
+  switch (ob->type) {
+    case OB_MESH: {
+      if (BKE_object_is_in_editmode(ob)) {
+        return false;
+      }
+      const BoundBox *bb = BKE_mesh_boundbox_get(ob);
+      if (bb == NULL) {
+        return false;
+      }
+      copy_v3_v3(r_min, bb->vec[0]);
+      copy_v3_v3(r_max, bb->vec[6]);
+      return true;
+    }
+    case OB_EMPTY:
+    case OB_GPENCIL:
+    case OB_LAMP:
+      /* Only the object center is used. */
+      zero_v3(r_min);
+      zero_v3(r_max);
+      return true;
+  }
+  /* Curves snap to their control points, armatures and cameras don't have useful bounds. */
+  return false;
+}
+
+static void snap_object_instance_world_bounds(const SnapObjectInstance *inst, float r_bv[2][3])
+{
+  BoundBox bb;
+  BKE_boundbox_init_from_minmax(&bb, inst->bb_min, inst->bb_max);
+  INIT_MINMAX(r_bv[0], r_bv[1]);
+  for (int i = 0; i < 8; i++) {
+    float co[3];
+    mul_v3_m4v3(co, inst->obmat, bb.vec[i]);
+    minmax_v3v3_v3(r_bv[0], r_bv[1], co);
+  }
+  /* Grow a little, culling must never be stricter than the tests of each object. */
+  const float margin = 1e-5f * max_ff(len_v3v3(r_bv[0], r_bv[1]),
+                                      max_ff(len_v3(r_bv[0]), len_v3(r_bv[1])));
+  add_v3_fl(r_bv[0], -margin);
+  add_v3_fl(r_bv[1], margin);
+}
+
+static void snap_objects_cache_free(SnapObjectContext *sctx)
+{
+  MEM_SAFE_FREE(sctx->objects.bases);
+  MEM_SAFE_FREE(sctx->objects.instances);
+  MEM_SAFE_FREE(sctx->objects.duplis);
+  if (sctx->objects.tree) {
+    BLI_bvhtree_free(sctx->objects.tree);
+    sctx->objects.tree = NULL;
+  }
+  sctx->objects.bases_len = 0;
+  sctx->objects.instances_len = 0;
+  sctx->objects.duplis_len = 0;
+  sctx->objects.duplis_alloc = 0;
+  sctx->objects.depsgraph = NULL;
+}
+
+/**
+ * Test if the objects of \a base are snapped to.
+ */
+static bool snap_objects_base_test(const SnapObjectContext *sctx,
+                                   const ViewLayer *view_layer,
+                                   const eSnapSelect snap_select,
+                                   const Base *base)
+{
+  if (!BASE_VISIBLE(sctx->v3d_data.v3d, base)) {
+    return false;
+  }
+
+  if (base->flag_legacy & BA_TRANSFORM_LOCKED_IN_PLACE) {
+    /* pass */
+  }
+  else if (base->flag_legacy & BA_SNAP_FIX_DEPS_FIASCO) {
+    return false;
+  }
+
+  if (snap_select == SNAP_NOT_SELECTED) {
+    if ((base->flag & BASE_SELECTED) || (base->flag_legacy & BA_WAS_SEL)) {
+      return false;
+    }
+  }
+  else if (snap_select == SNAP_NOT_ACTIVE) {
+    if (base == view_layer->basact) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void snap_objects_cache_duplis_add(SnapObjectContext *sctx,
+                                          Object *ob,
+                                          const float obmat[4][4],
+                                          const bool is_object_active)
+{
+  if (sctx->objects.duplis_len == sctx->objects.duplis_alloc) {
+    sctx->objects.duplis_alloc = MAX2(sctx->objects.duplis_alloc * 2, 64);
+    sctx->objects.duplis = MEM_reallocN(
+        sctx->objects.duplis, sizeof(*sctx->objects.duplis) * sctx->objects.duplis_alloc);
+  }
+  SnapObjectInstance *inst = &sctx->objects.duplis[sctx->objects.duplis_len++];
+  inst->ob = ob;
+  copy_m4_m4(inst->obmat, (float(*)[4])obmat);
+  inst->is_object_active = is_object_active;
+  inst->tree_leaf = -1;
+}
+
+/**
+ * Gather the dupli-instances of the cached bases for this query.
  */
-static void iter_snap_objects(SnapObjectContext *sctx,
-                              Depsgraph *depsgraph,
-                              const struct SnapObjectParams *params,
-                              IterSnapObjsCallback sob_callback,
-                              void *data)
+static void snap_objects_cache_duplis_update(SnapObjectContext *sctx, Depsgraph *depsgraph)
 {
+  sctx->objects.duplis_len = 0;
+  for (uint i = 0; i < sctx->objects.bases_len; i++) {
+    const SnapObjectBase *sob = &sctx->objects.bases[i];
+    if (!sob->has_duplis) {
+      continue;
+    }
+    ListBase *lb = object_duplilist(depsgraph, sctx->scene, sob->ob);
+    LISTBASE_FOREACH (DupliObject *, dupli_ob, lb) {
+      snap_objects_cache_duplis_add(sctx, dupli_ob->ob, dupli_ob->mat, sob->is_object_active);
+    }
+    free_object_duplilist(lb);
+  }
+}
+
+static void snap_objects_cache_build(SnapObjectContext *sctx,
+                                     Depsgraph *depsgraph,
+                                     const eSnapSelect snap_select)
+{
+  snap_objects_cache_free(sctx);
+
   ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
-  const View3D *v3d = sctx->v3d_data.v3d;
-  const eSnapSelect snap_select = params->snap_select;
-  const bool use_object_edit_cage = params->use_object_edit_cage;
-  const bool use_backface_culling = params->use_backface_culling;
-
-  Base *base_act = view_layer->basact;
-  for (Base *base = view_layer->object_bases.first; base != NULL; base = base->next) {
-    if (!BASE_VISIBLE(v3d, base)) {
+  sctx->objects.depsgraph = depsgraph;
+  sctx->objects.snap_select = snap_select;
+  sctx->objects.base_act = view_layer->basact;
+
+  const uint bases_alloc = MAX2((uint)BLI_listbase_count(&view_layer->object_bases), 1);
+  sctx->objects.bases = MEM_malloc_arrayN(bases_alloc, sizeof(*sctx->objects.bases), __func__);
+  sctx->objects.instances = MEM_malloc_arrayN(
+      bases_alloc, sizeof(*sctx->objects.instances), __func__);
+
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (!snap_objects_base_test(sctx, view_layer, snap_select, base)) {
       continue;
     }
 
-    if (base->flag_legacy & BA_TRANSFORM_LOCKED_IN_PLACE) {
-      /* pass */
+    Object *obj_eval = DEG_get_evaluated_object(depsgraph, base->object);
+
+    SnapObjectBase *sob = &sctx->objects.bases[sctx->objects.bases_len++];
+    sob->ob = obj_eval;
+    sob->has_duplis = (obj_eval->transflag & OB_DUPLI) != 0;
+    sob->is_object_active = (base == view_layer->basact);
+
+    SnapObjectInstance *inst = &sctx->objects.instances[sctx->objects.instances_len++];
+    inst->ob = obj_eval;
+    copy_m4_m4(inst->obmat, obj_eval->obmat);
+    inst->is_object_active = sob->is_object_active;
+    inst->tree_leaf = snap_object_instance_bounds(obj_eval, inst->bb_min, inst->bb_max) ? 0 : -1;
+  }
+
+  uint tree_len = 0;
+  for (uint i = 0; i < sctx->objects.instances_len; i++) {
+    tree_len += (sctx->objects.instances[i].tree_leaf != -1);
+  }
+  if (tree_len == 0) {
+    return;
+  }
+
+  sctx->objects.tree = BLI_bvhtree_new((int)tree_len, 0.0f, 4, 6);
+  int leaf = 0;
+  for (uint i = 0; i < sctx->objects.instances_len; i++) {
+    SnapObjectInstance *inst = &sctx->objects.instances[i];
+    if (inst->tree_leaf != -1) {
+      float bv[2][3];
+      snap_object_instance_world_bounds(inst, bv);
+      BLI_bvhtree_insert(sctx->objects.tree, (int)i, bv[0], 2);
+      inst->tree_leaf = leaf++;
     }
-    else if (base->flag_legacy & BA_SNAP_FIX_DEPS_FIASCO) {
+  }
+  BLI_bvhtree_balance(sctx->objects.tree);
+}
+
+/**
+ * Check the cached objects still match the (evaluated) scene.
+ * Moved objects and changed bounds are updated in place,
+ * changes to the list of objects need a rebuild.
+ *
+ * Only the evaluated objects of the view layer's bases are cached, the base list is compared
+ * before any cached object is accessed so freed objects are never read.
+ *
+ * \return false when the cache must be rebuilt.
+ */
+static bool snap_objects_cache_validate(SnapObjectContext *sctx,
+                                        Depsgraph *depsgraph,
+                                        const eSnapSelect snap_select)
+{
+  ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
+  if (sctx->objects.depsgraph != depsgraph || sctx->objects.snap_select != snap_select ||
+      sctx->objects.base_act != view_layer->basact) {
+    return false;
+  }
+
+  uint base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (!snap_objects_base_test(sctx, view_layer, snap_select, base)) {
       continue;
     }
+    if (base_index == sctx->objects.bases_len) {
+      return false;
+    }
+    const SnapObjectBase *sob = &sctx->objects.bases[base_index++];
+    Object *obj_eval = DEG_get_evaluated_object(depsgraph, base->object);
+    if (sob->ob != obj_eval || sob->has_duplis != ((obj_eval->transflag & OB_DUPLI) != 0)) {
+      return false;
+    }
+  }
+  if (base_index != sctx->objects.bases_len) {
+    return false;
+  }
 
-    const bool is_object_active = (base == base_act);
-    if (snap_select == SNAP_NOT_SELECTED) {
-      if ((base->flag & BASE_SELECTED) || (base->flag_legacy & BA_WAS_SEL)) {
-        continue;
-      }
+  bool tree_changed = false;
+  for (uint i = 0; i < sctx->objects.instances_len; i++) {
+    SnapObjectInstance *inst = &sctx->objects.instances[i];
+    float bb_min[3], bb_max[3];
+    const bool use_tree = snap_object_instance_bounds(inst->ob, bb_min, bb_max);
+    if (use_tree != (inst->tree_leaf != -1)) {
+      return false;
     }
-    else if (snap_select == SNAP_NOT_ACTIVE) {
-      if (is_object_active) {
-        continue;
-      }
+    const bool obmat_changed = !equals_m4m4(inst->obmat, inst->ob->obmat);
+    if (obmat_changed) {
+      copy_m4_m4(inst->obmat, inst->ob->obmat);
+    }
+    if (!use_tree) {
+      continue;
+    }
+    if (obmat_changed || !equals_v3v3(bb_min, inst->bb_min) || !equals_v3v3(bb_max, inst->bb_max)) {
+      copy_v3_v3(inst->bb_min, bb_min);
+      copy_v3_v3(inst->bb_max, bb_max);
+      float bv[2][3];
+      snap_object_instance_world_bounds(inst, bv);
+      BLI_bvhtree_update_node(sctx->objects.tree, inst->tree_leaf, bv[0], NULL, 2);
+      tree_changed = true;
     }
+  }
+  if (tree_changed) {
+    BLI_bvhtree_update_tree(sctx->objects.tree);
+  }
+  return true;
+}
 
-    Object *obj_eval = DEG_get_evaluated_object(depsgraph, base->object);
-    if (obj_eval->transflag & OB_DUPLI) {
-      DupliObject *dupli_ob;
-      ListBase *lb = object_duplilist(depsgraph, sctx->scene, obj_eval);
-      for (dupli_ob = lb->first; dupli_ob; dupli_ob = dupli_ob->next) {
-        sob_callback(sctx,
-                     dupli_ob->ob,
-                     dupli_ob->mat,
-                     use_object_edit_cage,
-                     use_backface_culling,
-                     is_object_active,
-                     data);
-      }
-      free_object_duplilist(lb);
+/**
+ * The list of objects and a tree of their bounds are kept between queries, the objects don't
+ * need to be gathered again for every mouse move while transforming.
+ * The cache is checked against the evaluated scene on every query,
+ * so updates from the depsgraph are always taken into account.
+ * Dupli-instances are generated again on every query, as before caching.
+ */
+static void snap_objects_cache_ensure(SnapObjectContext *sctx,
+                                      Depsgraph *depsgraph,
+                                      const struct SnapObjectParams *params)
+{
+  if (!snap_objects_cache_validate(sctx, depsgraph, params->snap_select)) {
+    snap_objects_cache_build(sctx, depsgraph, params->snap_select);
+  }
+  snap_objects_cache_duplis_update(sctx, depsgraph);
+}
+
+static void snap_object_instance_call(SnapObjectContext *sctx,
+                                      const struct SnapObjectParams *params,
+                                      const SnapObjectInstance *inst,
+                                      IterSnapObjsCallback sob_callback,
+                                      void *data)
+{
+  sob_callback(sctx,
+               inst->ob,
+               (float(*)[4])inst->obmat,
+               params->use_object_edit_cage,
+               params->use_backface_culling,
+               inst->is_object_active,
+               data);
+}
+
+/**
+ * Calls \a sob_callback for the objects that are not in the tree of object bounds,
+ * these are checked on every query.
+ */
+static void iter_snap_objects_unculled(SnapObjectContext *sctx,
+                                       const struct SnapObjectParams *params,
+                                       IterSnapObjsCallback sob_callback,
+                                       void *data)
+{
+  for (uint i = 0; i < sctx->objects.duplis_len; i++) {
+    snap_object_instance_call(sctx, params, &sctx->objects.duplis[i], sob_callback, data);
+  }
+  for (uint i = 0; i < sctx->objects.instances_len; i++) {
+    const SnapObjectInstance *inst = &sctx->objects.instances[i];
+    if (inst->tree_leaf == -1) {
+      snap_object_instance_call(sctx, params, inst, sob_callback, data);
     }
+  }
+}
 
-    sob_callback(sctx,
-                 obj_eval,
-                 obj_eval->obmat,
-                 use_object_edit_cage,
-                 use_backface_culling,
-                 is_object_active,
-                 data);
+/** Arguments for the callbacks of the tree of object bounds. */
+struct SnapObjectsTreeData {
+  SnapObjectContext *sctx;
+  const struct SnapObjectParams *params;
+  IterSnapObjsCallback sob_callback;
+  void *data;
+  /* The search shrinks as closer elements are found (read/write args of the callback). */
+  const float *ray_depth;
+  float ray_dir_len;
+  const float *dist_px;
+};
+
+static void snap_objects_tree_raycast_cb(void *userdata,
+                                         int index,
+                                         const BVHTreeRay *UNUSED(ray),
+                                         BVHTreeRayHit *hit)
+{
+  const struct SnapObjectsTreeData *tdata = userdata;
+  snap_object_instance_call(tdata->sctx,
+                            tdata->params,
+                            &tdata->sctx->objects.instances[index],
+                            tdata->sob_callback,
+                            tdata->data);
+  if (*tdata->ray_depth != BVH_RAYCAST_DIST_MAX) {
+    hit->dist = *tdata->ray_depth * tdata->ray_dir_len;
   }
 }
 
+static void snap_objects_tree_nearest_projected_cb(
+    void *userdata,
+    int index,
+    const struct DistProjectedAABBPrecalc *UNUSED(precalc),
+    const float (*clip_plane)[4],
+    const int clip_plane_len,
+    BVHTreeNearest *nearest)
+{
+  UNUSED_VARS(clip_plane, clip_plane_len);
+  const struct SnapObjectsTreeData *tdata = userdata;
+  snap_object_instance_call(tdata->sctx,
+                            tdata->params,
+                            &tdata->sctx->objects.instances[index],
+                            tdata->sob_callback,
+                            tdata->data);
+  nearest->dist_sq = square_f(*tdata->dist_px);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1132,7 +1464,37 @@ static bool raycastObjects(SnapObjectContext *sctx,
       .ret = false,
   };
 
-  iter_snap_objects(sctx, depsgraph, params, raycast_obj_fn, &data);
+  snap_objects_cache_ensure(sctx, depsgraph, params);
+  iter_snap_objects_unculled(sctx, params, raycast_obj_fn, &data);
+
+  if (sctx->objects.tree) {
+    struct SnapObjectsTreeData tdata = {
+        .sctx = sctx,
+        .params = params,
+        .sob_callback = raycast_obj_fn,
+        .data = &data,
+        .ray_depth = ray_depth,
+    };
+
+    /* The tree uses distances along a unit length ray. */
+    float ray_dir_unit[3];
+    tdata.ray_dir_len = normalize_v3_v3(ray_dir_unit, ray_dir);
+    if (tdata.ray_dir_len != 0.0f) {
+      BVHTreeRayHit hit = {
+          .index = -1,
+          .dist = (*ray_depth != BVH_RAYCAST_DIST_MAX) ? *ray_depth * tdata.ray_dir_len :
+                                                         BVH_RAYCAST_DIST_MAX,
+      };
+      BLI_bvhtree_ray_cast_ex(sctx->objects.tree,
+                              ray_start,
+                              ray_dir_unit,
+                              0.0f,
+                              &hit,
+                              snap_objects_tree_raycast_cb,
+                              &tdata,
+                              BVH_RAYCAST_DEFAULT);
+    }
+  }
 
   return data.ret;
 }
@@ -2812,7 +3174,31 @@ static short snapObjectsRay(SnapObjectContext *sctx,
       .ret = 0,
   };
 
-  iter_snap_objects(sctx, depsgraph, params, snap_obj_fn, &data);
+  snap_objects_cache_ensure(sctx, depsgraph, params);
+  iter_snap_objects_unculled(sctx, params, snap_obj_fn, &data);
+
+  if (sctx->objects.tree) {
+    struct SnapObjectsTreeData tdata = {
+        .sctx = sctx,
+        .params = params,
+        .sob_callback = snap_obj_fn,
+        .data = &data,
+        .dist_px = dist_px,
+    };
+    BVHTreeNearest nearest = {
+        .index = -1,
+        .dist_sq = square_f(*dist_px),
+    };
+    BLI_bvhtree_find_nearest_projected(sctx->objects.tree,
+                                       snapdata->pmat,
+                                       snapdata->win_size,
+                                       snapdata->mval,
+                                       snapdata->clip_plane,
+                                       snapdata->clip_plane_len,
+                                       &nearest,
+                                       snap_objects_tree_nearest_projected_cb,
+                                       &tdata);
+  }
 
   return data.ret;
 }
@@ -2862,6 +3248,7 @@ static void snap_object_data_free(void *sod_v)
 
 void ED_transform_snap_object_context_destroy(SnapObjectContext *sctx)
 {
+  snap_objects_cache_free(sctx);
   BLI_ghash_free(sctx->cache.object_map, NULL, snap_object_data_free);
   if (sctx->cache.data_to_object_map != NULL) {
     BLI_ghash_free(sctx->cache.data_to_object_map, NULL, NULL);
@@ -341,11 +341,17 @@ struct IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim,
                                                          const bool overwrite,
                                                          struct GSet *file_list);
 
-/* Will rebuild all used indices and proxies at once. */
+/* Called from the thread building indices and proxies whenever its progress changes. */
+typedef void (*IMB_IndexProgressFn)(void *userdata, float progress);
+
+/* Will rebuild all used indices and proxies at once.
+ * The optional \a progress_fn is called along with every update of \a progress. */
 void IMB_anim_index_rebuild(struct IndexBuildContext *context,
                             short *stop,
                             short *do_update,
-                            float *progress);
+                            float *progress,
+                            IMB_IndexProgressFn progress_fn,
+                            void *progress_userdata);
 
 /* Finish rebuilding proxies/time-codes and free temporary contexts used. */
 void IMB_anim_index_rebuild_finish(struct IndexBuildContext *context, short stop);
@@ -464,6 +470,33 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum eIMBScaleFilter {
+  /** Average of the covered pixels, nearest pixel when up-scaling. */
+  IMB_SCALE_FILTER_BOX = 0,
+  IMB_SCALE_FILTER_BILINEAR = 1,
+  /** Catmull-Rom cubic. */
+  IMB_SCALE_FILTER_BICUBIC = 2,
+  /** Lanczos with 3 lobes, sharpest but may ring on hard edges. */
+  IMB_SCALE_FILTER_LANCZOS = 3,
+} eIMBScaleFilter;
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             eIMBScaleFilter filter);
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+void IMB_scale_into_ImBuf(const struct ImBuf *ibuf,
+                          struct ImBuf *ibuf_out,
+                          eIMBScaleFilter filter);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -43,6 +43,12 @@ typedef void *(*MovieCacheGetPriorityDataFP)(void *userkey);
 typedef int (*MovieCacheGetItemPriorityFP)(void *last_userkey, void *priority_data);
 typedef void (*MovieCachePriorityDeleterFP)(void *priority_data);
 
+typedef struct MovieCacheStats {
+  size_t memory_in_use;
+  int totitem;
+  size_t hits, misses, evictions;
+} MovieCacheStats;
+
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
 
@@ -56,6 +62,9 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
                                           MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
+/* Relative cost of recomputing items of this cache (1.0 by default). When the memory budget is
+ * exceeded, items of cheaper caches are freed before items of more expensive ones. */
+void IMB_moviecache_set_cost(struct MovieCache *cache, float cost);
 
 void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
@@ -73,6 +82,16 @@ void IMB_moviecache_cleanup(struct MovieCache *cache,
 void IMB_moviecache_get_cache_segments(
     struct MovieCache *cache, int proxy, int render_flags, int *r_totseg, int **r_points);
 
+/* Memory budget shared by all movie caches and by other image caches reporting their usage. */
+void IMB_moviecache_shared_memory_add(size_t size);
+void IMB_moviecache_shared_memory_sub(size_t size);
+size_t IMB_moviecache_get_memory_budget(void);
+size_t IMB_moviecache_get_memory_in_use(void);
+void IMB_moviecache_enforce_limits(void);
+
+void IMB_moviecache_get_stats(struct MovieCache *cache, MovieCacheStats *r_stats);
+void IMB_moviecache_print_stats(void);
+
 struct MovieCacheIter;
 struct MovieCacheIter *IMB_moviecacheIter_new(struct MovieCache *cache);
 void IMB_moviecacheIter_free(struct MovieCacheIter *iter);
@@ -292,6 +292,8 @@ static struct MovieCache *colormanage_moviecache_ensure(ImBuf *ibuf)
                                        sizeof(ColormanageCacheKey),
                                        colormanage_hashhash,
                                        colormanage_hashcmp);
+    /* Display buffers are cheap to recompute from the image buffer they belong to. */
+    IMB_moviecache_set_cost(moviecache, 0.5f);
 
     ibuf->colormanage_cache->moviecache = moviecache;
   }
@@ -27,8 +27,10 @@
 #include "BLI_endian_switch.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -686,6 +688,60 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, int rollback)
   MEM_freeN(ctx);
 }
 
+/* Decoded frames are handed over to one encoder thread per proxy size, so scaling and encoding
+ * of all sizes runs in parallel with decoding. The queue is bounded to limit memory usage when
+ * encoding is slower than decoding. */
+#define PROXY_ENCODE_QUEUE_SIZE 8
+
+typedef struct ProxyEncodeQueue {
+  struct proxy_output_ctx *ctx;
+  AVFrame *frames[PROXY_ENCODE_QUEUE_SIZE];
+  int first, len;
+  bool finished;
+  ThreadMutex mutex;
+  ThreadCondition cond;
+} ProxyEncodeQueue;
+
+static void *proxy_encode_thread(void *queue_v)
+{
+  ProxyEncodeQueue *queue = queue_v;
+
+  while (true) {
+    AVFrame *frame;
+
+    BLI_mutex_lock(&queue->mutex);
+    while (queue->len == 0 && !queue->finished) {
+      BLI_condition_wait(&queue->cond, &queue->mutex);
+    }
+    if (queue->len == 0) {
+      BLI_mutex_unlock(&queue->mutex);
+      break;
+    }
+    frame = queue->frames[queue->first];
+    queue->first = (queue->first + 1) % PROXY_ENCODE_QUEUE_SIZE;
+    queue->len--;
+    BLI_condition_notify_all(&queue->cond);
+    BLI_mutex_unlock(&queue->mutex);
+
+    add_to_proxy_output_ffmpeg(queue->ctx, frame);
+    av_frame_free(&frame);
+  }
+
+  return NULL;
+}
+
+static void proxy_encode_queue_push(ProxyEncodeQueue *queue, AVFrame *frame)
+{
+  BLI_mutex_lock(&queue->mutex);
+  while (queue->len == PROXY_ENCODE_QUEUE_SIZE) {
+    BLI_condition_wait(&queue->cond, &queue->mutex);
+  }
+  queue->frames[(queue->first + queue->len) % PROXY_ENCODE_QUEUE_SIZE] = frame;
+  queue->len++;
+  BLI_condition_notify_all(&queue->cond);
+  BLI_mutex_unlock(&queue->mutex);
+}
+
 typedef struct FFmpegIndexBuilderContext {
   int anim_type;
 
@@ -701,6 +757,9 @@ typedef struct FFmpegIndexBuilderContext {
   struct proxy_output_ctx *proxy_ctx[IMB_PROXY_MAX_SLOT];
   anim_index_builder *indexer[IMB_TC_MAX_SLOT];
 
+  ProxyEncodeQueue encode_queue[IMB_PROXY_MAX_SLOT];
+  ListBase encode_threads;
+
   IMB_Timecode_Type tcs_in_use;
   IMB_Proxy_Size proxy_sizes_in_use;
 
@@ -817,6 +876,87 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
   return (IndexBuildContext *)context;
 }
 
+static void index_rebuild_ffmpeg_encode_begin(FFmpegIndexBuilderContext *context)
+{
+  int num_threads = 0;
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      num_threads++;
+    }
+  }
+
+  if (num_threads == 0) {
+    return;
+  }
+
+  BLI_threadpool_init(&context->encode_threads, proxy_encode_thread, num_threads);
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    ProxyEncodeQueue *queue = &context->encode_queue[i];
+
+    if (context->proxy_ctx[i]) {
+      queue->ctx = context->proxy_ctx[i];
+      BLI_mutex_init(&queue->mutex);
+      BLI_condition_init(&queue->cond);
+      BLI_threadpool_insert(&context->encode_threads, queue);
+    }
+  }
+}
+
+static void index_rebuild_ffmpeg_encode_frame(FFmpegIndexBuilderContext *context,
+                                              AVFrame *in_frame)
+{
+  /* The decoder owns data of the input frame, make a reference counted copy once, which is
+   * then shared by all encoder threads. */
+  AVFrame *frame = NULL;
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    ProxyEncodeQueue *queue = &context->encode_queue[i];
+
+    if (queue->ctx) {
+      if (frame == NULL) {
+        frame = av_frame_clone(in_frame);
+      }
+      proxy_encode_queue_push(queue, av_frame_clone(frame));
+    }
+  }
+
+  if (frame) {
+    av_frame_free(&frame);
+  }
+}
+
+static void index_rebuild_ffmpeg_encode_end(FFmpegIndexBuilderContext *context)
+{
+  if (BLI_listbase_is_empty(&context->encode_threads)) {
+    return;
+  }
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    ProxyEncodeQueue *queue = &context->encode_queue[i];
+
+    if (queue->ctx) {
+      BLI_mutex_lock(&queue->mutex);
+      queue->finished = true;
+      BLI_condition_notify_all(&queue->cond);
+      BLI_mutex_unlock(&queue->mutex);
+    }
+  }
+
+  BLI_threadpool_end(&context->encode_threads);
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    ProxyEncodeQueue *queue = &context->encode_queue[i];
+
+    if (queue->ctx) {
+      BLI_condition_end(&queue->cond);
+      BLI_mutex_end(&queue->mutex);
+      queue->ctx = NULL;
+    }
+  }
+}
+
 static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int stop)
 {
   int i;
@@ -848,9 +988,7 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   uint64_t s_dts = context->seek_pos_dts;
   uint64_t pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-  for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-  }
+  index_rebuild_ffmpeg_encode_frame(context, in_frame);
 
   if (!context->start_pts_set) {
     context->start_pts = pts;
@@ -896,7 +1034,9 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
 static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
                                 const short *stop,
                                 short *do_update,
-                                float *progress)
+                                float *progress,
+                                IMB_IndexProgressFn progress_fn,
+                                void *progress_userdata)
 {
   AVFrame *in_frame = 0;
   AVPacket next_packet;
@@ -911,6 +1051,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
   context->frame_rate = av_q2d(av_guess_frame_rate(context->iFormatCtx, context->iStream, NULL));
   context->pts_time_base = av_q2d(context->iStream->time_base);
 
+  index_rebuild_ffmpeg_encode_begin(context);
+
   while (av_read_frame(context->iFormatCtx, &next_packet) >= 0) {
     int frame_finished = 0;
     float next_progress =
@@ -919,6 +1061,9 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
     if (*progress != next_progress) {
       *progress = next_progress;
       *do_update = true;
+      if (progress_fn) {
+        progress_fn(progress_userdata, next_progress);
+      }
     }
 
     if (*stop) {
@@ -966,6 +1111,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
     } while (frame_finished);
   }
 
+  index_rebuild_ffmpeg_encode_end(context);
+
   av_free(in_frame);
 
   return 1;
@@ -1092,7 +1239,9 @@ static void index_rebuild_fallback_finish(FallbackIndexBuilderContext *context,
 static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
                                    const short *stop,
                                    short *do_update,
-                                   float *progress)
+                                   float *progress,
+                                   IMB_IndexProgressFn progress_fn,
+                                   void *progress_userdata)
 {
   int cnt = IMB_anim_get_duration(context->anim, IMB_TC_NONE);
   int i, pos;
@@ -1106,6 +1255,9 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
     if (*progress != next_progress) {
       *progress = next_progress;
       *do_update = true;
+      if (progress_fn) {
+        progress_fn(progress_userdata, next_progress);
+      }
     }
 
     if (*stop) {
@@ -1121,7 +1273,7 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
         struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
 
-        IMB_scalefastImBuf(s_ibuf, x, y);
+        IMB_scaleImBuf_filtered(s_ibuf, x, y, IMB_SCALE_FILTER_BILINEAR);
 
         IMB_convert_rgba_to_abgr(s_ibuf);
 
@@ -1229,22 +1381,34 @@ void IMB_anim_index_rebuild(struct IndexBuildContext *context,
                             /* NOLINTNEXTLINE: readability-non-const-parameter. */
                             short *do_update,
                             /* NOLINTNEXTLINE: readability-non-const-parameter. */
-                            float *progress)
+                            float *progress,
+                            IMB_IndexProgressFn progress_fn,
+                            void *progress_userdata)
 {
   switch (context->anim_type) {
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
-      index_rebuild_ffmpeg((FFmpegIndexBuilderContext *)context, stop, do_update, progress);
+      index_rebuild_ffmpeg((FFmpegIndexBuilderContext *)context,
+                           stop,
+                           do_update,
+                           progress,
+                           progress_fn,
+                           progress_userdata);
       break;
 #endif
 #ifdef WITH_AVI
     default:
-      index_rebuild_fallback((FallbackIndexBuilderContext *)context, stop, do_update, progress);
+      index_rebuild_fallback((FallbackIndexBuilderContext *)context,
+                             stop,
+                             do_update,
+                             progress,
+                             progress_fn,
+                             progress_userdata);
       break;
 #endif
   }
 
-  UNUSED_VARS(stop, do_update, progress);
+  UNUSED_VARS(stop, do_update, progress, progress_fn, progress_userdata);
 }
 
 void IMB_anim_index_rebuild_finish(IndexBuildContext *context, short stop)
@@ -54,7 +54,11 @@ static void skip_input_data(j_decompress_ptr cinfo, long num_bytes);
 static void term_source(j_decompress_ptr cinfo);
 static void memory_source(j_decompress_ptr cinfo, const unsigned char *buffer, size_t size);
 static boolean handle_app1(j_decompress_ptr cinfo);
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags);
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo,
+                                   int flags,
+                                   size_t max_size,
+                                   size_t *r_width,
+                                   size_t *r_height);
 
 static const uchar jpeg_default_quality = 75;
 static uchar ibuf_quality;
@@ -261,7 +265,16 @@ static boolean handle_app1(j_decompress_ptr cinfo)
   return true;
 }
 
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags)
+/**
+ * \param max_size: When non-zero, let the decoder scale the image down (by 1/2, 1/4 or 1/8)
+ * as long as its longest side remains at least this size. This skips most of the IDCT work
+ * and is used for thumbnails.
+ */
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo,
+                                   int flags,
+                                   size_t max_size,
+                                   size_t *r_width,
+                                   size_t *r_height)
 {
   JSAMPARRAY row_pointer;
   JSAMPLE *buffer = NULL;
@@ -279,16 +292,35 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
   jpeg_save_markers(cinfo, JPEG_COM, 0xffff);
 
   if (jpeg_read_header(cinfo, false) == JPEG_HEADER_OK) {
-    x = cinfo->image_width;
-    y = cinfo->image_height;
     depth = cinfo->num_components;
 
+    if (r_width) {
+      *r_width = cinfo->image_width;
+    }
+    if (r_height) {
+      *r_height = cinfo->image_height;
+    }
+
+    if (max_size > 0) {
+      const size_t max_dim = MAX2(cinfo->image_width, cinfo->image_height);
+      cinfo->scale_num = 1;
+      cinfo->scale_denom = 1;
+      while (cinfo->scale_denom < 8 && max_dim / (cinfo->scale_denom * 2) >= max_size) {
+        cinfo->scale_denom *= 2;
+      }
+      /* Precision is of little use at thumbnail sizes. */
+      cinfo->dct_method = JDCT_IFAST;
+    }
+
     if (cinfo->jpeg_color_space == JCS_YCCK) {
       cinfo->out_color_space = JCS_CMYK;
     }
 
     jpeg_start_decompress(cinfo);
 
+    x = cinfo->output_width;
+    y = cinfo->output_height;
+
     if (flags & IB_test) {
       jpeg_abort_decompress(cinfo);
       ibuf = IMB_allocImBuf(x, y, 8 * depth, 0);
@@ -464,7 +496,45 @@ ImBuf *imb_load_jpeg(const unsigned char *buffer,
   jpeg_create_decompress(cinfo);
   memory_source(cinfo, buffer, size);
 
-  ibuf = ibJpegImageFromCinfo(cinfo, flags);
+  ibuf = ibJpegImageFromCinfo(cinfo, flags, 0, NULL, NULL);
+
+  return ibuf;
+}
+
+ImBuf *imb_thumbnail_jpeg(const char *filepath,
+                          int flags,
+                          size_t max_thumb_size,
+                          char colorspace[IM_MAX_SPACE],
+                          size_t *r_width,
+                          size_t *r_height)
+{
+  struct jpeg_decompress_struct _cinfo, *cinfo = &_cinfo;
+  struct my_error_mgr jerr;
+  FILE *infile;
+  ImBuf *ibuf;
+
+  if ((infile = BLI_fopen(filepath, "rb")) == NULL) {
+    return NULL;
+  }
+
+  colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+
+  cinfo->err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error;
+
+  /* Establish the setjmp return context for my_error_exit to use. */
+  if (setjmp(jerr.setjmp_buffer)) {
+    jpeg_destroy_decompress(cinfo);
+    fclose(infile);
+    return NULL;
+  }
+
+  jpeg_create_decompress(cinfo);
+  jpeg_stdio_src(cinfo, infile);
+
+  ibuf = ibJpegImageFromCinfo(cinfo, flags, max_thumb_size, r_width, r_height);
+
+  fclose(infile);
 
   return ibuf;
 }
@@ -24,12 +24,15 @@
 #undef DEBUG_MESSAGES
 
 #include <memory.h>
+#include <stdio.h>
 #include <stdlib.h> /* for qsort */
 
 #include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -40,6 +43,8 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "atomic_ops.h"
+
 #ifdef DEBUG_MESSAGES
 #  if defined __GNUC__
 #    define PRINT(format, args...) printf(format, ##args)
@@ -50,10 +55,24 @@
 #  define PRINT(format, ...)
 #endif
 
+/* Scale applied to item priorities before dividing them by the cache cost, so that the cost
+ * still has effect on items which are close to the current frame. */
+#define MOVIECACHE_PRIORITY_SCALE 16.0f
+
 static MEM_CacheLimiterC *limitor = NULL;
 static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
 
+/* All created caches, used for statistics. */
+static ListBase caches = {NULL, NULL};
+static pthread_mutex_t caches_lock = BLI_MUTEX_INITIALIZER;
+
+/* Memory used by image caches which are not managed by the limiter (such as the sequencer
+ * cache), but which share the memory budget with movie caches. */
+static size_t shared_memory_in_use = 0;
+
 typedef struct MovieCache {
+  struct MovieCache *next, *prev;
+
   char name[64];
 
   GHash *hash;
@@ -71,6 +90,14 @@ typedef struct MovieCache {
 
   int keysize;
 
+  /* Relative cost of recomputing the cached data, see #IMB_moviecache_set_cost. */
+  float cost;
+
+  /* Statistics, memory is measured when items are added. */
+  size_t memory_in_use;
+  int totitem;
+  size_t hits, misses, evictions;
+
   void *last_userkey;
 
   int totseg, *points, proxy, render_flags; /* for visual statistics optimization */
@@ -87,6 +114,7 @@ typedef struct MovieCacheItem {
   ImBuf *ibuf;
   MEM_CacheLimiterHandleC *c_handle;
   void *priority_data;
+  size_t size;
 } MovieCacheItem;
 
 static unsigned int moviecache_hashhash(const void *keyv)
@@ -113,6 +141,12 @@ static void moviecache_keyfree(void *val)
   BLI_mempool_free(key->cache_owner->keys_pool, key);
 }
 
+static void moviecache_stats_remove(MovieCache *cache, const MovieCacheItem *item)
+{
+  atomic_sub_and_fetch_z(&cache->memory_in_use, item->size);
+  atomic_sub_and_fetch_int32(&cache->totitem, 1);
+}
+
 static void moviecache_valfree(void *val)
 {
   MovieCacheItem *item = (MovieCacheItem *)val;
@@ -123,6 +157,7 @@ static void moviecache_valfree(void *val)
   if (item->ibuf) {
     MEM_CacheLimiter_unmanage(item->c_handle);
     IMB_freeImBuf(item->ibuf);
+    moviecache_stats_remove(cache, item);
   }
 
   if (item->priority_data && cache->prioritydeleterfp) {
@@ -178,6 +213,9 @@ static void IMB_moviecache_destructor(void *p)
     item->ibuf = NULL;
     item->c_handle = NULL;
 
+    moviecache_stats_remove(cache, item);
+    atomic_add_and_fetch_z(&cache->evictions, 1);
+
     /* force cached segments to be updated */
     if (cache->points) {
       MEM_freeN(cache->points);
@@ -230,6 +268,17 @@ static int get_item_priority(void *item_v, int default_priority)
   return priority;
 }
 
+static int get_item_priority_weighted(void *item_v, int default_priority)
+{
+  MovieCacheItem *item = (MovieCacheItem *)item_v;
+  const int priority = get_item_priority(item_v, default_priority);
+
+  /* Lower priority is freed first. Items which are cheap to recompute are freed before
+   * expensive items at the same distance, so caches with different costs can share the
+   * budget. */
+  return (int)((float)priority * MOVIECACHE_PRIORITY_SCALE / item->cache_owner->cost);
+}
+
 static bool get_item_destroyable(void *item_v)
 {
   MovieCacheItem *item = (MovieCacheItem *)item_v;
@@ -248,7 +297,7 @@ void IMB_moviecache_init(void)
 {
   limitor = new_MEM_CacheLimiter(IMB_moviecache_destructor, get_item_size);
 
-  MEM_CacheLimiter_ItemPriority_Func_set(limitor, get_item_priority);
+  MEM_CacheLimiter_ItemPriority_Func_set(limitor, get_item_priority_weighted);
   MEM_CacheLimiter_ItemDestroyable_Func_set(limitor, get_item_destroyable);
 }
 
@@ -282,10 +331,20 @@ MovieCache *IMB_moviecache_create(const char *name,
   cache->hashfp = hashfp;
   cache->cmpfp = cmpfp;
   cache->proxy = -1;
+  cache->cost = 1.0f;
+
+  BLI_mutex_lock(&caches_lock);
+  BLI_addtail(&caches, cache);
+  BLI_mutex_unlock(&caches_lock);
 
   return cache;
 }
 
+void IMB_moviecache_set_cost(MovieCache *cache, float cost)
+{
+  cache->cost = max_ff(cost, 1e-3f);
+}
+
 void IMB_moviecache_set_getdata_callback(MovieCache *cache, MovieCacheGetKeyDataFP getdatafp)
 {
   cache->getdatafp = getdatafp;
@@ -327,6 +386,10 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   item->cache_owner = cache;
   item->c_handle = NULL;
   item->priority_data = NULL;
+  item->size = get_size_in_memory(ibuf);
+
+  atomic_add_and_fetch_z(&cache->memory_in_use, item->size);
+  atomic_add_and_fetch_int32(&cache->totitem, 1);
 
   if (cache->getprioritydatafp) {
     item->priority_data = cache->getprioritydatafp(userkey);
@@ -345,7 +408,7 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   item->c_handle = MEM_CacheLimiter_insert(limitor, item);
 
   MEM_CacheLimiter_ref(item->c_handle);
-  MEM_CacheLimiter_enforce_limits(limitor);
+  MEM_CacheLimiter_enforce_limits_ex(limitor, shared_memory_in_use);
   MEM_CacheLimiter_unref(item->c_handle);
 
   if (need_lock) {
@@ -371,11 +434,15 @@ bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibu
   size_t mem_in_use, mem_limit, elem_size;
   bool result = false;
 
+  if (!limitor) {
+    IMB_moviecache_init();
+  }
+
   elem_size = get_size_in_memory(ibuf);
   mem_limit = MEM_CacheLimiter_get_maximum();
 
   BLI_mutex_lock(&limitor_lock);
-  mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
+  mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor) + shared_memory_in_use;
 
   if (mem_in_use + elem_size <= mem_limit) {
     do_moviecache_put(cache, userkey, ibuf, false);
@@ -412,10 +479,14 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 
       IMB_refImBuf(item->ibuf);
 
+      atomic_add_and_fetch_z(&cache->hits, 1);
+
       return item->ibuf;
     }
   }
 
+  atomic_add_and_fetch_z(&cache->misses, 1);
+
   return NULL;
 }
 
@@ -435,6 +506,10 @@ void IMB_moviecache_free(MovieCache *cache)
 {
   PRINT("%s: cache '%s' free\n", __func__, cache->name);
 
+  BLI_mutex_lock(&caches_lock);
+  BLI_remlink(&caches, cache);
+  BLI_mutex_unlock(&caches_lock);
+
   BLI_ghash_free(cache->hash, moviecache_keyfree, moviecache_valfree);
 
   BLI_mempool_destroy(cache->keys_pool);
@@ -603,3 +678,96 @@ void *IMB_moviecacheIter_getUserKey(struct MovieCacheIter *iter)
   MovieCacheKey *key = BLI_ghashIterator_getKey((GHashIterator *)iter);
   return key->userkey;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Shared Memory Budget
+ *
+ * All movie caches share a single limiter, other image caches which manage their own items
+ * report their memory usage here so they are accounted for in the same budget.
+ * \{ */
+
+void IMB_moviecache_shared_memory_add(size_t size)
+{
+  atomic_add_and_fetch_z(&shared_memory_in_use, size);
+}
+
+void IMB_moviecache_shared_memory_sub(size_t size)
+{
+  BLI_assert(shared_memory_in_use >= size);
+  atomic_sub_and_fetch_z(&shared_memory_in_use, size);
+}
+
+size_t IMB_moviecache_get_memory_budget(void)
+{
+  return MEM_CacheLimiter_get_maximum();
+}
+
+size_t IMB_moviecache_get_memory_in_use(void)
+{
+  size_t mem_in_use = shared_memory_in_use;
+
+  if (limitor) {
+    BLI_mutex_lock(&limitor_lock);
+    mem_in_use += MEM_CacheLimiter_get_memory_in_use(limitor);
+    BLI_mutex_unlock(&limitor_lock);
+  }
+
+  return mem_in_use;
+}
+
+void IMB_moviecache_enforce_limits(void)
+{
+  if (!limitor) {
+    return;
+  }
+
+  /* Keys of freed items are removed lazily by their owning cache. */
+  BLI_mutex_lock(&limitor_lock);
+  MEM_CacheLimiter_enforce_limits_ex(limitor, shared_memory_in_use);
+  BLI_mutex_unlock(&limitor_lock);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Statistics
+ * \{ */
+
+void IMB_moviecache_get_stats(MovieCache *cache, MovieCacheStats *r_stats)
+{
+  r_stats->memory_in_use = cache->memory_in_use;
+  r_stats->totitem = cache->totitem;
+  r_stats->hits = cache->hits;
+  r_stats->misses = cache->misses;
+  r_stats->evictions = cache->evictions;
+}
+
+void IMB_moviecache_print_stats(void)
+{
+  MovieCacheStats stats;
+  size_t total = 0;
+
+  printf("Movie cache budget: %.2f MB\n",
+         (double)IMB_moviecache_get_memory_budget() / (1024.0 * 1024.0));
+
+  BLI_mutex_lock(&caches_lock);
+  LISTBASE_FOREACH (MovieCache *, cache, &caches) {
+    IMB_moviecache_get_stats(cache, &stats);
+    total += stats.memory_in_use;
+
+    printf("  %s: %d items, %.2f MB, cost %.2f, %zu hits, %zu misses, %zu evictions\n",
+           cache->name,
+           stats.totitem,
+           (double)stats.memory_in_use / (1024.0 * 1024.0),
+           (double)cache->cost,
+           stats.hits,
+           stats.misses,
+           stats.evictions);
+  }
+  BLI_mutex_unlock(&caches_lock);
+
+  printf("  shared: %.2f MB\n", (double)shared_memory_in_use / (1024.0 * 1024.0));
+  printf("  total: %.2f MB\n", (double)(total + shared_memory_in_use) / (1024.0 * 1024.0));
+}
+
+/** \} */
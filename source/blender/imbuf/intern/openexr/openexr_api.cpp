@@ -42,6 +42,7 @@
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
 #include <ImfPixelType.h>
+#include <ImfPreviewImage.h>
 #include <ImfStandardAttributes.h>
 #include <ImfStringAttribute.h>
 #include <ImfVersion.h>
@@ -55,6 +56,7 @@
 #include <ImfOutputPart.h>
 #include <ImfPartHelper.h>
 #include <ImfPartType.h>
+#include <ImfTiledInputPart.h>
 #include <ImfTiledOutputPart.h>
 
 #include "DNA_scene_types.h" /* For OpenEXR compression constants */
@@ -2096,6 +2098,131 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
   }
 }
 
+/**
+ * Load a reduced size image for thumbnails, either the preview image stored in the header
+ * or the smallest level of a mip-mapped tiled file that still covers `max_thumb_size`.
+ * Returns null when neither is available so the caller can fall back to a full load.
+ */
+struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
+                                                  const int UNUSED(flags),
+                                                  const size_t max_thumb_size,
+                                                  char colorspace[IM_MAX_SPACE],
+                                                  size_t *r_width,
+                                                  size_t *r_height)
+{
+  struct ImBuf *ibuf = nullptr;
+  IStream *stream = nullptr;
+  MultiPartInputFile *file = nullptr;
+
+  try {
+    stream = new IFileStream(filepath);
+    file = new MultiPartInputFile(*stream);
+
+    const Header &header = file->header(0);
+    Box2i dw = header.dataWindow();
+    *r_width = (size_t)(dw.max.x - dw.min.x + 1);
+    *r_height = (size_t)(dw.max.y - dw.min.y + 1);
+
+    if (imb_exr_is_multi(*file)) {
+      /* Multi-layer files have no single image to show. */
+    }
+    else if (header.hasPreviewImage() &&
+             (size_t)std::max(header.previewImage().width(), header.previewImage().height()) >=
+                 max_thumb_size) {
+      const PreviewImage &preview = header.previewImage();
+      const int width = (int)preview.width();
+      const int height = (int)preview.height();
+
+      ibuf = IMB_allocImBuf(width, height, 32, IB_rect);
+      if (ibuf) {
+        /* Preview pixels are stored top-down and already display referred. */
+        for (int y = 0; y < height; y++) {
+          const PreviewRgba *src = &preview.pixels()[(size_t)(height - 1 - y) * width];
+          uchar *dst = (uchar *)(ibuf->rect + (size_t)y * width);
+          for (int x = 0; x < width; x++, src++, dst += 4) {
+            dst[0] = src->r;
+            dst[1] = src->g;
+            dst[2] = src->b;
+            dst[3] = src->a;
+          }
+        }
+        colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+      }
+    }
+    else if (header.hasTileDescription() &&
+             header.tileDescription().mode == MIPMAP_LEVELS) {
+      const char *rgb_channels[3];
+      const int num_rgb_channels = exr_has_rgb(*file, rgb_channels);
+      TiledInputPart in(*file, 0);
+
+      /* Pick the smallest level that still covers the thumbnail size. */
+      int level = 0;
+      while (level + 1 < in.numLevels() &&
+             (size_t)std::max(in.levelWidth(level + 1), in.levelHeight(level + 1)) >=
+                 max_thumb_size) {
+        level++;
+      }
+
+      if (level > 0 && num_rgb_channels > 0) {
+        const Box2i ldw = in.dataWindowForLevel(level);
+        const int width = ldw.max.x - ldw.min.x + 1;
+        const int height = ldw.max.y - ldw.min.y + 1;
+
+        ibuf = IMB_allocImBuf(width, height, exr_has_alpha(*file) ? 32 : 24, 0);
+        if (ibuf && imb_addrectfloatImBuf(ibuf)) {
+          FrameBuffer frameBuffer;
+          const int xstride = sizeof(float[4]);
+          const int ystride = -xstride * width;
+          float *first = ibuf->rect_float - 4 * (ldw.min.x - ldw.min.y * width);
+          first += 4 * (height - 1) * width;
+
+          for (int i = 0; i < num_rgb_channels; i++) {
+            frameBuffer.insert(exr_rgba_channelname(*file, rgb_channels[i]),
+                               Slice(Imf::FLOAT, (char *)(first + i), xstride, ystride));
+          }
+          frameBuffer.insert(exr_rgba_channelname(*file, "A"),
+                             Slice(Imf::FLOAT, (char *)(first + 3), xstride, ystride, 1, 1, 1.0f));
+
+          in.setFrameBuffer(frameBuffer);
+          in.readTiles(0, in.numXTiles(level) - 1, 0, in.numYTiles(level) - 1, level);
+
+          if (num_rgb_channels <= 2) {
+            /* Convert 1 or 2 to 3 channels, as for full loading. */
+            for (size_t a = 0; a < (size_t)ibuf->x * ibuf->y; a++) {
+              float *color = ibuf->rect_float + a * 4;
+              if (num_rgb_channels <= 1) {
+                color[1] = color[0];
+              }
+              color[2] = color[0];
+            }
+          }
+
+          ibuf->ftype = IMB_FTYPE_OPENEXR;
+          colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+        }
+        else if (ibuf) {
+          IMB_freeImBuf(ibuf);
+          ibuf = nullptr;
+        }
+      }
+    }
+
+    delete file;
+    delete stream;
+    return ibuf;
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+    delete file;
+    delete stream;
+
+    return nullptr;
+  }
+}
+
 void imb_initopenexr(void)
 {
   int num_threads = BLI_system_thread_count();
@@ -39,6 +39,7 @@
 #include "IMB_filetype.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_thumbs.h"
 #include "imbuf.h"
 
 #include "IMB_colormanagement.h"
@@ -279,6 +280,36 @@ ImBuf *IMB_testiffname(const char *filepath, int flags)
   return ibuf;
 }
 
+ImBuf *IMB_thumb_load_image(const char *filepath,
+                            const size_t max_thumb_size,
+                            size_t *r_width,
+                            size_t *r_height)
+{
+  const int flags = IB_rect | IB_metadata;
+  const ImFileType *type = IMB_file_type_from_ftype(IMB_ispic_type(filepath));
+  ImBuf *ibuf = NULL;
+
+  if (type != NULL && type->load_filepath_thumbnail != NULL) {
+    char colorspace[IM_MAX_SPACE] = "";
+
+    ibuf = type->load_filepath_thumbnail(
+        filepath, flags, max_thumb_size, colorspace, r_width, r_height);
+    if (ibuf) {
+      imb_handle_alpha(ibuf, flags, NULL, colorspace);
+      return ibuf;
+    }
+  }
+
+  /* The format has no cheaper way to get a small image, load it in full. */
+  ibuf = IMB_loadiffname(filepath, flags, NULL);
+  if (ibuf) {
+    *r_width = (size_t)ibuf->x;
+    *r_height = (size_t)ibuf->y;
+  }
+
+  return ibuf;
+}
+
 static void imb_loadtilefile(ImBuf *ibuf, int file, int tx, int ty, unsigned int *rect)
 {
   unsigned char *mem;
@@ -23,9 +23,13 @@
  */
 
 #include <math.h>
+#include <string.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -37,6 +41,10 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -1876,3 +1884,384 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
     ibuf->rect_float = init_data.float_buffer;
   }
 }
+
+/* ******** filtered scaling ******** */
+
+/* Separable resampling: filter weights are computed once for every destination column and row,
+ * then the image is filtered horizontally into a float buffer and vertically into the result.
+ * When down-scaling, the kernel is widened by the scale factor so it also acts as a low-pass
+ * filter. Both passes are threaded over rows, 4 channel pixels are accumulated with SSE2. */
+
+typedef struct ScaleFilterWeights {
+  /* First source pixel and amount of source pixels contributing to each destination pixel. */
+  int *first;
+  int *count;
+  /* `taps` weights for each destination pixel, normalized to sum up to 1. */
+  float *weights;
+  int taps;
+} ScaleFilterWeights;
+
+static float scale_filter_radius(eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_BICUBIC:
+      return 2.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  return 1.0f;
+}
+
+static float scale_filter_sinc(float x)
+{
+  if (x == 0.0f) {
+    return 1.0f;
+  }
+  x *= (float)M_PI;
+  return sinf(x) / x;
+}
+
+static float scale_filter_kernel(eIMBScaleFilter filter, float x)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      x = fabsf(x);
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_BICUBIC: {
+      /* Catmull-Rom spline (Keys cubic with a = -0.5). */
+      x = fabsf(x);
+      if (x < 1.0f) {
+        return (1.5f * x - 2.5f) * x * x + 1.0f;
+      }
+      if (x < 2.0f) {
+        return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+      }
+      return 0.0f;
+    }
+    case IMB_SCALE_FILTER_LANCZOS:
+      return (fabsf(x) < 3.0f) ? scale_filter_sinc(x) * scale_filter_sinc(x / 3.0f) : 0.0f;
+  }
+  return 0.0f;
+}
+
+static void scale_filter_weights_init(ScaleFilterWeights *w,
+                                      eIMBScaleFilter filter,
+                                      int src_size,
+                                      int dst_size)
+{
+  const float scale = (float)dst_size / (float)src_size;
+  const float filter_scale = max_ff(1.0f / scale, 1.0f);
+  const float support = scale_filter_radius(filter) * filter_scale;
+
+  w->taps = (int)ceilf(support) * 2 + 2;
+  w->first = MEM_mallocN(sizeof(int) * dst_size, __func__);
+  w->count = MEM_mallocN(sizeof(int) * dst_size, __func__);
+  w->weights = MEM_callocN(sizeof(float) * dst_size * w->taps, __func__);
+
+  for (int i = 0; i < dst_size; i++) {
+    /* Pixel centers are at half integer coordinates. */
+    const float center = ((float)i + 0.5f) / scale;
+    int first = max_ii((int)floorf(center - support), 0);
+    int last = min_ii((int)ceilf(center + support), src_size - 1);
+    float *weights = w->weights + (size_t)i * w->taps;
+    float sum = 0.0f;
+
+    last = min_ii(last, first + w->taps - 1);
+
+    /* Skip pixels outside of the kernel, box and triangle kernels have zero tails. */
+    while (first < last &&
+           scale_filter_kernel(filter, ((float)first + 0.5f - center) / filter_scale) == 0.0f) {
+      first++;
+    }
+    while (last > first &&
+           scale_filter_kernel(filter, ((float)last + 0.5f - center) / filter_scale) == 0.0f) {
+      last--;
+    }
+
+    for (int j = first; j <= last; j++) {
+      weights[j - first] = scale_filter_kernel(filter, ((float)j + 0.5f - center) / filter_scale);
+      sum += weights[j - first];
+    }
+
+    if (sum != 0.0f) {
+      for (int j = first; j <= last; j++) {
+        weights[j - first] /= sum;
+      }
+    }
+    else {
+      /* Can only happen with degenerate sizes, fall back to the nearest pixel. */
+      first = last = clamp_i((int)center, 0, src_size - 1);
+      weights[0] = 1.0f;
+    }
+
+    w->first[i] = first;
+    w->count[i] = last - first + 1;
+  }
+}
+
+static void scale_filter_weights_free(ScaleFilterWeights *w)
+{
+  MEM_freeN(w->first);
+  MEM_freeN(w->count);
+  MEM_freeN(w->weights);
+}
+
+typedef struct ScaleFilterData {
+  ScaleFilterWeights weights_x, weights_y;
+  int src_x, src_y;
+  int dst_x, dst_y;
+  int channels;
+
+  const unsigned char *src_byte;
+  const float *src_float;
+  /* Horizontally filtered image of `dst_x * src_y` pixels. */
+  float *tmp;
+  unsigned char *dst_byte;
+  float *dst_float;
+} ScaleFilterData;
+
+BLI_INLINE void scale_filter_accumulate_float4(float r[4],
+                                               const float *src,
+                                               const float *weights,
+                                               int count,
+                                               size_t stride)
+{
+#ifdef __SSE2__
+  __m128 sum = _mm_setzero_ps();
+  for (int k = 0; k < count; k++, src += stride) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(weights[k])));
+  }
+  _mm_storeu_ps(r, sum);
+#else
+  zero_v4(r);
+  for (int k = 0; k < count; k++, src += stride) {
+    madd_v4_v4fl(r, src, weights[k]);
+  }
+#endif
+}
+
+BLI_INLINE void scale_filter_accumulate_byte4(float r[4],
+                                              const unsigned char *src,
+                                              const float *weights,
+                                              int count)
+{
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  __m128 sum = _mm_setzero_ps();
+  for (int k = 0; k < count; k++, src += 4) {
+    int packed;
+    memcpy(&packed, src, sizeof(packed));
+    const __m128i px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero),
+                                          zero);
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(px), _mm_set1_ps(weights[k])));
+  }
+  _mm_storeu_ps(r, sum);
+#else
+  zero_v4(r);
+  for (int k = 0; k < count; k++, src += 4) {
+    r[0] += src[0] * weights[k];
+    r[1] += src[1] * weights[k];
+    r[2] += src[2] * weights[k];
+    r[3] += src[3] * weights[k];
+  }
+#endif
+}
+
+static void scale_filter_horizontal_task(void *__restrict userdata,
+                                         const int y,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterWeights *w = &data->weights_x;
+  const int channels = data->channels;
+  float *dst = data->tmp + (size_t)y * data->dst_x * channels;
+
+  for (int x = 0; x < data->dst_x; x++, dst += channels) {
+    const float *weights = w->weights + (size_t)x * w->taps;
+    const size_t src_index = (size_t)y * data->src_x + w->first[x];
+
+    if (data->src_byte) {
+      scale_filter_accumulate_byte4(dst, data->src_byte + src_index * 4, weights, w->count[x]);
+    }
+    else if (channels == 4) {
+      scale_filter_accumulate_float4(
+          dst, data->src_float + src_index * 4, weights, w->count[x], 4);
+    }
+    else {
+      const float *src = data->src_float + src_index * channels;
+      for (int c = 0; c < channels; c++) {
+        dst[c] = 0.0f;
+      }
+      for (int k = 0; k < w->count[x]; k++, src += channels) {
+        for (int c = 0; c < channels; c++) {
+          dst[c] += src[c] * weights[k];
+        }
+      }
+    }
+  }
+}
+
+static void scale_filter_vertical_task(void *__restrict userdata,
+                                       const int y,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterWeights *w = &data->weights_y;
+  const int channels = data->channels;
+  const size_t stride = (size_t)data->dst_x * channels;
+  const float *weights = w->weights + (size_t)y * w->taps;
+  const int count = w->count[y];
+  const float *src = data->tmp + (size_t)w->first[y] * stride;
+
+  for (int x = 0; x < data->dst_x; x++, src += channels) {
+    const size_t dst_index = ((size_t)y * data->dst_x + x) * channels;
+
+    if (channels == 4) {
+      float result[4];
+      scale_filter_accumulate_float4(result, src, weights, count, stride);
+
+      if (data->dst_byte) {
+        unsigned char *dst = data->dst_byte + dst_index;
+        dst[0] = unit_float_to_uchar_clamp(result[0] * (1.0f / 255.0f));
+        dst[1] = unit_float_to_uchar_clamp(result[1] * (1.0f / 255.0f));
+        dst[2] = unit_float_to_uchar_clamp(result[2] * (1.0f / 255.0f));
+        dst[3] = unit_float_to_uchar_clamp(result[3] * (1.0f / 255.0f));
+      }
+      else {
+        copy_v4_v4(data->dst_float + dst_index, result);
+      }
+    }
+    else {
+      float *dst = data->dst_float + dst_index;
+      for (int c = 0; c < channels; c++) {
+        dst[c] = 0.0f;
+      }
+      for (int k = 0; k < count; k++) {
+        const float *row = src + k * stride;
+        for (int c = 0; c < channels; c++) {
+          dst[c] += row[c] * weights[k];
+        }
+      }
+    }
+  }
+}
+
+static void scale_filter_buffer(ScaleFilterData *data)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 8;
+
+  data->tmp = MEM_mallocN(sizeof(float) * data->channels * data->dst_x * data->src_y, __func__);
+
+  BLI_task_parallel_range(0, data->src_y, data, scale_filter_horizontal_task, &settings);
+  BLI_task_parallel_range(0, data->dst_y, data, scale_filter_vertical_task, &settings);
+
+  MEM_freeN(data->tmp);
+  data->tmp = NULL;
+}
+
+/**
+ * Resample \a ibuf into \a ibuf_out, using the size of \a ibuf_out.
+ * Byte and float buffers which exist in both images are filtered.
+ */
+void IMB_scale_into_ImBuf(const ImBuf *ibuf, ImBuf *ibuf_out, eIMBScaleFilter filter)
+{
+  ScaleFilterData data = {{NULL}};
+
+  if (ibuf->x <= 0 || ibuf->y <= 0 || ibuf_out->x <= 0 || ibuf_out->y <= 0) {
+    return;
+  }
+
+  data.src_x = ibuf->x;
+  data.src_y = ibuf->y;
+  data.dst_x = ibuf_out->x;
+  data.dst_y = ibuf_out->y;
+
+  scale_filter_weights_init(&data.weights_x, filter, data.src_x, data.dst_x);
+  scale_filter_weights_init(&data.weights_y, filter, data.src_y, data.dst_y);
+
+  if (ibuf->rect && ibuf_out->rect) {
+    data.channels = 4;
+    data.src_byte = (const unsigned char *)ibuf->rect;
+    data.dst_byte = (unsigned char *)ibuf_out->rect;
+    scale_filter_buffer(&data);
+    data.src_byte = NULL;
+    data.dst_byte = NULL;
+  }
+
+  if (ibuf->rect_float && ibuf_out->rect_float) {
+    BLI_assert(ibuf->channels == ibuf_out->channels);
+    data.channels = ibuf->channels;
+    data.src_float = ibuf->rect_float;
+    data.dst_float = ibuf_out->rect_float;
+    scale_filter_buffer(&data);
+  }
+
+  scale_filter_weights_free(&data.weights_x);
+  scale_filter_weights_free(&data.weights_y);
+}
+
+/**
+ * Scale \a ibuf using a separable filter, multi-threaded.
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             eIMBScaleFilter filter)
+{
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+  if (newx == 0 || newy == 0) {
+    return false;
+  }
+
+  /* Z-buffers are not filtered, same as in #IMB_scaleImBuf. */
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  ImBuf ibuf_out = {NULL};
+  ibuf_out.x = newx;
+  ibuf_out.y = newy;
+  ibuf_out.channels = ibuf->channels;
+
+  if (ibuf->rect) {
+    ibuf_out.rect = MEM_mallocN(sizeof(uint) * newx * newy, "filtered scale byte buffer");
+  }
+  if (ibuf->rect_float) {
+    ibuf_out.rect_float = MEM_mallocN(sizeof(float) * ibuf->channels * newx * newy,
+                                      "filtered scale float buffer");
+  }
+
+  IMB_scale_into_ImBuf(ibuf, &ibuf_out, filter);
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+
+  if (ibuf->rect) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = ibuf_out.rect;
+  }
+
+  if (ibuf->rect_float) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = ibuf_out.rect_float;
+  }
+
+  return true;
+}
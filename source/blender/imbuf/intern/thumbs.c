@@ -339,6 +339,7 @@ static ImBuf *thumb_create_ex(const char *file_path,
   char cheight[40] = "0";
   short tsize = 128;
   short ex, ey;
+  size_t image_width = 0, image_height = 0;
   float scaledx, scaledy;
   BLI_stat_t info;
 
@@ -384,7 +385,7 @@ static ImBuf *thumb_create_ex(const char *file_path,
         if (img == NULL) {
           switch (source) {
             case THB_SOURCE_IMAGE:
-              img = IMB_loadiffname(file_path, IB_rect | IB_metadata, NULL);
+              img = IMB_thumb_load_image(file_path, (size_t)tsize, &image_width, &image_height);
               break;
             case THB_SOURCE_BLEND:
               img = IMB_thumb_load_blend(file_path, blen_group, blen_id);
@@ -401,8 +402,12 @@ static ImBuf *thumb_create_ex(const char *file_path,
           if (BLI_stat(file_path, &info) != -1) {
             BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
           }
-          BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-          BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+          if (source != THB_SOURCE_IMAGE) {
+            image_width = (size_t)img->x;
+            image_height = (size_t)img->y;
+          }
+          BLI_snprintf(cwidth, sizeof(cwidth), "%zu", image_width);
+          BLI_snprintf(cheight, sizeof(cheight), "%zu", image_height);
         }
       }
       else if (THB_SOURCE_MOVIE == source) {
@@ -447,7 +452,7 @@ static ImBuf *thumb_create_ex(const char *file_path,
         imb_freerectfloatImBuf(img);
       }
 
-      IMB_scaleImBuf(img, ex, ey);
+      IMB_scaleImBuf_filtered(img, ex, ey, IMB_SCALE_FILTER_BILINEAR);
     }
     BLI_snprintf(desc, sizeof(desc), "Thumbnail for %s", uri);
     IMB_metadata_ensure(&img->metadata);
@@ -217,6 +217,9 @@ void USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
     write_uv_maps(mesh, usd_mesh);
   }
   if (usd_export_context_.export_params.export_normals) {
+    if (mesh->flag & ME_AUTOSMOOTH) {
+      BKE_mesh_ensure_normals_split(mesh);
+    }
     write_normals(mesh, usd_mesh);
   }
   write_surface_velocity(context.object, mesh, usd_mesh);
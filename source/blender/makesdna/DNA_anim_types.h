@@ -1106,6 +1106,8 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, RNA paths of the action's F-Curves resolved for evaluation. */
+  struct AnimFCurveBindings *fcurve_bindings;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -177,7 +177,9 @@ typedef struct ClothSimSettings {
   float internal_compression;
   float max_internal_tension;
   float max_internal_compression;
-  char _pad0[4];
+  /** Pre-conditioner of the conjugate gradient solver, see #CLOTH_PRECONDITIONER. */
+  char preconditioner;
+  char _pad0[3];
 
 } ClothSimSettings;
 
@@ -216,6 +218,13 @@ typedef enum {
   CLOTH_BENDING_ANGULAR = 1,
 } CLOTH_BENDING_MODEL;
 
+/* ClothSimSettings.preconditioner. */
+typedef enum {
+  CLOTH_PRECONDITIONER_NONE = 0,
+  CLOTH_PRECONDITIONER_JACOBI = 1,
+  CLOTH_PRECONDITIONER_BLOCK_JACOBI = 2,
+} CLOTH_PRECONDITIONER;
+
 typedef struct ClothCollSettings {
   /** E.g. pointer to temp memory for collisions. */
   struct LinkNode *collision_list;
@@ -165,6 +165,7 @@
     .error = "", \
     .cache_type = FLUID_DOMAIN_CACHE_REPLAY, \
     .cache_id = "", \
+    .cache_prefetch_frames = 10, \
     .dt = 0.0f, \
     .time_total = 0.0f, \
     .time_per_frame = 0.0f, \
@@ -664,7 +664,8 @@ typedef struct FluidDomainSettings {
   char error[64]; /* Bake error description. */
   short cache_type;
   char cache_id[4]; /* Run-time only */
-  char _pad9[2];    /* Unused. */
+  /* Number of frames read ahead of playback. */
+  short cache_prefetch_frames;
 
   /* Time options. */
   float dt;
@@ -36,6 +36,7 @@ extern "C" {
 
 struct AnimData;
 struct Ipo;
+struct KeyBlockDeltas;
 
 typedef struct KeyBlock {
   struct KeyBlock *next, *prev;
@@ -73,6 +74,8 @@ typedef struct KeyBlock {
   float slidermin;
   float slidermax;
 
+  /** Runtime only: offsets of changed elements from the relative key (evaluated keys only). */
+  struct KeyBlockDeltas *deltas;
 } KeyBlock;
 
 typedef struct Key {
@@ -65,6 +65,7 @@
     .col_mask = 0xffff, \
     .preview = NULL, \
     .duplicator_visibility_flag = OB_DUPLI_FLAG_VIEWPORT | OB_DUPLI_FLAG_RENDER, \
+    .playback_cache_memory = 1024, \
     .pc_ids = {NULL, NULL}, \
   }
 
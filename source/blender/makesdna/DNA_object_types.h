@@ -189,6 +189,12 @@ typedef struct Object_Runtime {
   /** Runtime evaluated curve-specific data, not stored in the file. */
   struct CurveCache *curve_cache;
 
+  /**
+   * Evaluated meshes of previously evaluated frames, only stored on the original object.
+   * Owned by the object.
+   */
+  struct MeshPlaybackCache *playback_cache;
+
   unsigned short local_collections_bits;
   short _pad2[3];
 } Object_Runtime;
@@ -310,7 +316,8 @@ typedef struct Object {
   /** Used for DopeSheet filtering settings (expanded/collapsed). */
   short nlaflag;
 
-  char _pad1;
+  /** Settings for caching evaluated geometry, see #Object_Runtime.playback_cache. */
+  char playback_cache_flag;
   char duplicator_visibility_flag;
 
   /* Depsgraph */
@@ -345,7 +352,8 @@ typedef struct Object {
   unsigned short actdef;
   /** Current face map, note: index starts at 1. */
   unsigned short actfmap;
-  char _pad2[2];
+  /** Memory limit of the playback cache in megabytes, zero for no limit. */
+  unsigned short playback_cache_memory;
   /** Object color (in most cases the material color is used for drawing). */
   float color[4];
 
@@ -633,6 +641,12 @@ enum {
 #  define OB_FLAG_UNUSED_12 (1 << 12) /* cleared */
 #endif
 
+/* ob->playback_cache_flag */
+enum {
+  OB_PLAYBACK_CACHE = 1 << 0,
+  OB_PLAYBACK_CACHE_QUANTIZE = 1 << 1,
+};
+
 /* ob->restrictflag */
 enum {
   OB_RESTRICT_VIEWPORT = 1 << 0,
@@ -153,6 +153,8 @@ typedef struct PointCache {
 #define PTCACHE_IGNORE_CLEAR (1 << 13)
 
 #define PTCACHE_FLAG_INFO_DIRTY (1 << 14)
+/** Store all disk cache frames in a single archive file instead of one file per frame. */
+#define PTCACHE_DISK_ARCHIVE (1 << 15)
 
 /* PTCACHE_OUTDATED + PTCACHE_FRAMES_SKIPPED */
 #define PTCACHE_REDO_NEEDED 258
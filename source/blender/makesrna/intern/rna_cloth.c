@@ -561,6 +561,16 @@ static void rna_def_cloth_solver_result(BlenderRNA *brna)
   RNA_def_property_clear_flag(prop, PROP_EDITABLE);
   RNA_def_property_ui_text(prop, "Average Iterations", "Average iterations during substeps");
 
+  prop = RNA_def_property(srna, "max_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "max_time");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop, "Maximum Time", "Maximum time in seconds to compute a substep");
+
+  prop = RNA_def_property(srna, "avg_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "avg_time");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop, "Average Time", "Average time in seconds to compute a substep");
+
   RNA_define_verify_sdna(1);
 }
 
@@ -579,6 +589,22 @@ static void rna_def_cloth_sim_settings(BlenderRNA *brna)
       {0, NULL, 0, NULL, NULL},
   };
 
+  static const EnumPropertyItem prop_preconditioner_items[] = {
+      {CLOTH_PRECONDITIONER_NONE, "NONE", 0, "None", "Solve without pre-conditioning"},
+      {CLOTH_PRECONDITIONER_JACOBI,
+       "JACOBI",
+       0,
+       "Jacobi",
+       "Scale by the inverse diagonal of the system, cheap but less effective"},
+      {CLOTH_PRECONDITIONER_BLOCK_JACOBI,
+       "BLOCK_JACOBI",
+       0,
+       "Block Jacobi",
+       "Multiply by the inverse of the 3x3 block of each vertex, converging in fewer iterations "
+       "for stiff cloth"},
+      {0, NULL, 0, NULL, NULL},
+  };
+
   srna = RNA_def_struct(brna, "ClothSettings", NULL);
   RNA_def_struct_ui_text(srna, "Cloth Settings", "Cloth simulation settings for an object");
   RNA_def_struct_sdna(srna, "ClothSimSettings");
@@ -695,6 +721,13 @@ static void rna_def_cloth_sim_settings(BlenderRNA *brna)
       "Quality of the simulation in steps per frame (higher is better quality but slower)");
   RNA_def_property_update(prop, 0, "rna_cloth_update");
 
+  prop = RNA_def_property(srna, "preconditioner", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "preconditioner");
+  RNA_def_property_enum_items(prop, prop_preconditioner_items);
+  RNA_def_property_ui_text(
+      prop, "Pre-conditioner", "Pre-conditioner of the solver, to converge in fewer iterations");
+  RNA_def_property_update(prop, 0, "rna_cloth_update");
+
   prop = RNA_def_property(srna, "time_scale", PROP_FLOAT, PROP_NONE);
   RNA_def_property_float_sdna(prop, NULL, "time_scale");
   RNA_def_property_range(prop, 0.0f, FLT_MAX);
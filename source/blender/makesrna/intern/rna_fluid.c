@@ -2328,6 +2328,17 @@ static void rna_def_fluid_domain_settings(BlenderRNA *brna)
       "when baking the simulation, only when loading it");
   RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
 
+  prop = RNA_def_property(srna, "cache_prefetch_frames", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "cache_prefetch_frames");
+  RNA_def_property_range(prop, 0, 250);
+  RNA_def_property_ui_range(prop, 0, 100, 1, -1);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Frames",
+                           "Number of frames whose cache files are read from disk in the "
+                           "background ahead of playback (0 to disable). This only reads the "
+                           "files ahead, frames are still decoded when they are shown");
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+
   prop = RNA_def_property(srna, "cache_frame_pause_data", PROP_INT, PROP_TIME);
   RNA_def_property_int_sdna(prop, NULL, "cache_frame_pause_data");
 
@@ -329,10 +329,20 @@ static void rna_MEdge_crease_set(PointerRNA *ptr, float value)
   medge->crease = round_fl_to_uchar_clamp(value * 255.0f);
 }
 
+/* Split normals of evaluated meshes may only be calculated on access,
+ * see #BKE_mesh_ensure_normals_split. */
+static void rna_mesh_ensure_normals_split(Mesh *me)
+{
+  if (me->runtime.cd_dirty_loop & CD_MASK_NORMAL) {
+    BKE_mesh_ensure_normals_split(me);
+  }
+}
+
 static void rna_MeshLoop_normal_get(PointerRNA *ptr, float *values)
 {
   Mesh *me = rna_mesh(ptr);
   MLoop *ml = (MLoop *)ptr->data;
+  rna_mesh_ensure_normals_split(me);
   const float(*vec)[3] = CustomData_get(&me->ldata, (int)(ml - me->mloop), CD_NORMAL);
 
   if (!vec) {
@@ -347,6 +357,7 @@ static void rna_MeshLoop_normal_set(PointerRNA *ptr, const float *values)
 {
   Mesh *me = rna_mesh(ptr);
   MLoop *ml = (MLoop *)ptr->data;
+  rna_mesh_ensure_normals_split(me);
   float(*vec)[3] = CustomData_get(&me->ldata, (int)(ml - me->mloop), CD_NORMAL);
 
   if (vec) {
@@ -449,6 +460,7 @@ static void rna_MeshLoopTriangle_normal_get(PointerRNA *ptr, float *values)
 static void rna_MeshLoopTriangle_split_normals_get(PointerRNA *ptr, float *values)
 {
   Mesh *me = rna_mesh(ptr);
+  rna_mesh_ensure_normals_split(me);
   const float(*lnors)[3] = CustomData_get_layer(&me->ldata, CD_NORMAL);
 
   if (!lnors) {
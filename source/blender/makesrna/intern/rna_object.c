@@ -3276,6 +3276,32 @@ static void rna_def_object(BlenderRNA *brna)
   RNA_def_property_override_flag(prop, PROPOVERRIDE_NO_COMPARISON);
   RNA_def_property_override_clear_flag(prop, PROPOVERRIDE_OVERRIDABLE_LIBRARY);
 
+  /* playback cache */
+  prop = RNA_def_property(srna, "use_playback_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "playback_cache_flag", OB_PLAYBACK_CACHE);
+  RNA_def_property_ui_text(prop,
+                           "Playback Cache",
+                           "Keep the evaluated mesh of every played frame in memory, to replay "
+                           "animation without evaluating the modifiers again. Only meshes with the "
+                           "same topology on all frames are cached");
+  RNA_def_property_update(prop, NC_OBJECT | ND_DRAW, "rna_Object_internal_update_data");
+
+  prop = RNA_def_property(srna, "use_playback_cache_quantize", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "playback_cache_flag", OB_PLAYBACK_CACHE_QUANTIZE);
+  RNA_def_property_ui_text(prop,
+                           "Quantize",
+                           "Store cached vertex positions with 16 bits per axis within the bounds "
+                           "of the mesh, using half the memory at reduced precision");
+  RNA_def_property_update(prop, NC_OBJECT | ND_DRAW, "rna_Object_internal_update_data");
+
+  prop = RNA_def_property(srna, "playback_cache_memory", PROP_INT, PROP_NONE);
+  RNA_def_property_range(prop, 0, USHRT_MAX);
+  RNA_def_property_ui_text(prop,
+                           "Memory Limit",
+                           "Memory used by the cached frames (in megabytes), no more frames are "
+                           "cached once it is reached (0 for no limit)");
+  RNA_def_property_update(prop, NC_OBJECT | ND_DRAW, "rna_Object_internal_update_data");
+
   /* drawing */
   prop = RNA_def_property(srna, "display_type", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_sdna(prop, NULL, "dt");
@@ -252,6 +252,26 @@ static void rna_Cache_toggle_disk_cache(Main *UNUSED(bmain), Scene *UNUSED(scene
   }
 }
 
+static void rna_Cache_toggle_disk_archive(Main *UNUSED(bmain),
+                                          Scene *UNUSED(scene),
+                                          PointerRNA *ptr)
+{
+  Object *ob = NULL;
+  Scene *scene = NULL;
+
+  if (!rna_Cache_get_valid_owner_ID(ptr, &ob, &scene)) {
+    return;
+  }
+
+  PointCache *cache = (PointCache *)ptr->data;
+
+  PTCacheID pid = BKE_ptcache_id_find(ob, scene, cache);
+
+  if (pid.cache) {
+    BKE_ptcache_toggle_disk_archive(&pid);
+  }
+}
+
 static void rna_Cache_idname_change(Main *UNUSED(bmain), Scene *UNUSED(scene), PointerRNA *ptr)
 {
   Object *ob = NULL;
@@ -988,6 +1008,14 @@ static void rna_def_pointcache_common(StructRNA *srna)
       prop, "Disk Cache", "Save cache files to disk (.blend file must be saved first)");
   RNA_def_property_update(prop, NC_OBJECT, "rna_Cache_toggle_disk_cache");
 
+  prop = RNA_def_property(srna, "use_disk_archive", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", PTCACHE_DISK_ARCHIVE);
+  RNA_def_property_ui_text(prop,
+                           "Single File",
+                           "Store all frames of the disk cache in one indexed archive file, "
+                           "compressed in the background with the fast method");
+  RNA_def_property_update(prop, NC_OBJECT, "rna_Cache_toggle_disk_archive");
+
   prop = RNA_def_property(srna, "is_outdated", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", PTCACHE_OUTDATED);
   RNA_def_property_clear_flag(prop, PROP_EDITABLE);
@@ -943,6 +943,18 @@ static void rna_def_rigidbody_world(BlenderRNA *brna)
       "stability a little so use only when necessary)");
   RNA_def_property_update(prop, NC_SCENE, "rna_RigidBodyWorld_reset");
 
+  prop = RNA_def_property(srna, "use_multithreading", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", RBW_FLAG_USE_MULTITHREADING);
+  RNA_def_property_ui_text(prop,
+                           "Multi-Threading",
+                           "Solve collisions and simulation islands on multiple threads (faster "
+                           "for many objects, results can differ slightly between runs). Only "
+                           "available in builds with thread-safe Bullet (WITH_BULLET_THREADS)");
+#  ifndef WITH_BULLET_THREADS
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+#  endif
+  RNA_def_property_update(prop, NC_SCENE, "rna_RigidBodyWorld_reset");
+
   /* cache */
   prop = RNA_def_property(srna, "point_cache", PROP_POINTER, PROP_NONE);
   RNA_def_property_flag(prop, PROP_NEVER_NULL);
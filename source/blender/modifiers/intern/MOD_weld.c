@@ -33,12 +33,14 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_utildefines.h"
 
 #include "BLI_alloca.h"
 #include "BLI_bitmap.h"
-#include "BLI_kdtree.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -1543,8 +1545,491 @@ static void customdata_weld(
   }
 }
 
+/* A group of elements merged into one element of the result. */
+typedef struct WeldGroupMerge {
+  const struct WeldGroup *group;
+  int dest_index;
+} WeldGroupMerge;
+
+typedef struct WeldGroupMergeData {
+  const CustomData *source;
+  CustomData *dest;
+  const uint *groups_buffer;
+  const WeldGroupMerge *merges;
+} WeldGroupMergeData;
+
+static void customdata_weld_groups_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const WeldGroupMergeData *data = userdata;
+  const WeldGroupMerge *merge = &data->merges[i];
+  customdata_weld(data->source,
+                  data->dest,
+                  &data->groups_buffer[merge->group->ofs],
+                  merge->group->len,
+                  merge->dest_index);
+}
+
+/**
+ * Merge the custom-data of each group, every group writes to its own destination element
+ * so this runs in parallel.
+ */
+static void customdata_weld_groups(const CustomData *source,
+                                   CustomData *dest,
+                                   const uint *groups_buffer,
+                                   const WeldGroupMerge *merges,
+                                   const uint merges_len)
+{
+  WeldGroupMergeData data = {
+      .source = source,
+      .dest = dest,
+      .groups_buffer = groups_buffer,
+      .merges = merges,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (merges_len > 1000);
+  BLI_task_parallel_range(0, (int)merges_len, &data, customdata_weld_groups_cb, &settings);
+}
+
 /** \} */
 
+#ifndef USE_BVHTREEKDOP
+
+/* -------------------------------------------------------------------- */
+/** \name Weld Vert Spatial Hash
+ *
+ * Finds the vertices to merge for #MOD_WELD_MODE_ALL. Vertices are binned into a uniform grid
+ * with cells twice the size of the merge distance, so vertices in range are in the cell of the
+ * vertex or in the neighboring cells on the side of the half of the cell the vertex is in.
+ * Cells are found with a hash of their coordinates, a hash collision only adds candidates that
+ * fail the range test.
+ *
+ * Vertices connected by chains of vertices in range are clustered with a union-find, in
+ * parallel. The result is the same as #BLI_kdtree_3d_calc_duplicates_fast visiting vertices in
+ * index order: a vertex that isn't merged takes all vertices in range that aren't merged yet.
+ * So when the lowest index vertex of a cluster is in range of all the others, they are all
+ * merged into it. Other clusters are split the same way as the KD-tree does, vertices in
+ * different clusters are never in range so every cluster is split on its own.
+ * \{ */
+
+#define WELD_GRID_CELL_NONE (uint)(-1)
+
+typedef struct WeldGridTableSlot {
+  uint64_t key;
+  uint cell;
+} WeldGridTableSlot;
+
+typedef struct WeldVertGrid {
+  const MVert *mvert;
+  double cell_size_inv;
+  float merge_dist_sq;
+
+  /* Open addressing hash table of the cells, `table_mask + 1` long. */
+  WeldGridTableSlot *table;
+  uint table_mask;
+
+  /* Vertices of cell `c` are `cell_verts[cell_offsets[c]]` to
+   * `cell_verts[cell_offsets[c + 1] - 1]`, in index order.
+   * Their coordinates are copied to `cell_cos`, so reading the vertices of a cell is cache
+   * friendly. */
+  uint *cell_offsets;
+  uint *cell_verts;
+  float (*cell_cos)[3];
+} WeldVertGrid;
+
+/* Cell coordinates of \a co, and the side of the neighboring cells in range. */
+static void weld_grid_cell(const WeldVertGrid *grid,
+                           const float co[3],
+                           int64_t r_cell[3],
+                           int r_side[3])
+{
+  for (int i = 0; i < 3; i++) {
+    /* Clamp, so huge coordinates don't overflow (they only end up sharing cells). */
+    const double co_grid = (double)co[i] * grid->cell_size_inv;
+    double cell = floor(co_grid);
+    r_side[i] = (co_grid - cell < 0.5) ? -1 : 1;
+    CLAMP(cell, -1e15, 1e15);
+    r_cell[i] = (int64_t)cell;
+  }
+}
+
+static uint64_t weld_grid_key(const int64_t cell[3])
+{
+  return ((uint64_t)cell[0] * 73856093u) ^ ((uint64_t)cell[1] * 19349663u) ^
+         ((uint64_t)cell[2] * 83492791u);
+}
+
+static WeldGridTableSlot *weld_grid_table_slot(const WeldVertGrid *grid, const uint64_t key)
+{
+  uint slot = (uint)((key * 0x9E3779B97F4A7C15ull) >> 32) & grid->table_mask;
+  while (grid->table[slot].cell != WELD_GRID_CELL_NONE && grid->table[slot].key != key) {
+    slot = (slot + 1) & grid->table_mask;
+  }
+  return &grid->table[slot];
+}
+
+typedef struct WeldGridKeysData {
+  const MVert *mvert;
+  const BLI_bitmap *v_mask;
+  const WeldVertGrid *grid;
+  uint64_t *vert_keys;
+} WeldGridKeysData;
+
+static void weld_grid_key_cb(void *__restrict userdata,
+                             const int i,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WeldGridKeysData *data = userdata;
+  if (data->v_mask && !BLI_BITMAP_TEST(data->v_mask, i)) {
+    return;
+  }
+  int64_t cell[3];
+  int side[3];
+  weld_grid_cell(data->grid, data->mvert[i].co, cell, side);
+  data->vert_keys[i] = weld_grid_key(cell);
+}
+
+static void weld_grid_create(const MVert *mvert,
+                             const uint mvert_len,
+                             const BLI_bitmap *v_mask,
+                             const uint v_mask_act,
+                             const float merge_dist,
+                             WeldVertGrid *r_grid)
+{
+  const uint verts_len = v_mask ? v_mask_act : mvert_len;
+  r_grid->mvert = mvert;
+  r_grid->cell_size_inv = 1.0 / (2.0 * (double)max_ff(merge_dist, FLT_EPSILON));
+  r_grid->merge_dist_sq = square_f(merge_dist);
+
+  /* There are never more cells than vertices, keep the table at most half full. */
+  r_grid->table_mask = power_of_2_max_u(verts_len * 2 + 1) - 1;
+  r_grid->table = MEM_malloc_arrayN(r_grid->table_mask + 1, sizeof(*r_grid->table), __func__);
+  for (uint slot = 0; slot <= r_grid->table_mask; slot++) {
+    r_grid->table[slot].cell = WELD_GRID_CELL_NONE;
+  }
+
+  uint64_t *vert_keys = MEM_malloc_arrayN(mvert_len, sizeof(*vert_keys), __func__);
+  WeldGridKeysData data = {
+      .mvert = mvert,
+      .v_mask = v_mask,
+      .grid = r_grid,
+      .vert_keys = vert_keys,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mvert_len > 10000);
+  BLI_task_parallel_range(0, (int)mvert_len, &data, weld_grid_key_cb, &settings);
+
+  /* Sort the vertices by cell, keeping them in index order within each cell. */
+  uint *vert_cells = MEM_malloc_arrayN(mvert_len, sizeof(*vert_cells), __func__);
+  r_grid->cell_offsets = MEM_calloc_arrayN(verts_len + 1, sizeof(uint), __func__);
+  uint cells_len = 0;
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask && !BLI_BITMAP_TEST(v_mask, i)) {
+      continue;
+    }
+    WeldGridTableSlot *slot = weld_grid_table_slot(r_grid, vert_keys[i]);
+    if (slot->cell == WELD_GRID_CELL_NONE) {
+      slot->key = vert_keys[i];
+      slot->cell = cells_len++;
+    }
+    vert_cells[i] = slot->cell;
+    r_grid->cell_offsets[vert_cells[i] + 1]++;
+  }
+  for (uint cell = 0; cell < cells_len; cell++) {
+    r_grid->cell_offsets[cell + 1] += r_grid->cell_offsets[cell];
+  }
+  r_grid->cell_verts = MEM_malloc_arrayN(verts_len, sizeof(uint), __func__);
+  r_grid->cell_cos = MEM_malloc_arrayN(verts_len, sizeof(*r_grid->cell_cos), __func__);
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask && !BLI_BITMAP_TEST(v_mask, i)) {
+      continue;
+    }
+    /* The offsets are moved while filling, to the start of the next cell. */
+    const uint j = r_grid->cell_offsets[vert_cells[i]]++;
+    r_grid->cell_verts[j] = i;
+    copy_v3_v3(r_grid->cell_cos[j], mvert[i].co);
+  }
+  /* Move them back. */
+  for (uint cell = cells_len; cell > 0; cell--) {
+    r_grid->cell_offsets[cell] = r_grid->cell_offsets[cell - 1];
+  }
+  r_grid->cell_offsets[0] = 0;
+
+  MEM_freeN(vert_keys);
+  MEM_freeN(vert_cells);
+}
+
+static void weld_grid_free(WeldVertGrid *grid)
+{
+  MEM_freeN(grid->table);
+  MEM_freeN(grid->cell_offsets);
+  MEM_freeN(grid->cell_verts);
+  MEM_freeN(grid->cell_cos);
+}
+
+/**
+ * Cells which may contain vertices in range of \a co, without duplicates.
+ * \return the number of cells.
+ */
+static int weld_grid_neighbor_cells(const WeldVertGrid *grid, const float co[3], uint r_cells[8])
+{
+  int64_t cell[3];
+  int side[3];
+  weld_grid_cell(grid, co, cell, side);
+  int cells_len = 0;
+  for (int i = 0; i < 8; i++) {
+    const int64_t cell_other[3] = {
+        cell[0] + ((i & 1) ? side[0] : 0),
+        cell[1] + ((i & 2) ? side[1] : 0),
+        cell[2] + ((i & 4) ? side[2] : 0),
+    };
+    const uint other = weld_grid_table_slot(grid, weld_grid_key(cell_other))->cell;
+    bool skip = (other == WELD_GRID_CELL_NONE);
+    for (int j = 0; j < cells_len && !skip; j++) {
+      skip = (r_cells[j] == other);
+    }
+    if (!skip) {
+      r_cells[cells_len++] = other;
+    }
+  }
+  return cells_len;
+}
+
+static uint weld_union_find_root(const uint *vert_root, uint index)
+{
+  while (vert_root[index] != index) {
+    index = vert_root[index];
+  }
+  return index;
+}
+
+/**
+ * Join the clusters of \a index_a and \a index_b, the root of a cluster is always its lowest
+ * index vertex. Roots are only ever set to a lower index, with an atomic compare and swap,
+ * so this is called from multiple threads.
+ */
+static void weld_union_find_join(uint *vert_root, uint index_a, uint index_b)
+{
+  while (true) {
+    index_a = weld_union_find_root(vert_root, index_a);
+    index_b = weld_union_find_root(vert_root, index_b);
+    if (index_a == index_b) {
+      return;
+    }
+    if (index_a < index_b) {
+      SWAP(uint, index_a, index_b);
+    }
+    if (atomic_cas_uint32(&vert_root[index_a], index_a, index_b) == index_a) {
+      return;
+    }
+  }
+}
+
+typedef struct WeldVertClusterData {
+  const WeldVertGrid *grid;
+  uint *vert_root;
+  /* Set for the roots of clusters with vertices out of range of the root. */
+  char *root_split;
+  /* Vertices of the clusters in #root_split, the vertices of the cluster of a root `r` are
+   * `split_verts[split_offsets[r]]` to `split_verts[split_offsets[r] + split_lengths[r] - 1]`,
+   * in index order. */
+  uint *split_offsets;
+  uint *split_lengths;
+  uint *split_verts;
+  uint *split_roots;
+  uint *vert_dest_map;
+} WeldVertClusterData;
+
+static void weld_vert_cluster_join_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WeldVertClusterData *data = userdata;
+  const WeldVertGrid *grid = data->grid;
+  const uint index = grid->cell_verts[i];
+  const float *co = grid->cell_cos[i];
+
+  uint cells[8];
+  const int cells_len = weld_grid_neighbor_cells(grid, co, cells);
+  for (int c = 0; c < cells_len; c++) {
+    for (uint j = grid->cell_offsets[cells[c]]; j < grid->cell_offsets[cells[c] + 1]; j++) {
+      const uint other = grid->cell_verts[j];
+      if (other >= index) {
+        /* Vertices in a cell are sorted by index, every pair is only joined once. */
+        break;
+      }
+      if (len_squared_v3v3(co, grid->cell_cos[j]) <= grid->merge_dist_sq) {
+        weld_union_find_join(data->vert_root, index, other);
+      }
+    }
+  }
+}
+
+static void weld_vert_cluster_root_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WeldVertClusterData *data = userdata;
+  const WeldVertGrid *grid = data->grid;
+  const uint index = grid->cell_verts[i];
+  const uint root = weld_union_find_root(data->vert_root, index);
+  if ((root != index) && (len_squared_v3v3(grid->cell_cos[i], grid->mvert[root].co) >
+                          grid->merge_dist_sq)) {
+    /* Only ever set, so there is no need for atomics. */
+    data->root_split[root] = true;
+  }
+}
+
+/* Split a cluster the same way #BLI_kdtree_3d_calc_duplicates_fast does. */
+static void weld_vert_cluster_split_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WeldVertClusterData *data = userdata;
+  const WeldVertGrid *grid = data->grid;
+  uint *vert_dest_map = data->vert_dest_map;
+  const uint root = data->split_roots[i];
+  const uint *verts = &data->split_verts[data->split_offsets[root]];
+  const uint verts_len = data->split_lengths[root];
+
+  for (uint v = 0; v < verts_len; v++) {
+    const uint index = verts[v];
+    if (vert_dest_map[index] != OUT_OF_CONTEXT) {
+      continue;
+    }
+    const float *co = grid->mvert[index].co;
+    bool found = false;
+
+    uint cells[8];
+    const int cells_len = weld_grid_neighbor_cells(grid, co, cells);
+    for (int c = 0; c < cells_len; c++) {
+      for (uint j = grid->cell_offsets[cells[c]]; j < grid->cell_offsets[cells[c] + 1]; j++) {
+        const uint other = grid->cell_verts[j];
+        /* Check the range first, vertices of other clusters are handled by other threads. */
+        if ((other == index) ||
+            (len_squared_v3v3(co, grid->cell_cos[j]) > grid->merge_dist_sq) ||
+            (vert_dest_map[other] != OUT_OF_CONTEXT)) {
+          continue;
+        }
+        vert_dest_map[other] = index;
+        found = true;
+      }
+    }
+    if (found) {
+      vert_dest_map[index] = index;
+    }
+  }
+}
+
+/**
+ * Fill \a r_vert_dest_map with the vertex each vertex is merged into, the target vertices map
+ * to themselves and vertices that are not merged to #OUT_OF_CONTEXT.
+ *
+ * \return the number of merged vertices.
+ */
+static uint weld_vert_dest_map_calc(const MVert *mvert,
+                                    const uint mvert_len,
+                                    const BLI_bitmap *v_mask,
+                                    const uint v_mask_act,
+                                    const float merge_dist,
+                                    uint *r_vert_dest_map)
+{
+  WeldVertGrid grid;
+  weld_grid_create(mvert, mvert_len, v_mask, v_mask_act, merge_dist, &grid);
+  const uint verts_len = v_mask ? v_mask_act : mvert_len;
+
+  WeldVertClusterData data = {
+      .grid = &grid,
+      .vert_root = MEM_malloc_arrayN(mvert_len, sizeof(uint), __func__),
+      .root_split = MEM_calloc_arrayN(mvert_len, sizeof(char), __func__),
+      .vert_dest_map = r_vert_dest_map,
+  };
+  range_vn_u(data.vert_root, (int)mvert_len, 0);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (verts_len > 10000);
+  BLI_task_parallel_range(0, (int)verts_len, &data, weld_vert_cluster_join_cb, &settings);
+  BLI_task_parallel_range(0, (int)verts_len, &data, weld_vert_cluster_root_cb, &settings);
+
+  /* Clusters in range of their root are merged into it. Roots have the lowest index of their
+   * cluster, so they are visited before the other vertices of the cluster. */
+  uint vert_kill_len = 0;
+  uint split_verts_len = 0;
+  uint split_roots_len = 0;
+  for (uint i = 0; i < mvert_len; i++) {
+    const uint root = weld_union_find_root(data.vert_root, i);
+    data.vert_root[i] = root;
+    r_vert_dest_map[i] = OUT_OF_CONTEXT;
+    if (data.root_split[root]) {
+      split_verts_len++;
+      split_roots_len += (root == i);
+    }
+    else if (root != i) {
+      r_vert_dest_map[i] = root;
+      r_vert_dest_map[root] = root;
+      vert_kill_len++;
+    }
+  }
+
+  if (split_roots_len) {
+    /* Gather the vertices of the other clusters in index order, these are split in parallel. */
+    data.split_offsets = MEM_malloc_arrayN(mvert_len, sizeof(uint), __func__);
+    data.split_lengths = MEM_calloc_arrayN(mvert_len, sizeof(uint), __func__);
+    data.split_verts = MEM_malloc_arrayN(split_verts_len, sizeof(uint), __func__);
+    data.split_roots = MEM_malloc_arrayN(split_roots_len, sizeof(uint), __func__);
+    for (uint i = 0; i < mvert_len; i++) {
+      if (data.root_split[data.vert_root[i]]) {
+        data.split_lengths[data.vert_root[i]]++;
+      }
+    }
+    uint offset = 0;
+    uint roots_len = 0;
+    for (uint i = 0; i < mvert_len; i++) {
+      if (data.root_split[i]) {
+        data.split_offsets[i] = offset;
+        offset += data.split_lengths[i];
+        data.split_lengths[i] = 0;
+        data.split_roots[roots_len++] = i;
+      }
+    }
+    for (uint i = 0; i < mvert_len; i++) {
+      const uint root = data.vert_root[i];
+      if (data.root_split[root]) {
+        data.split_verts[data.split_offsets[root] + data.split_lengths[root]++] = i;
+      }
+    }
+
+    settings.use_threading = (split_verts_len > 10000);
+    BLI_task_parallel_range(0, (int)split_roots_len, &data, weld_vert_cluster_split_cb, &settings);
+
+    for (uint i = 0; i < split_verts_len; i++) {
+      const uint index = data.split_verts[i];
+      if (!ELEM(r_vert_dest_map[index], OUT_OF_CONTEXT, index)) {
+        vert_kill_len++;
+      }
+    }
+
+    MEM_freeN(data.split_offsets);
+    MEM_freeN(data.split_lengths);
+    MEM_freeN(data.split_verts);
+    MEM_freeN(data.split_roots);
+  }
+
+  MEM_freeN(data.vert_root);
+  MEM_freeN(data.root_split);
+  weld_grid_free(&grid);
+  return vert_kill_len;
+}
+
+/** \} */
+
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Weld Modifier Main
  * \{ */
@@ -1694,18 +2179,8 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   }
 #else
   {
-    KDTree_3d *tree = BLI_kdtree_3d_new(v_mask ? v_mask_act : totvert);
-    for (uint i = 0; i < totvert; i++) {
-      if (!v_mask || BLI_BITMAP_TEST(v_mask, i)) {
-        BLI_kdtree_3d_insert(tree, i, mvert[i].co);
-      }
-      vert_dest_map[i] = OUT_OF_CONTEXT;
-    }
-
-    BLI_kdtree_3d_balance(tree);
-    vert_kill_len = BLI_kdtree_3d_calc_duplicates_fast(
-        tree, wmd->merge_dist, false, (int *)vert_dest_map);
-    BLI_kdtree_3d_free(tree);
+    vert_kill_len = weld_vert_dest_map_calc(
+        mvert, totvert, v_mask, (uint)v_mask_act, wmd->merge_dist, vert_dest_map);
   }
 #endif
   else {
@@ -1808,6 +2283,12 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
 
     /* Vertices */
 
+    /* Groups are merged after the unchanged elements are copied,
+     * every vertex group merges at least one killed vertex. */
+    WeldGroupMerge *merges = MEM_malloc_arrayN(
+        weld_mesh.vert_kill_len, sizeof(*merges), __func__);
+    uint merges_len = 0;
+
     uint *vert_final = vert_dest_map;
     uint *index_iter = &vert_final[0];
     int dest_index = 0;
@@ -1828,24 +2309,29 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
         break;
       }
       if (*index_iter != ELEM_MERGED) {
-        struct WeldGroup *wgroup = &weld_mesh.vert_groups[*index_iter];
-        customdata_weld(&mesh->vdata,
-                        &result->vdata,
-                        &weld_mesh.vert_groups_buffer[wgroup->ofs],
-                        wgroup->len,
-                        dest_index);
+        merges[merges_len].group = &weld_mesh.vert_groups[*index_iter];
+        merges[merges_len].dest_index = dest_index;
+        merges_len++;
         *index_iter = dest_index;
         dest_index++;
       }
     }
 
     BLI_assert(dest_index == result_nverts);
+    BLI_assert(merges_len <= weld_mesh.vert_kill_len);
+
+    customdata_weld_groups(
+        &mesh->vdata, &result->vdata, weld_mesh.vert_groups_buffer, merges, merges_len);
 
     /* Edges */
 
     uint *edge_final = weld_mesh.edge_groups_map;
     index_iter = &edge_final[0];
     dest_index = 0;
+    /* Edge groups may not merge any edge, there is at most one for every edge of the result. */
+    MEM_freeN(merges);
+    merges = MEM_malloc_arrayN(result_nedges, sizeof(*merges), __func__);
+    merges_len = 0;
     for (uint i = 0; i < totedge; i++, index_iter++) {
       int source_index = i;
       int count = 0;
@@ -1868,23 +2354,29 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
         break;
       }
       if (*index_iter != ELEM_MERGED) {
-        struct WeldGroupEdge *wegrp = &weld_mesh.edge_groups[*index_iter];
-        customdata_weld(&mesh->edata,
-                        &result->edata,
-                        &weld_mesh.edge_groups_buffer[wegrp->group.ofs],
-                        wegrp->group.len,
-                        dest_index);
-        MEdge *me = &result->medge[dest_index];
-        me->v1 = vert_final[wegrp->v1];
-        me->v2 = vert_final[wegrp->v2];
-        me->flag |= ME_LOOSEEDGE;
-
+        merges[merges_len].group = &weld_mesh.edge_groups[*index_iter].group;
+        merges[merges_len].dest_index = dest_index;
+        merges_len++;
         *index_iter = dest_index;
         dest_index++;
       }
     }
 
     BLI_assert(dest_index == result_nedges);
+    BLI_assert(merges_len <= (uint)result_nedges);
+
+    customdata_weld_groups(
+        &mesh->edata, &result->edata, weld_mesh.edge_groups_buffer, merges, merges_len);
+
+    for (uint i = 0; i < merges_len; i++) {
+      const struct WeldGroupEdge *wegrp = (const struct WeldGroupEdge *)merges[i].group;
+      MEdge *me = &result->medge[merges[i].dest_index];
+      me->v1 = vert_final[wegrp->v1];
+      me->v2 = vert_final[wegrp->v2];
+      me->flag |= ME_LOOSEEDGE;
+    }
+
+    MEM_freeN(merges);
 
     /* Polys/Loops */
 
@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_kdtree.h"
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+#include "BLI_span.hh"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
+
+#include "MOD_modifiertypes.h"
+
+namespace blender::modifiers::tests {
+
+static Mesh *weld_apply(Mesh *mesh,
+                        const float merge_dist,
+                        const char mode,
+                        Object *ob = nullptr,
+                        const char *defgrp_name = "",
+                        const char flag = 0)
+{
+  WeldModifierData wmd = {{nullptr}};
+  wmd.modifier.type = eModifierType_Weld;
+  wmd.merge_dist = merge_dist;
+  wmd.mode = mode;
+  wmd.flag = flag;
+  STRNCPY(wmd.defgrp_name, defgrp_name);
+
+  Object ob_default = {{nullptr}};
+  ModifierEvalContext ctx = {nullptr, ob ? ob : &ob_default, (ModifierApplyFlag)0};
+  return modifierType_Weld.modifyMesh(&wmd.modifier, &ctx, mesh);
+}
+
+static void weld_result_free(Mesh *result, Mesh *mesh)
+{
+  if (result != mesh) {
+    BKE_id_free(nullptr, result);
+  }
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Vertices at the given positions along the X axis, edges are left to the caller. */
+static Mesh *mesh_verts_new(const Span<float> positions, const int edges_len = 0)
+{
+  Mesh *mesh = BKE_mesh_new_nomain((int)positions.size(), edges_len, 0, 0, 0);
+  for (const int i : positions.index_range()) {
+    mesh->mvert[i].co[0] = positions[i];
+  }
+  return mesh;
+}
+
+class weld_modifier : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    /* Needed to free meshes. */
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(weld_modifier, CoincidentClusters)
+{
+  /* Fan of three triangles, each with its own copy of the center vertex. The outer vertices are
+   * shared by neighboring triangles, also as separate copies. */
+  Mesh *mesh = BKE_mesh_new_nomain(9, 0, 0, 9, 3);
+  for (int i = 0; i < 3; i++) {
+    const float angle_a = (float)i * (float)M_PI * 2.0f / 3.0f;
+    const float angle_b = (float)(i + 1) * (float)M_PI * 2.0f / 3.0f;
+    zero_v3(mesh->mvert[i * 3].co);
+    mesh->mvert[i * 3 + 1].co[0] = cosf(angle_a);
+    mesh->mvert[i * 3 + 1].co[1] = sinf(angle_a);
+    mesh->mvert[i * 3 + 2].co[0] = cosf(angle_b);
+    mesh->mvert[i * 3 + 2].co[1] = sinf(angle_b);
+    mesh->mpoly[i].loopstart = i * 3;
+    mesh->mpoly[i].totloop = 3;
+    for (int j = 0; j < 3; j++) {
+      mesh->mloop[i * 3 + j].v = (uint)(i * 3 + j);
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  Mesh *result = weld_apply(mesh, 0.001f, MOD_WELD_MODE_ALL);
+  EXPECT_EQ(result->totvert, 4);
+  EXPECT_EQ(result->totedge, 6);
+  EXPECT_EQ(result->totpoly, 3);
+  EXPECT_EQ(result->totloop, 9);
+  weld_result_free(result, mesh);
+}
+
+TEST_F(weld_modifier, Chain)
+{
+  /* Each vertex is in range of the next, but vertices are never merged into merged vertices,
+   * so the chain isn't collapsed into a single vertex. */
+  const Array<float> positions = {0.0f, 0.6f, 1.2f, 1.8f};
+  Mesh *mesh = mesh_verts_new(positions);
+  Mesh *result = weld_apply(mesh, 1.0f, MOD_WELD_MODE_ALL);
+  EXPECT_EQ(result->totvert, 2);
+  weld_result_free(result, mesh);
+}
+
+TEST_F(weld_modifier, VertexGroup)
+{
+  /* Two coincident pairs, only the first is in the vertex group. */
+  const Array<float> positions = {0.0f, 0.0f, 1.0f, 1.0f};
+  Object ob = {{nullptr}};
+  bDeformGroup defgroup = {nullptr};
+  STRNCPY(defgroup.name, "Group");
+  BLI_addtail(&ob.defbase, &defgroup);
+
+  for (const bool invert : {false, true}) {
+    Mesh *mesh = mesh_verts_new(positions);
+    MDeformVert *dvert = (MDeformVert *)CustomData_add_layer(
+        &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, mesh->totvert);
+    BKE_defvert_add_index_notest(&dvert[0], 0, 1.0f);
+    BKE_defvert_add_index_notest(&dvert[1], 0, 1.0f);
+
+    Mesh *result = weld_apply(
+        mesh, 0.001f, MOD_WELD_MODE_ALL, &ob, "Group", invert ? MOD_WELD_INVERT_VGROUP : 0);
+    ASSERT_EQ(result->totvert, 3);
+    /* The pair that isn't welded keeps both vertices. */
+    int unwelded_len = 0;
+    for (int i = 0; i < result->totvert; i++) {
+      unwelded_len += (result->mvert[i].co[0] == (invert ? 0.0f : 1.0f));
+    }
+    EXPECT_EQ(unwelded_len, 2);
+    weld_result_free(result, mesh);
+  }
+}
+
+TEST_F(weld_modifier, Connected)
+{
+  /* The first two vertices share a short edge, the third is at the same position as the first
+   * but not connected to it. */
+  const Array<float> positions = {0.0f, 0.0005f, 0.0f};
+  for (const char mode : {MOD_WELD_MODE_CONNECTED, MOD_WELD_MODE_ALL}) {
+    Mesh *mesh = mesh_verts_new(positions, 1);
+    mesh->medge[0].v1 = 0;
+    mesh->medge[0].v2 = 1;
+
+    Mesh *result = weld_apply(mesh, 0.001f, mode);
+    EXPECT_EQ(result->totvert, (mode == MOD_WELD_MODE_CONNECTED) ? 2 : 1);
+    EXPECT_EQ(result->totedge, 0);
+    weld_result_free(result, mesh);
+  }
+}
+
+TEST_F(weld_modifier, KDTreeGroups)
+{
+  /* Compact clusters, chains and dense blobs of vertices, in random order. Enough vertices for
+   * the clustering to run multi-threaded. */
+  const float merge_dist = 1.0f;
+  RandomNumberGenerator rng(1234);
+  Vector<float3> positions;
+  for (int x = 0; x < 20; x++) {
+    for (int y = 0; y < 20; y++) {
+      const float3 center((float)x * 6.0f, (float)y * 6.0f, 0.0f);
+      switch (rng.get_uint32() % 3) {
+        case 0: {
+          const int len = 1 + (int)(rng.get_uint32() % 6);
+          for (int i = 0; i < len; i++) {
+            positions.append(center + float3(rng.get_float(), rng.get_float(), 0.0f) * 0.5f);
+          }
+          break;
+        }
+        case 1: {
+          float3 co = center;
+          for (int i = 0; i < 8; i++) {
+            positions.append(co);
+            co.x += 0.45f + rng.get_float() * 0.5f;
+          }
+          break;
+        }
+        default: {
+          for (int i = 0; i < 100; i++) {
+            positions.append(center + float3(rng.get_float(), rng.get_float(), rng.get_float()) *
+                                          2.5f);
+          }
+          break;
+        }
+      }
+    }
+  }
+  ASSERT_GT(positions.size(), 10000);
+  for (int i = positions.size() - 1; i > 0; i--) {
+    std::swap(positions[i], positions[rng.get_uint32() % (uint32_t)(i + 1)]);
+  }
+
+  /* Reference groups, merging vertices in index order. */
+  const int verts_len = positions.size();
+  KDTree_3d *tree = BLI_kdtree_3d_new(verts_len);
+  for (const int i : positions.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, positions[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  Array<int> duplicates(verts_len, -1);
+  const int kill_len = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, merge_dist, true, duplicates.data());
+  BLI_kdtree_3d_free(tree);
+
+  Array<float3> group_co(verts_len, float3(0.0f));
+  Array<int> group_len(verts_len, 0);
+  for (const int i : positions.index_range()) {
+    const int dest = (duplicates[i] == -1) ? i : duplicates[i];
+    group_co[dest] += positions[i];
+    group_len[dest]++;
+  }
+
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, 0, 0);
+  for (const int i : positions.index_range()) {
+    copy_v3_v3(mesh->mvert[i].co, positions[i]);
+  }
+  Mesh *result = weld_apply(mesh, merge_dist, MOD_WELD_MODE_ALL);
+  ASSERT_EQ(result->totvert, verts_len - kill_len);
+
+  /* Every group is merged into a vertex at its center. */
+  KDTree_3d *tree_result = BLI_kdtree_3d_new(result->totvert);
+  for (int i = 0; i < result->totvert; i++) {
+    BLI_kdtree_3d_insert(tree_result, i, result->mvert[i].co);
+  }
+  BLI_kdtree_3d_balance(tree_result);
+  Array<bool> found(result->totvert, false);
+  for (const int i : positions.index_range()) {
+    if (group_len[i] == 0) {
+      continue;
+    }
+    const float3 co = group_co[i] / (float)group_len[i];
+    KDTreeNearest_3d nearest;
+    ASSERT_NE(BLI_kdtree_3d_find_nearest(tree_result, co, &nearest), -1);
+    EXPECT_LT(nearest.dist, 1e-4f);
+    EXPECT_FALSE(found[nearest.index]);
+    found[nearest.index] = true;
+  }
+  BLI_kdtree_3d_free(tree_result);
+
+  weld_result_free(result, mesh);
+}
+
+}  // namespace blender::modifiers::tests
@@ -33,6 +33,7 @@
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
@@ -81,6 +82,10 @@
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
  *
+ * Memory used by cached images is reported to the movie cache, so sequencer cache shares the
+ * memory budget with image, movie clip and color management caches. Movie cache items are freed
+ * first, the sequencer cache is recycled only when it doesn't fit into the budget on its own.
+ *
  *
  * Disk Cache Design Notes
  * =======================
@@ -153,6 +158,7 @@ typedef struct SeqCache {
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  size_t size; /* Memory reported to the shared budget. */
 } SeqCacheItem;
 
 typedef struct SeqCacheKey {
@@ -802,11 +808,6 @@ static void seq_cache_unlock(Scene *scene)
   }
 }
 
-static size_t seq_cache_get_mem_total(void)
-{
-  return ((size_t)U.memcachelimit) * 1024 * 1024;
-}
-
 static void seq_cache_keyfree(void *val)
 {
   SeqCacheKey *key = val;
@@ -821,6 +822,8 @@ static void seq_cache_valfree(void *val)
     IMB_freeImBuf(item->ibuf);
   }
 
+  IMB_moviecache_shared_memory_sub(item->size);
+
   BLI_mempool_free(item->cache_owner->items_pool, item);
 }
 
@@ -847,6 +850,9 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->size = IMB_get_size_in_memory(ibuf);
+
+  IMB_moviecache_shared_memory_add(item->size);
 
   const int stored_types_flag = get_stored_types_flag(scene, key);
 
@@ -1480,5 +1486,8 @@ void SEQ_cache_iterate(
 
 bool seq_cache_is_full(void)
 {
-  return seq_cache_get_mem_total() < MEM_get_memory_in_use();
+  /* Free movie cache items first, they are managed in the same budget. */
+  IMB_moviecache_enforce_limits();
+
+  return IMB_moviecache_get_memory_budget() < IMB_moviecache_get_memory_in_use();
 }
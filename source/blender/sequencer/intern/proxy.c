@@ -35,6 +35,8 @@
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #ifdef WIN32
 #  include "BLI_winstuff.h"
@@ -78,6 +80,11 @@ typedef struct SeqIndexBuildContext {
   Depsgraph *depsgraph;
   Scene *scene;
   Sequence *seq, *orig_seq;
+
+  /* Progress of this context when building multiple contexts in parallel,
+   * protected by the lock of the queue. */
+  struct SeqProxyRebuildQueueData *queue_data;
+  float progress;
 } SeqIndexBuildContext;
 
 int SEQ_rendersize_to_proxysize(int render_size)
@@ -290,7 +297,7 @@ static void seq_proxy_build_frame(const SeqRenderData *context,
     ibuf = IMB_dupImBuf(ibuf_tmp);
     IMB_metadata_copy(ibuf, ibuf_tmp);
     IMB_freeImBuf(ibuf_tmp);
-    IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+    IMB_scaleImBuf_filtered(ibuf, rectx, recty, IMB_SCALE_FILTER_BILINEAR);
   }
   else {
     ibuf = ibuf_tmp;
@@ -465,10 +472,12 @@ bool SEQ_proxy_rebuild_context(Main *bmain,
   return true;
 }
 
-void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
-                       short *stop,
-                       short *do_update,
-                       float *progress)
+static void seq_proxy_rebuild_ex(SeqIndexBuildContext *context,
+                                 short *stop,
+                                 short *do_update,
+                                 float *progress,
+                                 IMB_IndexProgressFn progress_fn,
+                                 void *progress_userdata)
 {
   const bool overwrite = context->overwrite;
   SeqRenderData render_context;
@@ -479,7 +488,8 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
 
   if (seq->type == SEQ_TYPE_MOVIE) {
     if (context->index_context) {
-      IMB_anim_index_rebuild(context->index_context, stop, do_update, progress);
+      IMB_anim_index_rebuild(
+          context->index_context, stop, do_update, progress, progress_fn, progress_userdata);
     }
 
     return;
@@ -531,6 +541,9 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
     *progress = (float)(timeline_frame - seq->startdisp - seq->startstill) /
                 (seq->enddisp - seq->endstill - seq->startdisp - seq->startstill);
     *do_update = true;
+    if (progress_fn) {
+      progress_fn(progress_userdata, *progress);
+    }
 
     if (*stop || G.is_break) {
       break;
@@ -538,6 +551,116 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
   }
 }
 
+void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
+                       short *stop,
+                       short *do_update,
+                       float *progress)
+{
+  seq_proxy_rebuild_ex(context, stop, do_update, progress, NULL, NULL);
+}
+
+typedef struct SeqProxyRebuildQueueData {
+  ListBase *queue;
+  short *stop;
+
+  /* Progress of the whole queue, shared with the job. */
+  ThreadMutex progress_lock;
+  short *do_update;
+  float *progress;
+  float progress_sum;
+  int contexts_len;
+} SeqProxyRebuildQueueData;
+
+/* Called from the tasks whenever the progress of a context changes. */
+static void seq_proxy_rebuild_queue_progress_update(SeqProxyRebuildQueueData *data,
+                                                    SeqIndexBuildContext *context,
+                                                    const float progress)
+{
+  BLI_mutex_lock(&data->progress_lock);
+  data->progress_sum += progress - context->progress;
+  context->progress = progress;
+  *data->progress = data->progress_sum / data->contexts_len;
+  *data->do_update = true;
+  BLI_mutex_unlock(&data->progress_lock);
+}
+
+static void seq_proxy_rebuild_queue_progress_fn(void *userdata, float progress)
+{
+  SeqIndexBuildContext *context = userdata;
+  seq_proxy_rebuild_queue_progress_update(context->queue_data, context, progress);
+}
+
+static void seq_proxy_rebuild_context_task(SeqProxyRebuildQueueData *data,
+                                           SeqIndexBuildContext *context)
+{
+  /* Written by this task only, the queue progress is updated through the callback. */
+  short do_update;
+  float progress = 0.0f;
+
+  context->queue_data = data;
+  seq_proxy_rebuild_ex(
+      context, data->stop, &do_update, &progress, seq_proxy_rebuild_queue_progress_fn, context);
+  seq_proxy_rebuild_queue_progress_update(data, context, 1.0f);
+}
+
+static void seq_proxy_rebuild_movie_task(TaskPool *__restrict pool, void *taskdata)
+{
+  seq_proxy_rebuild_context_task(BLI_task_pool_user_data(pool), taskdata);
+}
+
+static void seq_proxy_rebuild_images_task(TaskPool *__restrict pool, void *UNUSED(taskdata))
+{
+  SeqProxyRebuildQueueData *data = BLI_task_pool_user_data(pool);
+
+  /* Image strips go through the sequencer render pipeline, build them one after another. */
+  LISTBASE_FOREACH (LinkData *, link, data->queue) {
+    SeqIndexBuildContext *context = link->data;
+
+    if (context->index_context == NULL && !*data->stop) {
+      seq_proxy_rebuild_context_task(data, context);
+    }
+  }
+}
+
+/**
+ * Build proxies and time-codes of all contexts in \a queue.
+ * Movie strips decode their own files, so they are built in parallel.
+ */
+void SEQ_proxy_rebuild_queue(ListBase *queue, short *stop, short *do_update, float *progress)
+{
+  SeqProxyRebuildQueueData data = {
+      .queue = queue,
+      .stop = stop,
+      .do_update = do_update,
+      .progress = progress,
+  };
+  BLI_mutex_init(&data.progress_lock);
+
+  TaskPool *task_pool = BLI_task_pool_create_background(&data, TASK_PRIORITY_LOW);
+  bool has_images = false;
+
+  LISTBASE_FOREACH (LinkData *, link, queue) {
+    SeqIndexBuildContext *context = link->data;
+    context->progress = 0.0f;
+    data.contexts_len++;
+
+    if (context->index_context) {
+      BLI_task_pool_push(task_pool, seq_proxy_rebuild_movie_task, context, false, NULL);
+    }
+    else {
+      has_images = true;
+    }
+  }
+
+  if (has_images) {
+    BLI_task_pool_push(task_pool, seq_proxy_rebuild_images_task, NULL, false, NULL);
+  }
+
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+  BLI_mutex_end(&data.progress_lock);
+}
+
 void SEQ_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
 {
   if (context->index_context) {
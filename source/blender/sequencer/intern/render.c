@@ -617,6 +617,27 @@ static bool seq_need_scale_to_render_size(const Sequence *seq, bool is_proxy_ima
   return false;
 }
 
+/**
+ * Check whether the strip image only has to be scaled to exactly cover the render size,
+ * without any offset, rotation or margins.
+ */
+static bool seq_image_scale_fills_render_size(const Sequence *seq,
+                                              const ImBuf *ibuf,
+                                              const float image_scale_factor,
+                                              const int render_x,
+                                              const int render_y)
+{
+  if (sequencer_use_transform(seq)) {
+    return false;
+  }
+  /* Float buffers of the result are allocated with 4 channels. */
+  if (ibuf->rect_float && ibuf->channels != 4) {
+    return false;
+  }
+  return (int)roundf(ibuf->x * image_scale_factor) == render_x &&
+         (int)roundf(ibuf->y * image_scale_factor) == render_y;
+}
+
 static ImBuf *input_preprocess(const SeqRenderData *context,
                                Sequence *seq,
                                float timeline_frame,
@@ -679,23 +700,32 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     const int y = context->recty;
     preprocessed_ibuf = IMB_allocImBuf(x, y, 32, ibuf->rect_float ? IB_rectfloat : IB_rect);
 
-    ImageTransformThreadInitData init_data = {NULL};
-    init_data.ibuf_source = ibuf;
-    init_data.ibuf_out = preprocessed_ibuf;
-    init_data.transform = seq->strip->transform;
-    if (seq_need_scale_to_render_size(seq, is_proxy_image)) {
-      init_data.image_scale_factor = 1.0f;
+    const float image_scale_factor = seq_need_scale_to_render_size(seq, is_proxy_image) ?
+                                         1.0f :
+                                         preview_scale_factor;
+
+    if (seq_image_scale_fills_render_size(seq, ibuf, image_scale_factor, x, y)) {
+      /* Plain scale to render size, use separable filter which is faster than generic transform
+       * and doesn't alias when down-scaling. */
+      IMB_scale_into_ImBuf(ibuf,
+                           preprocessed_ibuf,
+                           context->for_render ? IMB_SCALE_FILTER_BICUBIC :
+                                                 IMB_SCALE_FILTER_BILINEAR);
     }
     else {
-      init_data.image_scale_factor = preview_scale_factor;
-    }
-    init_data.preview_scale_factor = preview_scale_factor;
-    init_data.for_render = context->for_render;
-    IMB_processor_apply_threaded(context->recty,
-                                 sizeof(ImageTransformThreadData),
-                                 &init_data,
-                                 sequencer_image_transform_init,
-                                 sequencer_image_transform_do_thread);
+      ImageTransformThreadInitData init_data = {NULL};
+      init_data.ibuf_source = ibuf;
+      init_data.ibuf_out = preprocessed_ibuf;
+      init_data.transform = seq->strip->transform;
+      init_data.image_scale_factor = image_scale_factor;
+      init_data.preview_scale_factor = preview_scale_factor;
+      init_data.for_render = context->for_render;
+      IMB_processor_apply_threaded(context->recty,
+                                   sizeof(ImageTransformThreadData),
+                                   &init_data,
+                                   sequencer_image_transform_init,
+                                   sequencer_image_transform_do_thread);
+    }
     seq_imbuf_assign_spaces(scene, preprocessed_ibuf);
     IMB_metadata_copy(preprocessed_ibuf, ibuf);
     IMB_freeImBuf(ibuf);
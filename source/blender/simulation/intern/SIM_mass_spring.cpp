@@ -44,6 +44,8 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
 static float I3[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
 
 /* Number of off-diagonal non-zero matrix blocks.
@@ -1225,6 +1227,7 @@ static void cloth_clear_result(ClothModifierData *clmd)
   sres->max_error = sres->min_error = sres->avg_error = 0.0f;
   sres->max_iterations = sres->min_iterations = 0;
   sres->avg_iterations = 0.0f;
+  sres->max_time = sres->avg_time = 0.0f;
 }
 
 static void cloth_record_result(ClothModifierData *clmd, ImplicitSolverResult *result, float dt)
@@ -1257,6 +1260,14 @@ static void cloth_record_result(ClothModifierData *clmd, ImplicitSolverResult *r
   sres->status |= result->status;
 }
 
+static void cloth_record_time(ClothModifierData *clmd, double time, float dt)
+{
+  ClothSolverResult *sres = clmd->solver_result;
+
+  sres->max_time = max_ff(sres->max_time, (float)time);
+  sres->avg_time += (float)time * dt;
+}
+
 int SIM_cloth_solve(
     Depsgraph *depsgraph, Object *ob, float frame, ClothModifierData *clmd, ListBase *effectors)
 {
@@ -1305,8 +1316,11 @@ int SIM_cloth_solve(
     zero_v3(cloth->average_acceleration);
   }
 
+  SIM_mass_spring_set_preconditioner(id, clmd->sim_parms->preconditioner);
+
   while (step < tf) {
     ImplicitSolverResult result;
+    const double step_start = PIL_check_seconds_timer();
 
     /* setup vertex constraints for pinned vertices */
     cloth_setup_constraints(clmd);
@@ -1351,6 +1365,8 @@ int SIM_cloth_solve(
       SIM_mass_spring_get_motion_state(id, i, verts[i].txold, nullptr);
     }
 
+    cloth_record_time(clmd, PIL_check_seconds_timer() - step_start, dt);
+
     step += dt;
   }
 
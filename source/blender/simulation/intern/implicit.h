@@ -65,6 +65,8 @@ BLI_INLINE void implicit_print_matrix_elem(float v)
 }
 
 void SIM_mass_spring_set_vertex_mass(struct Implicit_Data *data, int index, float mass);
+/* Pre-conditioner of the conjugate gradient solver (CLOTH_PRECONDITIONER_*). */
+void SIM_mass_spring_set_preconditioner(struct Implicit_Data *data, int preconditioner);
 void SIM_mass_spring_set_rest_transform(struct Implicit_Data *data, int index, float tfm[3][3]);
 
 void SIM_mass_spring_set_motion_state(struct Implicit_Data *data,
@@ -27,6 +27,7 @@
 
 #  include "MEM_guardedalloc.h"
 
+#  include "DNA_cloth_types.h"
 #  include "DNA_meshdata_types.h"
 #  include "DNA_object_force_types.h"
 #  include "DNA_object_types.h"
@@ -34,6 +35,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -50,6 +52,13 @@
 #    define CLOTH_OPENMP_LIMIT 512
 #  endif
 
+/* Minimum number of vertices for the solver to run multi-threaded. */
+#  define CLOTH_PARALLEL_LIMIT 1024
+/* Number of vertices per task of the vector kernels. Reductions sum the partial results of every
+ * chunk in order, so results don't depend on the number of threads. They differ slightly from
+ * summing over all vertices in a single loop. */
+#  define CLOTH_PARALLEL_CHUNK_SIZE 1024
+
 //#define DEBUG_TIME
 
 #  ifdef DEBUG_TIME
@@ -613,35 +622,117 @@ DO_INLINE void initdiag_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
   }
 }
 
-/* SPARSE SYMMETRIC multiply big matrix with long vector*/
-/* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+/* Rows of a sparse symmetric big matrix, to multiply each row independently. Off-diagonal
+ * blocks are stored once in the upper triangle, the lower triangle uses them transposed. */
+typedef struct bfmatrixRowBlock {
+  unsigned int block; /* index of the block in the big matrix */
+  unsigned int col;   /* column of the block in this row */
+  bool transposed;
+} bfmatrixRowBlock;
+
+typedef struct bfmatrixRows {
+  unsigned int vcount;
+  unsigned int *offsets;    /* offset of each row in blocks, vcount + 1 */
+  bfmatrixRowBlock *blocks; /* off-diagonal blocks of each row */
+} bfmatrixRows;
+
+static void create_bfmatrix_rows(bfmatrixRows *rows, unsigned int verts, unsigned int springs)
+{
+  rows->vcount = verts;
+  rows->offsets = MEM_callocN(sizeof(*rows->offsets) * (verts + 1), "cloth_implicit_rows");
+  rows->blocks = MEM_mallocN(sizeof(*rows->blocks) * max_ii(2 * springs, 1),
+                             "cloth_implicit_row_blocks");
+}
+
+static void del_bfmatrix_rows(bfmatrixRows *rows)
 {
-  unsigned int vcount = from[0].vcount;
-  lfVector *temp = create_lfvector(vcount);
+  MEM_SAFE_FREE(rows->offsets);
+  MEM_SAFE_FREE(rows->blocks);
+}
 
-  zero_lfvector(to, vcount);
+/* Sort the first `num_blocks` off-diagonal blocks of the matrix by row. */
+static void update_bfmatrix_rows(bfmatrixRows *rows, const fmatrix3x3 *matrix, int num_blocks)
+{
+  const unsigned int vcount = rows->vcount;
+  const unsigned int blocks_end = vcount + (unsigned int)num_blocks;
+  unsigned int *offsets = rows->offsets;
+  BLI_assert(matrix[0].vcount == vcount && num_blocks <= matrix[0].scount);
 
-#  pragma omp parallel sections if (vcount > CLOTH_OPENMP_LIMIT)
-  {
-#  pragma omp section
-    {
-      for (unsigned int i = from[0].vcount; i < from[0].vcount + from[0].scount; i++) {
-        /* This is the lower triangle of the sparse matrix,
-         * therefore multiplication occurs with transposed submatrices. */
-        muladd_fmatrixT_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-      }
+  memset(offsets, 0, sizeof(*offsets) * (vcount + 1));
+  for (unsigned int i = vcount; i < blocks_end; i++) {
+    offsets[matrix[i].r + 1]++;
+    offsets[matrix[i].c + 1]++;
+  }
+  for (unsigned int i = 0; i < vcount; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  /* Fill in block order, using the start of the next row as counter for each row. */
+  for (unsigned int i = vcount; i < blocks_end; i++) {
+    const unsigned int r = matrix[i].r, c = matrix[i].c;
+    rows->blocks[offsets[r]++] = (bfmatrixRowBlock){.block = i, .col = c, .transposed = false};
+    rows->blocks[offsets[c]++] = (bfmatrixRowBlock){.block = i, .col = r, .transposed = true};
+  }
+  /* Restore the row starts. */
+  for (unsigned int i = vcount; i > 0; i--) {
+    offsets[i] = offsets[i - 1];
+  }
+  offsets[0] = 0;
+}
+
+BLI_INLINE void solver_parallel_range_settings(TaskParallelSettings *settings, unsigned int verts)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (verts > CLOTH_PARALLEL_LIMIT);
+  settings->min_iter_per_thread = 256;
+}
+
+typedef struct MulBfmatrixData {
+  float (*to)[3];
+  const fmatrix3x3 *matrix;
+  const bfmatrixRows *rows;
+  const lfVector *vector;
+} MulBfmatrixData;
+
+static void mul_bfmatrix_lfvector_row_fn(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const MulBfmatrixData *data = userdata;
+  const bfmatrixRows *rows = data->rows;
+  float *to = data->to[i];
+
+  /* Diagonal block. */
+  mul_fmatrix_fvector(to, data->matrix[i].m, data->vector[i]);
+
+  for (unsigned int j = rows->offsets[i]; j < rows->offsets[i + 1]; j++) {
+    const bfmatrixRowBlock *row_block = &rows->blocks[j];
+    const fmatrix3x3 *block = &data->matrix[row_block->block];
+    if (row_block->transposed) {
+      muladd_fmatrixT_fvector(to, block->m, data->vector[row_block->col]);
     }
-#  pragma omp section
-    {
-      for (unsigned int i = 0; i < from[0].vcount + from[0].scount; i++) {
-        muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
-      }
+    else {
+      muladd_fmatrix_fvector(to, block->m, data->vector[row_block->col]);
     }
   }
-  add_lfvector_lfvector(to, to, temp, from[0].vcount);
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector, one row per task. */
+DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3],
+                                     const fmatrix3x3 *from,
+                                     const bfmatrixRows *rows,
+                                     const lfVector *fLongVector)
+{
+  MulBfmatrixData data = {
+      .to = to,
+      .matrix = from,
+      .rows = rows,
+      .vector = fLongVector,
+  };
 
-  del_lfvector(temp);
+  TaskParallelSettings settings;
+  solver_parallel_range_settings(&settings, rows->vcount);
+  BLI_task_parallel_range(0, rows->vcount, &data, mul_bfmatrix_lfvector_row_fn, &settings);
 }
 
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
@@ -683,6 +774,9 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+  int preconditioner;   /* CLOTH_PRECONDITIONER_* */
+
+  bfmatrixRows rows; /* rows of the sparse matrices, for multiplication */
 } Implicit_Data;
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -707,6 +801,7 @@ Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
   id->B = create_lfvector(numverts);
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
+  create_bfmatrix_rows(&id->rows, numverts, numsprings);
 
   initdiag_bfmatrix(id->bigI, I);
 
@@ -733,6 +828,7 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->B);
   del_lfvector(id->dV);
   del_lfvector(id->z);
+  del_bfmatrix_rows(&id->rows);
 
   MEM_freeN(id);
 }
@@ -850,11 +946,156 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 }
 #  endif
 
+/* State of the conjugate gradient loop, shared by the parallel vector kernels. */
+typedef struct CGData {
+  lfVector *ldV, *r, *c, *q, *s;
+  const fmatrix3x3 *S;
+  const fmatrix3x3 *Pinv; /* block diagonal pre-conditioner, NULL for none */
+  unsigned int numverts;
+  float alpha, beta;
+  float *chunk_sums; /* partial dot products, one per chunk */
+} CGData;
+
+BLI_INLINE void cg_chunk_range(const CGData *data,
+                               const int chunk,
+                               unsigned int *r_start,
+                               unsigned int *r_end)
+{
+  *r_start = (unsigned int)chunk * CLOTH_PARALLEL_CHUNK_SIZE;
+  *r_end = min_ii(*r_start + CLOTH_PARALLEL_CHUNK_SIZE, data->numverts);
+}
+
+/* Sum of the partial results in chunk order, independent from the number of threads. */
+static float cg_parallel_chunks(CGData *data, TaskParallelRangeFunc func)
+{
+  const int chunks_len = (int)((data->numverts + CLOTH_PARALLEL_CHUNK_SIZE - 1) /
+                               CLOTH_PARALLEL_CHUNK_SIZE);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (data->numverts > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, chunks_len, data, func, &settings);
+
+  float sum = 0.0f;
+  for (int i = 0; i < chunks_len; i++) {
+    sum += data->chunk_sums[i];
+  }
+  return sum;
+}
+
+BLI_INLINE void cg_precondition(const CGData *data, float to[3], const float from[3], int index)
+{
+  if (data->Pinv) {
+    mul_v3_m3v3(to, data->Pinv[index].m, from);
+  }
+  else {
+    copy_v3_v3(to, from);
+  }
+}
+
+/* q = filter(q), returns c^T * q. */
+static void cg_filter_dot_fn(void *__restrict userdata,
+                             const int chunk,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGData *data = userdata;
+  unsigned int start, end;
+  cg_chunk_range(data, chunk, &start, &end);
+
+  float sum = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    mul_m3_v3(data->S[i].m, data->q[i]);
+    sum += dot_v3v3(data->c[i], data->q[i]);
+  }
+  data->chunk_sums[chunk] = sum;
+}
+
+/* dV += alpha * c, r -= alpha * q, s = P^-1 * r, returns r^T * s. */
+static void cg_update_residual_fn(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGData *data = userdata;
+  const float alpha = data->alpha;
+  unsigned int start, end;
+  cg_chunk_range(data, chunk, &start, &end);
+
+  float sum = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    madd_v3_v3fl(data->ldV[i], data->c[i], alpha);
+    madd_v3_v3fl(data->r[i], data->q[i], -alpha);
+    cg_precondition(data, data->s[i], data->r[i], i);
+    sum += dot_v3v3(data->r[i], data->s[i]);
+  }
+  data->chunk_sums[chunk] = sum;
+}
+
+/* c = filter(s + beta * c). */
+static void cg_update_direction_fn(void *__restrict userdata,
+                                   const int chunk,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGData *data = userdata;
+  const float beta = data->beta;
+  unsigned int start, end;
+  cg_chunk_range(data, chunk, &start, &end);
+
+  for (unsigned int i = start; i < end; i++) {
+    VECADDS(data->c[i], data->s[i], data->c[i], beta);
+    mul_m3_v3(data->S[i].m, data->c[i]);
+  }
+  data->chunk_sums[chunk] = 0.0f;
+}
+
+/* Initial residual r = filter(B - A * dV) and direction c = filter(P^-1 * r),
+ * returns r^T * c. The filtered B is stored in q, and its norm in the pre-conditioner metric
+ * in s, to find the target residual. */
+static void cg_init_fn(void *__restrict userdata,
+                       const int chunk,
+                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGData *data = userdata;
+  unsigned int start, end;
+  cg_chunk_range(data, chunk, &start, &end);
+
+  float sum = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    /* r contains B - A * dV on input. */
+    mul_m3_v3(data->S[i].m, data->r[i]);
+    cg_precondition(data, data->c[i], data->r[i], i);
+    mul_m3_v3(data->S[i].m, data->c[i]);
+    sum += dot_v3v3(data->r[i], data->c[i]);
+  }
+  data->chunk_sums[chunk] = sum;
+}
+
+/* bnorm2 = filter(B)^T * P^-1 * filter(B), with B stored in q. */
+static void cg_bnorm_fn(void *__restrict userdata,
+                        const int chunk,
+                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGData *data = userdata;
+  unsigned int start, end;
+  cg_chunk_range(data, chunk, &start, &end);
+
+  float sum = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    float fB[3];
+    mul_v3_m3v3(fB, data->S[i].m, data->q[i]);
+    cg_precondition(data, data->s[i], fB, i);
+    sum += dot_v3v3(fB, data->s[i]);
+  }
+  data->chunk_sums[chunk] = sum;
+}
+
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const bfmatrixRows *rows,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
+                       const fmatrix3x3 *Pinv,
                        ImplicitSolverResult *result)
 {
   /* Solves for unknown X in equation AX=B */
@@ -862,33 +1103,32 @@ static int cg_filtered(lfVector *ldV,
   float conjgrad_epsilon = 0.01f;
 
   unsigned int numverts = lA[0].vcount;
-  lfVector *fB = create_lfvector(numverts);
-  lfVector *AdV = create_lfvector(numverts);
-  lfVector *r = create_lfvector(numverts);
-  lfVector *c = create_lfvector(numverts);
-  lfVector *q = create_lfvector(numverts);
-  lfVector *s = create_lfvector(numverts);
-  float bnorm2, delta_new, delta_old, delta_target, alpha;
+  const unsigned int chunks_len = (numverts + CLOTH_PARALLEL_CHUNK_SIZE - 1) /
+                                  CLOTH_PARALLEL_CHUNK_SIZE;
+  CGData data = {
+      .ldV = ldV,
+      .r = create_lfvector(numverts),
+      .c = create_lfvector(numverts),
+      .q = create_lfvector(numverts),
+      .s = create_lfvector(numverts),
+      .S = S,
+      .Pinv = Pinv,
+      .numverts = numverts,
+      .chunk_sums = MEM_mallocN(sizeof(float) * max_ii(chunks_len, 1), "cloth_cg_chunk_sums"),
+  };
+  float bnorm2, delta_new, delta_old, delta_target;
 
   cp_lfvector(ldV, z, numverts);
 
-  /* d0 = filter(B)^T * P * filter(B) */
-  cp_lfvector(fB, lB, numverts);
-  filter(fB, S);
-  bnorm2 = dot_lfvector(fB, fB, numverts);
+  /* d0 = filter(B)^T * P^-1 * filter(B) */
+  cp_lfvector(data.q, lB, numverts);
+  bnorm2 = cg_parallel_chunks(&data, cg_bnorm_fn);
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
-  /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
-  sub_lfvector_lfvector(r, lB, AdV, numverts);
-  filter(r, S);
-
-  /* c = filter(P^-1 * r) */
-  cp_lfvector(c, r, numverts);
-  filter(c, S);
-
-  /* delta = r^T * c */
-  delta_new = dot_lfvector(r, c, numverts);
+  /* r = filter(B - A * dV), c = filter(P^-1 * r), delta = r^T * c */
+  mul_bfmatrix_lfvector(data.q, lA, rows, ldV);
+  sub_lfvector_lfvector(data.r, lB, data.q, numverts);
+  delta_new = cg_parallel_chunks(&data, cg_init_fn);
 
 #  ifdef IMPLICIT_PRINT_SOLVER_INPUT_OUTPUT
   printf("==== A ====\n");
@@ -902,22 +1142,15 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
-    filter(q, S);
-
-    alpha = delta_new / dot_lfvector(c, q, numverts);
-
-    add_lfvector_lfvectorS(ldV, ldV, c, alpha, numverts);
+    mul_bfmatrix_lfvector(data.q, lA, rows, data.c);
 
-    add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
+    data.alpha = delta_new / cg_parallel_chunks(&data, cg_filter_dot_fn);
 
-    /* s = P^-1 * r */
-    cp_lfvector(s, r, numverts);
     delta_old = delta_new;
-    delta_new = dot_lfvector(r, s, numverts);
+    delta_new = cg_parallel_chunks(&data, cg_update_residual_fn);
 
-    add_lfvector_lfvectorS(c, s, c, delta_new / delta_old, numverts);
-    filter(c, S);
+    data.beta = delta_new / delta_old;
+    cg_parallel_chunks(&data, cg_update_direction_fn);
 
     conjgrad_loopcount++;
   }
@@ -928,12 +1161,11 @@ static int cg_filtered(lfVector *ldV,
   printf("========\n");
 #  endif
 
-  del_lfvector(fB);
-  del_lfvector(AdV);
-  del_lfvector(r);
-  del_lfvector(c);
-  del_lfvector(q);
-  del_lfvector(s);
+  del_lfvector(data.r);
+  del_lfvector(data.c);
+  del_lfvector(data.q);
+  del_lfvector(data.s);
+  MEM_freeN(data.chunk_sums);
   // printf("W/O conjgrad_loopcount: %d\n", conjgrad_loopcount);
 
   result->status = conjgrad_loopcount < conjgrad_looplimit ? SIM_SOLVER_SUCCESS :
@@ -945,6 +1177,26 @@ static int cg_filtered(lfVector *ldV,
          conjgrad_looplimit; /* true means we reached desired accuracy in given time - ie stable */
 }
 
+/* Block diagonal approximation of P^-1, from the diagonal blocks of A. */
+static void update_pinv(fmatrix3x3 *Pinv, const fmatrix3x3 *lA, int preconditioner)
+{
+  const unsigned int numverts = lA[0].vcount;
+
+  for (unsigned int i = 0; i < numverts; i++) {
+    const float(*m)[3] = lA[i].m;
+
+    if (preconditioner == CLOTH_PRECONDITIONER_JACOBI) {
+      zero_m3(Pinv[i].m);
+      for (int j = 0; j < 3; j++) {
+        Pinv[i].m[j][j] = (m[j][j] != 0.0f) ? 1.0f / m[j][j] : 1.0f;
+      }
+    }
+    else if (!invert_m3_m3(Pinv[i].m, m)) {
+      unit_m3(Pinv[i].m);
+    }
+  }
+}
+
 #  if 0
 /* block diagonalizer */
 DO_INLINE void BuildPPinv(fmatrix3x3 *lA, fmatrix3x3 *P, fmatrix3x3 *Pinv)
@@ -1162,7 +1414,10 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* All sparse matrices share the blocks added by #SIM_mass_spring_add_block. */
+  update_bfmatrix_rows(&data->rows, data->A, data->num_blocks);
+
+  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, &data->rows, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1170,8 +1425,14 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
   double start = PIL_check_seconds_timer();
 #  endif
 
+  const fmatrix3x3 *Pinv = NULL;
+  if (data->preconditioner != CLOTH_PRECONDITIONER_NONE) {
+    update_pinv(data->Pinv, data->A, data->preconditioner);
+    Pinv = data->Pinv;
+  }
+
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, &data->rows, data->B, data->z, data->S, Pinv, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
@@ -1205,6 +1466,11 @@ void SIM_mass_spring_apply_result(Implicit_Data *data)
   cp_lfvector(data->V, data->Vnew, numverts);
 }
 
+void SIM_mass_spring_set_preconditioner(Implicit_Data *data, int preconditioner)
+{
+  data->preconditioner = preconditioner;
+}
+
 void SIM_mass_spring_set_vertex_mass(Implicit_Data *data, int index, float mass)
 {
   unit_m3(data->M[index].m);
@@ -607,6 +607,11 @@ void SIM_mass_spring_set_vertex_mass(Implicit_Data *data, int index, float mass)
   data->iM.add(index, index, m);
 }
 
+void SIM_mass_spring_set_preconditioner(Implicit_Data *UNUSED(data), int UNUSED(preconditioner))
+{
+  /* The Eigen solver uses its own (diagonal) pre-conditioner. */
+}
+
 void SIM_mass_spring_set_rest_transform(Implicit_Data *data, int index, float tfm[3][3])
 {
 #  ifdef CLOTH_ROOT_FRAME
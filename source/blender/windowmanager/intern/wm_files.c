@@ -77,6 +77,7 @@
 #include "BKE_blendfile.h"
 #include "BKE_callbacks.h"
 #include "BKE_context.h"
+#include "BKE_fcurve_driver.h"
 #include "BKE_global.h"
 #include "BKE_idprop.h"
 #include "BKE_lib_id.h"
@@ -536,6 +537,11 @@ void wm_file_read_report(bContext *C, Main *bmain)
       WM_report_banner_show();
     }
   }
+
+  /* Print the drivers which are evaluated by Python (one at a time), for rig optimization. */
+  if (G.debug & G_DEBUG_PYTHON) {
+    BKE_drivers_python_report(bmain, NULL);
+  }
 }
 
 /**
@@ -1381,7 +1387,7 @@ static ImBuf *blend_file_thumb(const bContext *C,
     float aspect = (scene->r.xsch * scene->r.xasp) / (scene->r.ysch * scene->r.yasp);
 
     /* dirty oversampling */
-    IMB_scaleImBuf(ibuf, BLEN_THUMB_SIZE, BLEN_THUMB_SIZE);
+    IMB_scaleImBuf_filtered(ibuf, BLEN_THUMB_SIZE, BLEN_THUMB_SIZE, IMB_SCALE_FILTER_BOX);
 
     /* add pretty overlay */
     IMB_thumb_overlay_blend(ibuf->rect, ibuf->x, ibuf->y, aspect);